@@ -30,6 +30,12 @@ typedef NTSTATUS* PNTSTATUS;
 #include <cassert>
 #include <cstring>
 
+#if defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(_M_ARM64)
+#include <arm_neon.h>
+#endif
+
 #include <process.h>
 
 EXTERN_C LPVOID WINAPI MileAllocateMemory(
@@ -51,10 +57,95 @@ EXTERN_C BOOL WINAPI MileFreeMemory(
     return ::HeapFree(::GetProcessHeap(), 0, Block);
 }
 
+EXTERN_C LPVOID WINAPI MileAllocateAlignedMemory(
+    _In_ SIZE_T Size)
+{
+    return ::VirtualAlloc(
+        nullptr,
+        Size,
+        MEM_COMMIT | MEM_RESERVE,
+        PAGE_READWRITE);
+}
+
+EXTERN_C BOOL WINAPI MileFreeAlignedMemory(
+    _In_ LPVOID Block)
+{
+    return ::VirtualFree(Block, 0, MEM_RELEASE);
+}
+
+EXTERN_C BOOL WINAPI MileIsZeroMemory(
+    _In_ LPCVOID Buffer,
+    _In_ SIZE_T Size)
+{
+    const BYTE* Current = reinterpret_cast<const BYTE*>(Buffer);
+    const BYTE* End = Current + Size;
+
+    while (Current < End && (reinterpret_cast<ULONG_PTR>(Current) & 15))
+    {
+        if (*Current++)
+        {
+            return FALSE;
+        }
+    }
+
+    // Check 64 bytes per iteration by folding four 16-byte vectors.
+#if defined(_M_IX86) || defined(_M_X64)
+    const __m128i Zero = ::_mm_setzero_si128();
+    while (End - Current >= 64)
+    {
+        const __m128i* Vectors = reinterpret_cast<const __m128i*>(Current);
+        __m128i Value = ::_mm_or_si128(
+            ::_mm_or_si128(
+                ::_mm_load_si128(Vectors),
+                ::_mm_load_si128(Vectors + 1)),
+            ::_mm_or_si128(
+                ::_mm_load_si128(Vectors + 2),
+                ::_mm_load_si128(Vectors + 3)));
+        if (0xFFFF != ::_mm_movemask_epi8(::_mm_cmpeq_epi8(Value, Zero)))
+        {
+            return FALSE;
+        }
+        Current += 64;
+    }
+#elif defined(_M_ARM64)
+    while (End - Current >= 64)
+    {
+        uint8x16_t Value = ::vorrq_u8(
+            ::vorrq_u8(::vld1q_u8(Current), ::vld1q_u8(Current + 16)),
+            ::vorrq_u8(::vld1q_u8(Current + 32), ::vld1q_u8(Current + 48)));
+        if (::vmaxvq_u8(Value))
+        {
+            return FALSE;
+        }
+        Current += 64;
+    }
+#endif
+
+    while (End - Current >= 8)
+    {
+        if (*reinterpret_cast<const ULONGLONG*>(Current))
+        {
+            return FALSE;
+        }
+        Current += 8;
+    }
+
+    while (Current < End)
+    {
+        if (*Current++)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
 namespace
 {
     const NTSTATUS NtStatusSuccess = static_cast<NTSTATUS>(0x00000000L);
     const NTSTATUS NtStatusNotImplemented = static_cast<NTSTATUS>(0xC0000002L);
+    const NTSTATUS NtStatusBufferOverflow = static_cast<NTSTATUS>(0x80000005L);
 
     static bool IsNtStatusSuccess(NTSTATUS Status)
     {
@@ -68,6 +159,16 @@ namespace
         _Field_size_bytes_part_(MaximumLength, Length) PWCH Buffer;
     } NtUnicodeString, * NtUnicodeStringPointer;
 
+    typedef struct _NtIoStatusBlock
+    {
+        union
+        {
+            NTSTATUS Status;
+            PVOID Pointer;
+        };
+        ULONG_PTR Information;
+    } NtIoStatusBlock, * NtIoStatusBlockPointer;
+
     static HMODULE GetNtDllModuleHandle()
     {
         static HMODULE CachedResult = ::GetModuleHandleW(L"ntdll.dll");
@@ -734,560 +835,4972 @@ EXTERN_C BOOL WINAPI MileStopService(
     return Result;
 }
 
-EXTERN_C BOOL WINAPI MileEnumerateFileByHandle(
-    _In_ HANDLE FileHandle,
-    _In_ MILE_ENUMERATE_FILE_CALLBACK_TYPE Callback,
-    _In_opt_ LPVOID Context)
+namespace
 {
-    BOOL Result = FALSE;
-    DWORD LastError = ERROR_SUCCESS;
-
-    if (FileHandle && FileHandle != INVALID_HANDLE_VALUE && Callback)
+    // The per-thread cache of the manual-reset events used by the synchronous
+    // overlapped I/O helpers, which saves creating and closing an event for
+    // each I/O request.
+    struct OverlappedEventCache
     {
-        const SIZE_T BufferSize = 32768;
-        PBYTE Buffer = reinterpret_cast<PBYTE>(
-            ::MileAllocateMemory(BufferSize));
-        if (Buffer)
+        static const SIZE_T MaximumCount = 4;
+
+        HANDLE Events[MaximumCount] = {};
+        SIZE_T Count = 0;
+
+        ~OverlappedEventCache()
         {
-            PFILE_ID_BOTH_DIR_INFO OriginalInformation =
-                reinterpret_cast<PFILE_ID_BOTH_DIR_INFO>(Buffer);
-            if (::GetFileInformationByHandleEx(
-                FileHandle,
-                FILE_INFO_BY_HANDLE_CLASS::FileIdBothDirectoryRestartInfo,
-                OriginalInformation,
-                BufferSize))
+            while (this->Count)
             {
-                MILE_FILE_ENUMERATE_INFORMATION ConvertedInformation = {};
+                ::CloseHandle(this->Events[--this->Count]);
+            }
+        }
+    };
 
-                for (;;)
-                {
-                    ConvertedInformation.CreationTime.dwLowDateTime =
-                        OriginalInformation->CreationTime.LowPart;
-                    ConvertedInformation.CreationTime.dwHighDateTime =
-                        OriginalInformation->CreationTime.HighPart;
-
-                    ConvertedInformation.LastAccessTime.dwLowDateTime =
-                        OriginalInformation->LastAccessTime.LowPart;
-                    ConvertedInformation.LastAccessTime.dwHighDateTime =
-                        OriginalInformation->LastAccessTime.HighPart;
-
-                    ConvertedInformation.LastWriteTime.dwLowDateTime =
-                        OriginalInformation->LastWriteTime.LowPart;
-                    ConvertedInformation.LastWriteTime.dwHighDateTime =
-                        OriginalInformation->LastWriteTime.HighPart;
-
-                    ConvertedInformation.ChangeTime.dwLowDateTime =
-                        OriginalInformation->ChangeTime.LowPart;
-                    ConvertedInformation.ChangeTime.dwHighDateTime =
-                        OriginalInformation->ChangeTime.HighPart;
-
-                    ConvertedInformation.FileSize =
-                        OriginalInformation->EndOfFile.QuadPart;
-
-                    ConvertedInformation.AllocationSize =
-                        OriginalInformation->AllocationSize.QuadPart;
-
-                    ConvertedInformation.FileAttributes =
-                        OriginalInformation->FileAttributes;
-
-                    ConvertedInformation.EaSize =
-                        OriginalInformation->EaSize;
-
-                    ConvertedInformation.FileId =
-                        OriginalInformation->FileId;
-
-                    ::StringCbCopyNW(
-                        ConvertedInformation.ShortName,
-                        sizeof(ConvertedInformation.ShortName),
-                        OriginalInformation->ShortName,
-                        OriginalInformation->ShortNameLength);
-
-                    ::StringCbCopyNW(
-                        ConvertedInformation.FileName,
-                        sizeof(ConvertedInformation.FileName),
-                        OriginalInformation->FileName,
-                        OriginalInformation->FileNameLength);
-
-                    if (!Callback(&ConvertedInformation, Context))
-                    {
-                        Result = TRUE;
-                        break;
-                    }
+    static OverlappedEventCache& GetOverlappedEventCache()
+    {
+        static thread_local OverlappedEventCache CachedResult;
+        return CachedResult;
+    }
 
-                    if (OriginalInformation->NextEntryOffset)
-                    {
-                        OriginalInformation =
-                            reinterpret_cast<PFILE_ID_BOTH_DIR_INFO>(
-                                reinterpret_cast<ULONG_PTR>(OriginalInformation)
-                                + OriginalInformation->NextEntryOffset);
-                    }
-                    else
-                    {
-                        OriginalInformation =
-                            reinterpret_cast<PFILE_ID_BOTH_DIR_INFO>(Buffer);
-                        if (!::GetFileInformationByHandleEx(
-                            FileHandle,
-                            FILE_INFO_BY_HANDLE_CLASS::FileIdBothDirectoryInfo,
-                            OriginalInformation,
-                            BufferSize))
-                        {
-                            break;
-                        }
-                    }
-                }
+    // The event handle with the low-order bit set prevents the completion of
+    // the synchronous I/O request from being queued to the I/O completion
+    // port, such as the one of MILE_IO_ENGINE, associated with the file
+    // handle. The waits on the event are not affected by the bit.
+    const ULONG_PTR OverlappedEventTag = 1;
 
-                if (!Result)
-                {
-                    LastError = ::GetLastError();
-                    Result = (ERROR_NO_MORE_FILES == LastError);
-                }
-            }
+    static HANDLE AcquireOverlappedEvent()
+    {
+        HANDLE Event = nullptr;
 
-            ::MileFreeMemory(Buffer);
+        OverlappedEventCache& Cache = ::GetOverlappedEventCache();
+        if (Cache.Count)
+        {
+            Event = Cache.Events[--Cache.Count];
+            // The event may be left signaled by the previous I/O request.
+            ::ResetEvent(Event);
         }
         else
         {
-            LastError = ERROR_OUTOFMEMORY;
+            Event = ::CreateEventW(
+                nullptr,
+                TRUE,
+                FALSE,
+                nullptr);
+            if (!Event)
+            {
+                return nullptr;
+            }
         }
-    }
-    else
-    {
-        LastError = ERROR_INVALID_PARAMETER;
+
+        return reinterpret_cast<HANDLE>(
+            reinterpret_cast<ULONG_PTR>(Event) | OverlappedEventTag);
     }
 
-    if (!Result)
+    static void ReleaseOverlappedEvent(
+        _In_ HANDLE Event)
     {
-        ::SetLastError(LastError);
-    }
+        Event = reinterpret_cast<HANDLE>(
+            reinterpret_cast<ULONG_PTR>(Event) & ~OverlappedEventTag);
 
-    return Result;
+        OverlappedEventCache& Cache = ::GetOverlappedEventCache();
+        if (Cache.Count < OverlappedEventCache::MaximumCount)
+        {
+            Cache.Events[Cache.Count++] = Event;
+            return;
+        }
+
+        ::CloseHandle(Event);
+    }
 }
 
-EXTERN_C BOOL WINAPI MileDeviceIoControl(
-    _In_ HANDLE DeviceHandle,
-    _In_ DWORD IoControlCode,
-    _In_opt_ LPVOID InputBuffer,
-    _In_ DWORD InputBufferSize,
-    _Out_opt_ LPVOID OutputBuffer,
-    _In_ DWORD OutputBufferSize,
-    _Out_opt_ LPDWORD BytesReturned)
+namespace
 {
-    BOOL Result = FALSE;
-    DWORD LastError = ERROR_SUCCESS;
-    DWORD NumberOfBytesTransferred = 0;
-    OVERLAPPED Overlapped = {};
-    Overlapped.hEvent = ::CreateEventW(
-        nullptr,
-        TRUE,
-        FALSE,
-        nullptr);
-    if (Overlapped.hEvent)
+    const NTSTATUS NtStatusPending = static_cast<NTSTATUS>(0x00000103L);
+    const NTSTATUS NtStatusNoMoreFiles = static_cast<NTSTATUS>(0x80000006L);
+
+    const ULONG NtFileNamesInformationClass = 12;
+
+    typedef struct _NtFileNamesInformation
     {
-        Result = ::DeviceIoControl(
-            DeviceHandle,
-            IoControlCode,
-            InputBuffer,
-            InputBufferSize,
-            OutputBuffer,
-            OutputBufferSize,
-            &NumberOfBytesTransferred,
-            &Overlapped);
-        if (!Result)
-        {
-            LastError = ::GetLastError();
+        ULONG NextEntryOffset;
+        ULONG FileIndex;
+        ULONG FileNameLength;
+        WCHAR FileName[1];
+    } NtFileNamesInformation, * NtFileNamesInformationPointer;
 
-            if (ERROR_IO_PENDING == LastError)
+    static FARPROC GetNtQueryDirectoryFileProcAddress()
+    {
+        static FARPROC CachedResult = ([]() -> FARPROC
+        {
+            HMODULE ModuleHandle = ::GetNtDllModuleHandle();
+            if (ModuleHandle)
             {
-                Result = ::GetOverlappedResult(
-                    DeviceHandle,
-                    &Overlapped,
-                    &NumberOfBytesTransferred,
-                    TRUE);
-                if (!Result)
-                {
-                    LastError = ::GetLastError();
-                }
+                return ::GetProcAddress(
+                    ModuleHandle,
+                    "NtQueryDirectoryFile");
             }
+            return nullptr;
+        }());
+
+        return CachedResult;
+    }
+
+    static NTSTATUS NTAPI NtQueryDirectoryFileWrapper(
+        _In_ HANDLE FileHandle,
+        _In_opt_ HANDLE Event,
+        _In_opt_ PVOID ApcRoutine,
+        _In_opt_ PVOID ApcContext,
+        _Out_ NtIoStatusBlockPointer IoStatusBlock,
+        _Out_ PVOID FileInformation,
+        _In_ ULONG Length,
+        _In_ ULONG FileInformationClass,
+        _In_ BOOLEAN ReturnSingleEntry,
+        _In_opt_ NtUnicodeStringPointer FileName,
+        _In_ BOOLEAN RestartScan)
+    {
+        using ProcType = decltype(::NtQueryDirectoryFileWrapper)*;
+
+        ProcType ProcAddress = reinterpret_cast<ProcType>(
+            ::GetNtQueryDirectoryFileProcAddress());
+
+        if (ProcAddress)
+        {
+            return ProcAddress(
+                FileHandle,
+                Event,
+                ApcRoutine,
+                ApcContext,
+                IoStatusBlock,
+                FileInformation,
+                Length,
+                FileInformationClass,
+                ReturnSingleEntry,
+                FileName,
+                RestartScan);
         }
 
-        ::CloseHandle(Overlapped.hEvent);
+        return NtStatusNotImplemented;
     }
-    else
+
+    static BOOL QueryDirectoryNames(
+        _In_ HANDLE FileHandle,
+        _Out_ PVOID Buffer,
+        _In_ ULONG BufferSize,
+        _In_ bool Restart)
     {
-        LastError = ERROR_NO_SYSTEM_RESOURCES;
+        HANDLE Event = ::AcquireOverlappedEvent();
+        if (!Event)
+        {
+            ::SetLastError(ERROR_NO_SYSTEM_RESOURCES);
+            return FALSE;
+        }
+
+        // The completion is never queued to the I/O completion port without
+        // the APC context, so the untagged event is used for the native call.
+        HANDLE UntaggedEvent = reinterpret_cast<HANDLE>(
+            reinterpret_cast<ULONG_PTR>(Event) & ~OverlappedEventTag);
+
+        NtIoStatusBlock IoStatusBlock = {};
+        NTSTATUS Status = ::NtQueryDirectoryFileWrapper(
+            FileHandle,
+            UntaggedEvent,
+            nullptr,
+            nullptr,
+            &IoStatusBlock,
+            Buffer,
+            BufferSize,
+            NtFileNamesInformationClass,
+            FALSE,
+            nullptr,
+            Restart ? TRUE : FALSE);
+        if (NtStatusPending == Status)
+        {
+            // The handle is opened for the overlapped I/O.
+            ::WaitForSingleObject(UntaggedEvent, INFINITE);
+            Status = IoStatusBlock.Status;
+        }
+
+        ::ReleaseOverlappedEvent(Event);
+
+        if (NtStatusNoMoreFiles == Status)
+        {
+            ::SetLastError(ERROR_NO_MORE_FILES);
+            return FALSE;
+        }
+        if (!::IsNtStatusSuccess(Status))
+        {
+            ::SetLastError(::RtlNtStatusToDosErrorWrapper(Status));
+            return FALSE;
+        }
+
+        return TRUE;
     }
 
-    if (BytesReturned)
+    static MILE_FILE_ENUMERATE_INFORMATION_CLASS GetEnumerateInformationClass(
+        _In_ DWORD Fields)
     {
-        *BytesReturned = NumberOfBytesTransferred;
+        if (Fields & MILE_FILE_ENUMERATE_FIELD_SHORT_NAME)
+        {
+            return MILE_FILE_ENUMERATE_ID_BOTH_DIRECTORY_INFORMATION;
+        }
+        if (Fields & MILE_FILE_ENUMERATE_FIELD_FILE_ID)
+        {
+            return MILE_FILE_ENUMERATE_ID_EXTD_DIRECTORY_INFORMATION;
+        }
+        if (Fields & MILE_FILE_ENUMERATE_FIELD_BASIC)
+        {
+            return MILE_FILE_ENUMERATE_FULL_DIRECTORY_INFORMATION;
+        }
+        return MILE_FILE_ENUMERATE_NAMES_INFORMATION;
     }
 
-    if (!Result)
+    static BOOL QueryFileEnumerateBuffer(
+        _In_ HANDLE FileHandle,
+        _In_ MILE_FILE_ENUMERATE_INFORMATION_CLASS InformationClass,
+        _Out_ PVOID Buffer,
+        _In_ SIZE_T BufferSize,
+        _In_ bool Restart)
     {
-        ::SetLastError(LastError);
+        FILE_INFO_BY_HANDLE_CLASS FileInformationClass;
+        switch (InformationClass)
+        {
+        case MILE_FILE_ENUMERATE_NAMES_INFORMATION:
+            return ::QueryDirectoryNames(
+                FileHandle,
+                Buffer,
+                static_cast<ULONG>(BufferSize),
+                Restart);
+        case MILE_FILE_ENUMERATE_FULL_DIRECTORY_INFORMATION:
+            FileInformationClass = Restart
+                ? FILE_INFO_BY_HANDLE_CLASS::FileFullDirectoryRestartInfo
+                : FILE_INFO_BY_HANDLE_CLASS::FileFullDirectoryInfo;
+            break;
+        case MILE_FILE_ENUMERATE_ID_EXTD_DIRECTORY_INFORMATION:
+            FileInformationClass = Restart
+                ? FILE_INFO_BY_HANDLE_CLASS::FileIdExtdDirectoryRestartInfo
+                : FILE_INFO_BY_HANDLE_CLASS::FileIdExtdDirectoryInfo;
+            break;
+        default:
+            FileInformationClass = Restart
+                ? FILE_INFO_BY_HANDLE_CLASS::FileIdBothDirectoryRestartInfo
+                : FILE_INFO_BY_HANDLE_CLASS::FileIdBothDirectoryInfo;
+            break;
+        }
+
+        return ::GetFileInformationByHandleEx(
+            FileHandle,
+            FileInformationClass,
+            Buffer,
+            static_cast<DWORD>(BufferSize));
     }
 
-    return Result;
+    static void FillFileEnumerateView(
+        _Out_ PMILE_FILE_ENUMERATE_VIEW View,
+        _In_ PVOID Information)
+    {
+        View->Information = Information;
+
+        switch (View->InformationClass)
+        {
+        case MILE_FILE_ENUMERATE_NAMES_INFORMATION:
+        {
+            NtFileNamesInformationPointer NamesInformation =
+                reinterpret_cast<NtFileNamesInformationPointer>(Information);
+            View->FileName = NamesInformation->FileName;
+            View->FileNameLength =
+                NamesInformation->FileNameLength / sizeof(WCHAR);
+            break;
+        }
+        case MILE_FILE_ENUMERATE_FULL_DIRECTORY_INFORMATION:
+        {
+            PFILE_FULL_DIR_INFO FullInformation =
+                reinterpret_cast<PFILE_FULL_DIR_INFO>(Information);
+            View->FileName = FullInformation->FileName;
+            View->FileNameLength =
+                FullInformation->FileNameLength / sizeof(WCHAR);
+            break;
+        }
+        case MILE_FILE_ENUMERATE_ID_EXTD_DIRECTORY_INFORMATION:
+        {
+            PFILE_ID_EXTD_DIR_INFO IdExtdInformation =
+                reinterpret_cast<PFILE_ID_EXTD_DIR_INFO>(Information);
+            View->FileName = IdExtdInformation->FileName;
+            View->FileNameLength =
+                IdExtdInformation->FileNameLength / sizeof(WCHAR);
+            break;
+        }
+        default:
+        {
+            PFILE_ID_BOTH_DIR_INFO IdBothInformation =
+                reinterpret_cast<PFILE_ID_BOTH_DIR_INFO>(Information);
+            View->FileName = IdBothInformation->FileName;
+            View->FileNameLength =
+                IdBothInformation->FileNameLength / sizeof(WCHAR);
+            break;
+        }
+        }
+    }
 }
 
-EXTERN_C BOOL WINAPI MileGetFileAttributesByHandle(
-    _In_ HANDLE FileHandle,
-    _Out_ PDWORD FileAttributes)
+namespace
 {
-    FILE_BASIC_INFO BasicInfo;
+    // Fills the buffer with the first directory entries from the beginning of
+    // the directory, and falls back to the 64-bit file ID if the file system
+    // or the system does not support the extended information class.
+    static BOOL StartFileEnumerateBuffer(
+        _In_ HANDLE FileHandle,
+        _Inout_ PMILE_FILE_ENUMERATE_INFORMATION_CLASS InformationClass,
+        _Out_ PVOID Buffer,
+        _In_ SIZE_T BufferSize)
+    {
+        BOOL Result = ::QueryFileEnumerateBuffer(
+            FileHandle,
+            *InformationClass,
+            Buffer,
+            BufferSize,
+            true);
+        if (!Result &&
+            MILE_FILE_ENUMERATE_ID_EXTD_DIRECTORY_INFORMATION ==
+            *InformationClass)
+        {
+            DWORD LastError = ::GetLastError();
+            if (ERROR_INVALID_PARAMETER == LastError ||
+                ERROR_NOT_SUPPORTED == LastError)
+            {
+                *InformationClass =
+                    MILE_FILE_ENUMERATE_ID_BOTH_DIRECTORY_INFORMATION;
+                Result = ::QueryFileEnumerateBuffer(
+                    FileHandle,
+                    *InformationClass,
+                    Buffer,
+                    BufferSize,
+                    true);
+            }
+        }
 
-    BOOL Result = ::GetFileInformationByHandleEx(
-        FileHandle,
-        FILE_INFO_BY_HANDLE_CLASS::FileBasicInfo,
-        &BasicInfo,
-        sizeof(FILE_BASIC_INFO));
+        return Result;
+    }
 
-    *FileAttributes = Result
-        ? BasicInfo.FileAttributes
-        : INVALID_FILE_ATTRIBUTES;
+    typedef BOOL(*ENUMERATE_FILE_BUFFER_CALLBACK)(
+        _In_ MILE_FILE_ENUMERATE_INFORMATION_CLASS InformationClass,
+        _In_ PBYTE Buffer,
+        _In_opt_ LPVOID Context);
 
-    return Result;
-}
+    typedef struct _ENUMERATE_FILE_PREFETCH_CONTEXT
+    {
+        HANDLE FileHandle;
+        MILE_FILE_ENUMERATE_INFORMATION_CLASS InformationClass;
+        PBYTE Buffer;
+        SIZE_T BufferSize;
+        BOOL Result;
+        DWORD LastError;
+    } ENUMERATE_FILE_PREFETCH_CONTEXT, *PENUMERATE_FILE_PREFETCH_CONTEXT;
+
+    static VOID CALLBACK EnumerateFilePrefetchCallback(
+        _Inout_ PTP_CALLBACK_INSTANCE Instance,
+        _Inout_opt_ PVOID Context,
+        _Inout_ PTP_WORK Work)
+    {
+        UNREFERENCED_PARAMETER(Instance);
+        UNREFERENCED_PARAMETER(Work);
+
+        PENUMERATE_FILE_PREFETCH_CONTEXT PrefetchContext =
+            reinterpret_cast<PENUMERATE_FILE_PREFETCH_CONTEXT>(Context);
+
+        PrefetchContext->Result = ::QueryFileEnumerateBuffer(
+            PrefetchContext->FileHandle,
+            PrefetchContext->InformationClass,
+            PrefetchContext->Buffer,
+            PrefetchContext->BufferSize,
+            false);
+        PrefetchContext->LastError = PrefetchContext->Result
+            ? ERROR_SUCCESS
+            : ::GetLastError();
+    }
 
-EXTERN_C BOOL WINAPI MileSetFileAttributesByHandle(
-    _In_ HANDLE FileHandle,
-    _In_ DWORD FileAttributes)
-{
-    FILE_BASIC_INFO BasicInfo = {};
-    BasicInfo.FileAttributes =
-        FileAttributes & (
-            FILE_SHARE_READ |
-            FILE_SHARE_WRITE |
-            FILE_SHARE_DELETE |
-            FILE_ATTRIBUTE_ARCHIVE |
-            FILE_ATTRIBUTE_TEMPORARY |
-            FILE_ATTRIBUTE_OFFLINE |
-            FILE_ATTRIBUTE_NOT_CONTENT_INDEXED |
-            FILE_ATTRIBUTE_NO_SCRUB_DATA) |
-        FILE_ATTRIBUTE_NORMAL;
+    // Fills the buffer with the directory entries until the end of the
+    // directory, and calls the callback once per buffer fill. The enumeration
+    // stops without error if the callback returns FALSE. In double-buffered
+    // mode, the next fill is fetched on the thread pool while the callback
+    // consumes the current one.
+    static BOOL EnumerateFileBuffers(
+        _In_ HANDLE FileHandle,
+        _In_ DWORD Fields,
+        _In_ SIZE_T BufferSize,
+        _In_ ENUMERATE_FILE_BUFFER_CALLBACK Callback,
+        _In_opt_ LPVOID Context)
+    {
+        if (!FileHandle || FileHandle == INVALID_HANDLE_VALUE)
+        {
+            ::SetLastError(ERROR_INVALID_PARAMETER);
+            return FALSE;
+        }
 
-    return ::SetFileInformationByHandle(
-        FileHandle,
-        FILE_INFO_BY_HANDLE_CLASS::FileBasicInfo,
-        &BasicInfo,
-        sizeof(FILE_BASIC_INFO));
-}
+        const SIZE_T MinimumBufferSize = 4 * 1024;
+        const SIZE_T MaximumBufferSize = 1024 * 1024;
+        if (!BufferSize)
+        {
+            BufferSize = 32768;
+        }
+        else if (BufferSize < MinimumBufferSize)
+        {
+            BufferSize = MinimumBufferSize;
+        }
+        else if (BufferSize > MaximumBufferSize)
+        {
+            BufferSize = MaximumBufferSize;
+        }
 
-EXTERN_C BOOL WINAPI MileGetFileHardlinkCountByHandle(
-    _In_ HANDLE FileHandle,
-    _Out_ PDWORD HardlinkCount)
-{
-    FILE_STANDARD_INFO StandardInfo;
+        PBYTE Buffer = reinterpret_cast<PBYTE>(
+            ::MileAllocateMemory(BufferSize));
+        if (!Buffer)
+        {
+            ::SetLastError(ERROR_OUTOFMEMORY);
+            return FALSE;
+        }
 
-    BOOL Result = ::GetFileInformationByHandleEx(
-        FileHandle,
-        FILE_INFO_BY_HANDLE_CLASS::FileStandardInfo,
-        &StandardInfo,
-        sizeof(FILE_STANDARD_INFO));
+        MILE_FILE_ENUMERATE_INFORMATION_CLASS InformationClass =
+            ::GetEnumerateInformationClass(Fields);
 
-    *HardlinkCount = Result
-        ? StandardInfo.NumberOfLinks
-        : static_cast<DWORD>(-1);
+        BOOL Result = ::StartFileEnumerateBuffer(
+            FileHandle,
+            &InformationClass,
+            Buffer,
+            BufferSize);
 
-    return Result;
-}
+        PBYTE PrefetchBuffer = nullptr;
+        PTP_WORK PrefetchWork = nullptr;
+        ENUMERATE_FILE_PREFETCH_CONTEXT PrefetchContext = {};
+        if (Result && (Fields & MILE_FILE_ENUMERATE_FLAG_DOUBLE_BUFFERED))
+        {
+            // The single-buffered mode is used if the resources for the
+            // prefetch are not available.
+            PrefetchBuffer = reinterpret_cast<PBYTE>(
+                ::MileAllocateMemory(BufferSize));
+            if (PrefetchBuffer)
+            {
+                PrefetchContext.FileHandle = FileHandle;
+                PrefetchContext.InformationClass = InformationClass;
+                PrefetchContext.Buffer = PrefetchBuffer;
+                PrefetchContext.BufferSize = BufferSize;
+                PrefetchWork = ::CreateThreadpoolWork(
+                    ::EnumerateFilePrefetchCallback,
+                    &PrefetchContext,
+                    nullptr);
+            }
+        }
 
-EXTERN_C BOOL WINAPI MileDeleteFileByHandle(
-    _In_ HANDLE FileHandle)
-{
-    FILE_DISPOSITION_INFO DispostionInfo;
-    DispostionInfo.DeleteFile = TRUE;
-    if (::SetFileInformationByHandle(
-        FileHandle,
-        FILE_INFO_BY_HANDLE_CLASS::FileDispositionInfo,
-        &DispostionInfo,
-        sizeof(FILE_DISPOSITION_INFO)))
-    {
-        return TRUE;
+        if (Result && PrefetchWork)
+        {
+            Result = FALSE;
+
+            PBYTE CurrentBuffer = Buffer;
+            for (;;)
+            {
+                // Fetch the next buffer while the current one is consumed.
+                ::SubmitThreadpoolWork(PrefetchWork);
+                BOOL Continue = Callback(
+                    InformationClass,
+                    CurrentBuffer,
+                    Context);
+                // Cancel the prefetch if it has not started yet.
+                ::WaitForThreadpoolWorkCallbacks(PrefetchWork, !Continue);
+                if (!Continue)
+                {
+                    Result = TRUE;
+                    break;
+                }
+
+                if (!PrefetchContext.Result)
+                {
+                    ::SetLastError(PrefetchContext.LastError);
+                    break;
+                }
+
+                PBYTE NextBuffer = PrefetchContext.Buffer;
+                PrefetchContext.Buffer = CurrentBuffer;
+                CurrentBuffer = NextBuffer;
+            }
+        }
+        else if (Result)
+        {
+            Result = FALSE;
+
+            for (;;)
+            {
+                if (!Callback(InformationClass, Buffer, Context))
+                {
+                    Result = TRUE;
+                    break;
+                }
+
+                if (!::QueryFileEnumerateBuffer(
+                    FileHandle,
+                    InformationClass,
+                    Buffer,
+                    BufferSize,
+                    false))
+                {
+                    break;
+                }
+            }
+        }
+
+        DWORD LastError = ERROR_SUCCESS;
+        if (!Result)
+        {
+            LastError = ::GetLastError();
+            Result = (ERROR_NO_MORE_FILES == LastError);
+        }
+
+        if (PrefetchWork)
+        {
+            ::CloseThreadpoolWork(PrefetchWork);
+        }
+
+        if (PrefetchBuffer)
+        {
+            ::MileFreeMemory(PrefetchBuffer);
+        }
+
+        ::MileFreeMemory(Buffer);
+
+        if (!Result)
+        {
+            ::SetLastError(LastError);
+        }
+
+        return Result;
     }
 
-    FILE_DISPOSITION_INFO_EX DispostionInfoEx;
-    DispostionInfoEx.Flags = FILE_DISPOSITION_FLAG_DELETE;
-    return ::SetFileInformationByHandle(
-        FileHandle,
-        FILE_INFO_BY_HANDLE_CLASS::FileDispositionInfoEx,
-        &DispostionInfoEx,
-        sizeof(FILE_DISPOSITION_INFO_EX));
-}
+    typedef struct _ENUMERATE_FILE_VIEW_CONTEXT
+    {
+        MILE_ENUMERATE_FILE_VIEW_CALLBACK_TYPE Callback;
+        LPVOID Context;
+    } ENUMERATE_FILE_VIEW_CONTEXT, *PENUMERATE_FILE_VIEW_CONTEXT;
+
+    static BOOL EnumerateFileViewBufferCallback(
+        _In_ MILE_FILE_ENUMERATE_INFORMATION_CLASS InformationClass,
+        _In_ PBYTE Buffer,
+        _In_opt_ LPVOID Context)
+    {
+        PENUMERATE_FILE_VIEW_CONTEXT ViewContext =
+            reinterpret_cast<PENUMERATE_FILE_VIEW_CONTEXT>(Context);
 
-EXTERN_C BOOL WINAPI MileDeleteFileIgnoreReadonlyAttributeByHandle(
-    _In_ HANDLE FileHandle)
-{
-    BOOL Result = FALSE;
+        MILE_FILE_ENUMERATE_VIEW View;
+        View.InformationClass = InformationClass;
 
-    DWORD OldAttribute = 0;
-    // Save old attributes.
-    if (::MileGetFileAttributesByHandle(FileHandle, &OldAttribute))
+        PBYTE Information = Buffer;
+        for (;;)
+        {
+            ::FillFileEnumerateView(&View, Information);
+
+            if (!ViewContext->Callback(&View, ViewContext->Context))
+            {
+                return FALSE;
+            }
+
+            // All information classes start with the next entry offset.
+            DWORD NextEntryOffset = *reinterpret_cast<PDWORD>(Information);
+            if (!NextEntryOffset)
+            {
+                return TRUE;
+            }
+            Information += NextEntryOffset;
+        }
+    }
+
+    typedef struct _ENUMERATE_FILE_BATCH_CONTEXT
     {
-        // Get hardlink count.
-        DWORD HardlinkCount = 0;
-        if (::MileGetFileHardlinkCountByHandle(FileHandle, &HardlinkCount))
+        MILE_ENUMERATE_FILE_BATCH_CALLBACK_TYPE Callback;
+        LPVOID Context;
+        PMILE_FILE_ENUMERATE_VIEW Views;
+        SIZE_T Capacity;
+        DWORD Error;
+    } ENUMERATE_FILE_BATCH_CONTEXT, *PENUMERATE_FILE_BATCH_CONTEXT;
+
+    static BOOL EnumerateFileBatchBufferCallback(
+        _In_ MILE_FILE_ENUMERATE_INFORMATION_CLASS InformationClass,
+        _In_ PBYTE Buffer,
+        _In_opt_ LPVOID Context)
+    {
+        PENUMERATE_FILE_BATCH_CONTEXT BatchContext =
+            reinterpret_cast<PENUMERATE_FILE_BATCH_CONTEXT>(Context);
+
+        SIZE_T Count = 0;
+        PBYTE Information = Buffer;
+        for (;;)
         {
-            // Remove readonly attribute.
-            if (::MileSetFileAttributesByHandle(
-                FileHandle,
-                OldAttribute & (-1 ^ FILE_ATTRIBUTE_READONLY)))
+            if (Count == BatchContext->Capacity)
             {
-                // Delete the file.
-                Result = ::MileDeleteFileByHandle(FileHandle);
-                if (!Result || HardlinkCount > 1)
+                SIZE_T NewCapacity = BatchContext->Capacity
+                    ? BatchContext->Capacity * 2
+                    : 256;
+                LPVOID NewViews = BatchContext->Views
+                    ? ::MileReallocateMemory(
+                        BatchContext->Views,
+                        NewCapacity * sizeof(MILE_FILE_ENUMERATE_VIEW))
+                    : ::MileAllocateMemory(
+                        NewCapacity * sizeof(MILE_FILE_ENUMERATE_VIEW));
+                if (!NewViews)
                 {
-                    // Restore attributes if failed or had another hard links.
-                    ::MileSetFileAttributesByHandle(FileHandle, OldAttribute);
+                    BatchContext->Error = ERROR_OUTOFMEMORY;
+                    return FALSE;
                 }
+                BatchContext->Views =
+                    reinterpret_cast<PMILE_FILE_ENUMERATE_VIEW>(NewViews);
+                BatchContext->Capacity = NewCapacity;
+            }
+
+            PMILE_FILE_ENUMERATE_VIEW View = &BatchContext->Views[Count++];
+            View->InformationClass = InformationClass;
+            ::FillFileEnumerateView(View, Information);
+
+            DWORD NextEntryOffset = *reinterpret_cast<PDWORD>(Information);
+            if (!NextEntryOffset)
+            {
+                break;
             }
+            Information += NextEntryOffset;
         }
+
+        return BatchContext->Callback(
+            BatchContext->Views,
+            Count,
+            BatchContext->Context);
     }
+}
 
-    return Result;
+EXTERN_C BOOL WINAPI MileEnumerateFileByHandleEx(
+    _In_ HANDLE FileHandle,
+    _In_ DWORD Fields,
+    _In_ SIZE_T BufferSize,
+    _In_ MILE_ENUMERATE_FILE_VIEW_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context)
+{
+    if (!Callback)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    ENUMERATE_FILE_VIEW_CONTEXT ViewContext;
+    ViewContext.Callback = Callback;
+    ViewContext.Context = Context;
+
+    return ::EnumerateFileBuffers(
+        FileHandle,
+        Fields,
+        BufferSize,
+        ::EnumerateFileViewBufferCallback,
+        &ViewContext);
 }
 
-EXTERN_C BOOL WINAPI MileGetFileSizeByHandle(
+EXTERN_C BOOL WINAPI MileEnumerateFileBatchByHandle(
     _In_ HANDLE FileHandle,
-    _Out_ PULONGLONG FileSize)
+    _In_ DWORD Fields,
+    _In_ SIZE_T BufferSize,
+    _In_ MILE_ENUMERATE_FILE_BATCH_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context)
 {
-    FILE_STANDARD_INFO StandardInfo;
+    if (!Callback)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
 
-    BOOL Result = ::GetFileInformationByHandleEx(
+    ENUMERATE_FILE_BATCH_CONTEXT BatchContext = {};
+    BatchContext.Callback = Callback;
+    BatchContext.Context = Context;
+
+    BOOL Result = ::EnumerateFileBuffers(
         FileHandle,
-        FILE_INFO_BY_HANDLE_CLASS::FileStandardInfo,
-        &StandardInfo,
-        sizeof(FILE_STANDARD_INFO));
+        Fields,
+        BufferSize,
+        ::EnumerateFileBatchBufferCallback,
+        &BatchContext);
+    DWORD LastError = Result ? BatchContext.Error : ::GetLastError();
+    if (ERROR_SUCCESS != LastError)
+    {
+        Result = FALSE;
+    }
 
-    *FileSize = Result
-        ? static_cast<ULONGLONG>(StandardInfo.EndOfFile.QuadPart)
-        : 0;
+    if (BatchContext.Views)
+    {
+        ::MileFreeMemory(BatchContext.Views);
+    }
+
+    if (!Result)
+    {
+        ::SetLastError(LastError);
+    }
 
     return Result;
 }
 
-EXTERN_C BOOL WINAPI MileGetFileAllocationSizeByHandle(
+EXTERN_C BOOL WINAPI MileEnumerateFileViewByHandle(
     _In_ HANDLE FileHandle,
-    _Out_ PULONGLONG AllocationSize)
+    _In_ MILE_ENUMERATE_FILE_VIEW_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context)
 {
-    FILE_STANDARD_INFO StandardInfo;
-
-    BOOL Result = ::GetFileInformationByHandleEx(
+    return ::MileEnumerateFileByHandleEx(
         FileHandle,
-        FILE_INFO_BY_HANDLE_CLASS::FileStandardInfo,
-        &StandardInfo,
-        sizeof(FILE_STANDARD_INFO));
-
-    *AllocationSize = Result
-        ? static_cast<ULONGLONG>(StandardInfo.AllocationSize.QuadPart)
-        : 0;
+        MILE_FILE_ENUMERATE_FIELD_ALL,
+        0,
+        Callback,
+        Context);
+}
 
-    return Result;
+namespace
+{
+    typedef struct _ENUMERATE_FILE_CONTEXT
+    {
+        MILE_ENUMERATE_FILE_CALLBACK_TYPE Callback;
+        LPVOID Context;
+        MILE_FILE_ENUMERATE_INFORMATION Information;
+    } ENUMERATE_FILE_CONTEXT, *PENUMERATE_FILE_CONTEXT;
+
+    static BOOL WINAPI EnumerateFileViewCallback(
+        _In_ PMILE_FILE_ENUMERATE_VIEW View,
+        _In_opt_ LPVOID Context)
+    {
+        PENUMERATE_FILE_CONTEXT EnumerateContext =
+            reinterpret_cast<PENUMERATE_FILE_CONTEXT>(Context);
+        PFILE_ID_BOTH_DIR_INFO OriginalInformation =
+            reinterpret_cast<PFILE_ID_BOTH_DIR_INFO>(View->Information);
+        PMILE_FILE_ENUMERATE_INFORMATION ConvertedInformation =
+            &EnumerateContext->Information;
+
+        ConvertedInformation->CreationTime.dwLowDateTime =
+            OriginalInformation->CreationTime.LowPart;
+        ConvertedInformation->CreationTime.dwHighDateTime =
+            OriginalInformation->CreationTime.HighPart;
+
+        ConvertedInformation->LastAccessTime.dwLowDateTime =
+            OriginalInformation->LastAccessTime.LowPart;
+        ConvertedInformation->LastAccessTime.dwHighDateTime =
+            OriginalInformation->LastAccessTime.HighPart;
+
+        ConvertedInformation->LastWriteTime.dwLowDateTime =
+            OriginalInformation->LastWriteTime.LowPart;
+        ConvertedInformation->LastWriteTime.dwHighDateTime =
+            OriginalInformation->LastWriteTime.HighPart;
+
+        ConvertedInformation->ChangeTime.dwLowDateTime =
+            OriginalInformation->ChangeTime.LowPart;
+        ConvertedInformation->ChangeTime.dwHighDateTime =
+            OriginalInformation->ChangeTime.HighPart;
+
+        ConvertedInformation->FileSize =
+            OriginalInformation->EndOfFile.QuadPart;
+
+        ConvertedInformation->AllocationSize =
+            OriginalInformation->AllocationSize.QuadPart;
+
+        ConvertedInformation->FileAttributes =
+            OriginalInformation->FileAttributes;
+
+        ConvertedInformation->EaSize =
+            OriginalInformation->EaSize;
+
+        ConvertedInformation->FileId =
+            OriginalInformation->FileId;
+
+        ::StringCbCopyNW(
+            ConvertedInformation->ShortName,
+            sizeof(ConvertedInformation->ShortName),
+            OriginalInformation->ShortName,
+            OriginalInformation->ShortNameLength);
+
+        ::StringCbCopyNW(
+            ConvertedInformation->FileName,
+            sizeof(ConvertedInformation->FileName),
+            OriginalInformation->FileName,
+            OriginalInformation->FileNameLength);
+
+        return EnumerateContext->Callback(
+            ConvertedInformation,
+            EnumerateContext->Context);
+    }
 }
 
-EXTERN_C BOOL WINAPI MileGetCompressedFileSizeByHandle(
+EXTERN_C BOOL WINAPI MileEnumerateFileByHandle(
     _In_ HANDLE FileHandle,
-    _Out_ PULONGLONG CompressedFileSize)
+    _In_ MILE_ENUMERATE_FILE_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context)
 {
-    FILE_COMPRESSION_INFO FileCompressionInfo;
+    if (!Callback)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
 
-    if (::GetFileInformationByHandleEx(
+    ENUMERATE_FILE_CONTEXT EnumerateContext = {};
+    EnumerateContext.Callback = Callback;
+    EnumerateContext.Context = Context;
+
+    return ::MileEnumerateFileViewByHandle(
         FileHandle,
-        FILE_INFO_BY_HANDLE_CLASS::FileCompressionInfo,
-        &FileCompressionInfo,
-        sizeof(FILE_COMPRESSION_INFO)))
+        ::EnumerateFileViewCallback,
+        &EnumerateContext);
+}
+
+namespace
+{
+    // The directory to be walked. The handle is opened relative to the handle
+    // of the parent directory when the node is dequeued, so the queued nodes
+    // only keep the handles of their parent directories open.
+    typedef struct _WALK_DIRECTORY_TREE_NODE
     {
-        *CompressedFileSize = static_cast<ULONGLONG>(
-            FileCompressionInfo.CompressedFileSize.QuadPart);
+        struct _WALK_DIRECTORY_TREE_NODE* Parent;
+        volatile LONG ReferenceCount;
+        HANDLE Handle;
+        LPWSTR Path;
+        SIZE_T PathLength;
+        LPCWSTR Name;
+        DWORD Depth;
+    } WALK_DIRECTORY_TREE_NODE, *PWALK_DIRECTORY_TREE_NODE;
+
+    static void ReleaseWalkDirectoryTreeNode(
+        _In_ PWALK_DIRECTORY_TREE_NODE Node)
+    {
+        // The root node is never released because the walk always holds a
+        // reference to it.
+        if (0 != ::InterlockedDecrement(&Node->ReferenceCount))
+        {
+            return;
+        }
+
+        if (Node->Handle)
+        {
+            ::CloseHandle(Node->Handle);
+        }
+        if (Node->Parent)
+        {
+            ::ReleaseWalkDirectoryTreeNode(Node->Parent);
+        }
+        ::MileFreeMemory(Node);
+    }
+
+    // The double-ended queue of a worker. The owner pushes and pops the nodes
+    // at the back for the depth-first locality, and the other workers steal
+    // the nodes at the front, which are usually the roots of larger subtrees.
+    typedef struct _WALK_DIRECTORY_TREE_QUEUE
+    {
+        SRWLOCK Lock;
+        PWALK_DIRECTORY_TREE_NODE* Items;
+        SIZE_T Capacity;
+        SIZE_T Head;
+        SIZE_T Count;
+    } WALK_DIRECTORY_TREE_QUEUE, *PWALK_DIRECTORY_TREE_QUEUE;
+
+    static bool PushWalkDirectoryTreeNode(
+        _In_ PWALK_DIRECTORY_TREE_QUEUE Queue,
+        _In_ PWALK_DIRECTORY_TREE_NODE Node)
+    {
+        bool Result = true;
+
+        ::AcquireSRWLockExclusive(&Queue->Lock);
+
+        if (Queue->Count == Queue->Capacity)
+        {
+            SIZE_T NewCapacity = Queue->Capacity ? Queue->Capacity * 2 : 64;
+            PWALK_DIRECTORY_TREE_NODE* NewItems =
+                reinterpret_cast<PWALK_DIRECTORY_TREE_NODE*>(
+                    ::MileAllocateMemory(
+                        NewCapacity * sizeof(PWALK_DIRECTORY_TREE_NODE)));
+            if (NewItems)
+            {
+                for (SIZE_T i = 0; i < Queue->Count; ++i)
+                {
+                    NewItems[i] = Queue->Items[
+                        (Queue->Head + i) % Queue->Capacity];
+                }
+                if (Queue->Items)
+                {
+                    ::MileFreeMemory(Queue->Items);
+                }
+                Queue->Items = NewItems;
+                Queue->Capacity = NewCapacity;
+                Queue->Head = 0;
+            }
+            else
+            {
+                Result = false;
+            }
+        }
+
+        if (Result)
+        {
+            Queue->Items[(Queue->Head + Queue->Count) % Queue->Capacity] = Node;
+            ++Queue->Count;
+        }
+
+        ::ReleaseSRWLockExclusive(&Queue->Lock);
+
+        return Result;
+    }
+
+    static PWALK_DIRECTORY_TREE_NODE PopWalkDirectoryTreeNode(
+        _In_ PWALK_DIRECTORY_TREE_QUEUE Queue,
+        _In_ bool Steal)
+    {
+        PWALK_DIRECTORY_TREE_NODE Node = nullptr;
+
+        ::AcquireSRWLockExclusive(&Queue->Lock);
+
+        if (Queue->Count)
+        {
+            if (Steal)
+            {
+                Node = Queue->Items[Queue->Head];
+                Queue->Head = (Queue->Head + 1) % Queue->Capacity;
+            }
+            else
+            {
+                Node = Queue->Items[
+                    (Queue->Head + Queue->Count - 1) % Queue->Capacity];
+            }
+            --Queue->Count;
+        }
+
+        ::ReleaseSRWLockExclusive(&Queue->Lock);
+
+        return Node;
+    }
+
+    typedef struct _WALK_DIRECTORY_TREE_CONTEXT
+    {
+        DWORD Flags;
+        DWORD Fields;
+        DWORD MaximumDepth;
+        MILE_WALK_DIRECTORY_TREE_CALLBACK_TYPE Callback;
+        LPVOID Context;
+        PWALK_DIRECTORY_TREE_QUEUE Queues;
+        DWORD NumberOfQueues;
+        volatile LONG NextQueueIndex;
+        // The number of the nodes which are queued or being walked.
+        volatile LONG PendingNodes;
+        volatile LONG Stopped;
+        DWORD Error;
+        // The idle workers wait on the condition variable until the
+        // generation is changed by queuing a node or finishing the walk.
+        SRWLOCK IdleLock;
+        CONDITION_VARIABLE IdleCondition;
+        LONG Generation;
+        volatile LONG IdleWorkers;
+    } WALK_DIRECTORY_TREE_CONTEXT, *PWALK_DIRECTORY_TREE_CONTEXT;
+
+    static void WakeWalkDirectoryTreeWorkers(
+        _In_ PWALK_DIRECTORY_TREE_CONTEXT WalkContext,
+        _In_ bool WakeAll)
+    {
+        ::AcquireSRWLockExclusive(&WalkContext->IdleLock);
+        ++WalkContext->Generation;
+        ::ReleaseSRWLockExclusive(&WalkContext->IdleLock);
+
+        if (WakeAll)
+        {
+            ::WakeAllConditionVariable(&WalkContext->IdleCondition);
+        }
+        else
+        {
+            ::WakeConditionVariable(&WalkContext->IdleCondition);
+        }
+    }
+
+    static void StopWalkDirectoryTree(
+        _In_ PWALK_DIRECTORY_TREE_CONTEXT WalkContext,
+        _In_ DWORD Error)
+    {
+        if (0 == ::InterlockedExchange(&WalkContext->Stopped, 1))
+        {
+            WalkContext->Error = Error;
+            ::WakeWalkDirectoryTreeWorkers(WalkContext, true);
+        }
+    }
+
+    static PWALK_DIRECTORY_TREE_NODE CreateWalkDirectoryTreeNode(
+        _In_ PWALK_DIRECTORY_TREE_NODE ParentNode,
+        _In_ PMILE_FILE_ENUMERATE_VIEW View)
+    {
+        const SIZE_T MaximumPathLength = 32767;
+
+        SIZE_T PathLength = ParentNode->PathLength;
+        if (PathLength)
+        {
+            ++PathLength;
+        }
+        PathLength += View->FileNameLength;
+        if (PathLength > MaximumPathLength)
+        {
+            ::SetLastError(ERROR_FILENAME_EXCED_RANGE);
+            return nullptr;
+        }
+
+        // The node and its null-terminated path are allocated together.
+        PWALK_DIRECTORY_TREE_NODE Node =
+            reinterpret_cast<PWALK_DIRECTORY_TREE_NODE>(::MileAllocateMemory(
+                sizeof(WALK_DIRECTORY_TREE_NODE) +
+                (PathLength + 1) * sizeof(WCHAR)));
+        if (!Node)
+        {
+            ::SetLastError(ERROR_OUTOFMEMORY);
+            return nullptr;
+        }
+        Node->ReferenceCount = 1;
+        Node->Path = reinterpret_cast<LPWSTR>(&Node[1]);
+        Node->PathLength = PathLength;
+        Node->Name = Node->Path + PathLength - View->FileNameLength;
+        Node->Depth = ParentNode->Depth + 1;
+
+        LPWSTR Current = Node->Path;
+        if (ParentNode->PathLength)
+        {
+            std::memcpy(
+                Current,
+                ParentNode->Path,
+                ParentNode->PathLength * sizeof(WCHAR));
+            Current += ParentNode->PathLength;
+            *Current++ = L'\\';
+        }
+        std::memcpy(
+            Current,
+            View->FileName,
+            View->FileNameLength * sizeof(WCHAR));
+
+        ::InterlockedIncrement(&ParentNode->ReferenceCount);
+        Node->Parent = ParentNode;
+
+        return Node;
+    }
+
+    static bool OpenWalkDirectoryTreeNode(
+        _In_ PWALK_DIRECTORY_TREE_CONTEXT WalkContext,
+        _In_ PWALK_DIRECTORY_TREE_NODE Node)
+    {
+        DWORD FlagsAndAttributes = FILE_FLAG_BACKUP_SEMANTICS;
+        if (!(WalkContext->Flags &
+            MILE_WALK_DIRECTORY_TREE_FLAG_FOLLOW_REPARSE_POINTS))
+        {
+            FlagsAndAttributes |= FILE_FLAG_OPEN_REPARSE_POINT;
+        }
+
+        // The name at the end of the path is null-terminated.
+        HANDLE Handle = ::MileCreateFileRelative(
+            Node->Parent->Handle,
+            Node->Name,
+            FILE_LIST_DIRECTORY | FILE_TRAVERSE,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            OPEN_EXISTING,
+            FlagsAndAttributes);
+        if (INVALID_HANDLE_VALUE == Handle)
+        {
+            return false;
+        }
+        Node->Handle = Handle;
+
+        // The parent directory is no longer needed after the open.
+        ::ReleaseWalkDirectoryTreeNode(Node->Parent);
+        Node->Parent = nullptr;
+
+        return true;
+    }
+
+    // Reports the entry to the callback, and returns the node of the
+    // subdirectory to be walked, or nullptr if the entry is not descended.
+    static PWALK_DIRECTORY_TREE_NODE VisitWalkDirectoryTreeEntry(
+        _In_ PWALK_DIRECTORY_TREE_CONTEXT WalkContext,
+        _In_ PWALK_DIRECTORY_TREE_NODE Node,
+        _In_ PMILE_FILE_ENUMERATE_VIEW View)
+    {
+        if (View->FileNameLength <= 2 &&
+            L'.' == View->FileName[0] &&
+            (1 == View->FileNameLength || L'.' == View->FileName[1]))
+        {
+            return nullptr;
+        }
+
+        // All information classes with the basic fields share the layout of
+        // FILE_FULL_DIR_INFO up to the file attributes.
+        DWORD FileAttributes = reinterpret_cast<PFILE_FULL_DIR_INFO>(
+            View->Information)->FileAttributes;
+        bool IsReparsePoint =
+            (0 != (FileAttributes & FILE_ATTRIBUTE_REPARSE_POINT));
+        if (IsReparsePoint &&
+            (WalkContext->Flags &
+                MILE_WALK_DIRECTORY_TREE_FLAG_SKIP_REPARSE_POINTS))
+        {
+            return nullptr;
+        }
+
+        MILE_WALK_DIRECTORY_TREE_ENTRY Entry;
+        Entry.DirectoryHandle = Node->Handle;
+        Entry.DirectoryPath = Node->Path;
+        Entry.Depth = Node->Depth;
+        Entry.FileAttributes = FileAttributes;
+        Entry.View = *View;
+
+        MILE_WALK_DIRECTORY_TREE_ACTION Action = WalkContext->Callback(
+            &Entry,
+            WalkContext->Context);
+        if (MILE_WALK_DIRECTORY_TREE_STOP == Action)
+        {
+            ::StopWalkDirectoryTree(WalkContext, ERROR_SUCCESS);
+            return nullptr;
+        }
+
+        if (MILE_WALK_DIRECTORY_TREE_SKIP_SUBTREE == Action ||
+            !(FileAttributes & FILE_ATTRIBUTE_DIRECTORY) ||
+            Entry.Depth >= WalkContext->MaximumDepth ||
+            (IsReparsePoint &&
+                !(WalkContext->Flags &
+                    MILE_WALK_DIRECTORY_TREE_FLAG_FOLLOW_REPARSE_POINTS)))
+        {
+            return nullptr;
+        }
+
+        PWALK_DIRECTORY_TREE_NODE ChildNode =
+            ::CreateWalkDirectoryTreeNode(Node, View);
+        if (!ChildNode && ERROR_OUTOFMEMORY == ::GetLastError())
+        {
+            ::StopWalkDirectoryTree(WalkContext, ERROR_OUTOFMEMORY);
+        }
+
+        return ChildNode;
+    }
+
+    typedef struct _WALK_DIRECTORY_TREE_NODE_CONTEXT
+    {
+        PWALK_DIRECTORY_TREE_CONTEXT WalkContext;
+        PWALK_DIRECTORY_TREE_NODE Node;
+        DWORD QueueIndex;
+    } WALK_DIRECTORY_TREE_NODE_CONTEXT, *PWALK_DIRECTORY_TREE_NODE_CONTEXT;
+
+    static BOOL WINAPI WalkDirectoryTreeViewCallback(
+        _In_ PMILE_FILE_ENUMERATE_VIEW View,
+        _In_opt_ LPVOID Context)
+    {
+        PWALK_DIRECTORY_TREE_NODE_CONTEXT NodeContext =
+            reinterpret_cast<PWALK_DIRECTORY_TREE_NODE_CONTEXT>(Context);
+        PWALK_DIRECTORY_TREE_CONTEXT WalkContext = NodeContext->WalkContext;
+
+        if (WalkContext->Stopped)
+        {
+            return FALSE;
+        }
+
+        PWALK_DIRECTORY_TREE_NODE ChildNode = ::VisitWalkDirectoryTreeEntry(
+            WalkContext,
+            NodeContext->Node,
+            View);
+        if (ChildNode)
+        {
+            ::InterlockedIncrement(&WalkContext->PendingNodes);
+            if (!::PushWalkDirectoryTreeNode(
+                &WalkContext->Queues[NodeContext->QueueIndex],
+                ChildNode))
+            {
+                ::InterlockedDecrement(&WalkContext->PendingNodes);
+                ::ReleaseWalkDirectoryTreeNode(ChildNode);
+                ::StopWalkDirectoryTree(WalkContext, ERROR_OUTOFMEMORY);
+            }
+            else if (::InterlockedCompareExchange(
+                &WalkContext->IdleWorkers,
+                0,
+                0))
+            {
+                // The interlocked read orders the check after the push, so
+                // an idle worker either finds the node or is woken here.
+                ::WakeWalkDirectoryTreeWorkers(WalkContext, false);
+            }
+        }
+
+        return !WalkContext->Stopped;
+    }
+
+    static BOOL WalkDirectoryTreeNode(
+        _In_ PWALK_DIRECTORY_TREE_CONTEXT WalkContext,
+        _In_ PWALK_DIRECTORY_TREE_NODE Node,
+        _In_ DWORD QueueIndex)
+    {
+        WALK_DIRECTORY_TREE_NODE_CONTEXT NodeContext;
+        NodeContext.WalkContext = WalkContext;
+        NodeContext.Node = Node;
+        NodeContext.QueueIndex = QueueIndex;
+
+        return ::MileEnumerateFileByHandleEx(
+            Node->Handle,
+            WalkContext->Fields | MILE_FILE_ENUMERATE_FIELD_BASIC,
+            0,
+            ::WalkDirectoryTreeViewCallback,
+            &NodeContext);
+    }
+
+    // Pops a node from the queue of the worker, or steals one from the
+    // queues of the other workers.
+    static PWALK_DIRECTORY_TREE_NODE TakeWalkDirectoryTreeNode(
+        _In_ PWALK_DIRECTORY_TREE_CONTEXT WalkContext,
+        _In_ DWORD QueueIndex)
+    {
+        DWORD NumberOfQueues = WalkContext->NumberOfQueues;
+
+        PWALK_DIRECTORY_TREE_NODE Node = ::PopWalkDirectoryTreeNode(
+            &WalkContext->Queues[QueueIndex],
+            false);
+        for (DWORD i = 1; !Node && i < NumberOfQueues; ++i)
+        {
+            Node = ::PopWalkDirectoryTreeNode(
+                &WalkContext->Queues[(QueueIndex + i) % NumberOfQueues],
+                true);
+        }
+
+        return Node;
+    }
+
+    static VOID CALLBACK WalkDirectoryTreeWorkCallback(
+        _Inout_ PTP_CALLBACK_INSTANCE Instance,
+        _Inout_opt_ PVOID Context,
+        _Inout_ PTP_WORK Work)
+    {
+        UNREFERENCED_PARAMETER(Instance);
+        UNREFERENCED_PARAMETER(Work);
+
+        PWALK_DIRECTORY_TREE_CONTEXT WalkContext =
+            reinterpret_cast<PWALK_DIRECTORY_TREE_CONTEXT>(Context);
+
+        DWORD NumberOfQueues = WalkContext->NumberOfQueues;
+        DWORD QueueIndex = static_cast<DWORD>(
+            ::InterlockedIncrement(&WalkContext->NextQueueIndex) - 1);
+        QueueIndex %= NumberOfQueues;
+
+        while (!WalkContext->Stopped && WalkContext->PendingNodes > 0)
+        {
+            PWALK_DIRECTORY_TREE_NODE Node = ::TakeWalkDirectoryTreeNode(
+                WalkContext,
+                QueueIndex);
+            if (!Node)
+            {
+                // Other workers are still walking the directories which may
+                // produce more nodes. Announce the idle state before checking
+                // the queues again, so the worker which queues the next node
+                // always wakes this worker.
+                ::InterlockedIncrement(&WalkContext->IdleWorkers);
+
+                ::AcquireSRWLockExclusive(&WalkContext->IdleLock);
+                LONG Generation = WalkContext->Generation;
+                ::ReleaseSRWLockExclusive(&WalkContext->IdleLock);
+
+                Node = ::TakeWalkDirectoryTreeNode(WalkContext, QueueIndex);
+                if (!Node)
+                {
+                    ::AcquireSRWLockExclusive(&WalkContext->IdleLock);
+                    while (Generation == WalkContext->Generation &&
+                        !WalkContext->Stopped &&
+                        WalkContext->PendingNodes > 0)
+                    {
+                        ::SleepConditionVariableSRW(
+                            &WalkContext->IdleCondition,
+                            &WalkContext->IdleLock,
+                            INFINITE,
+                            0);
+                    }
+                    ::ReleaseSRWLockExclusive(&WalkContext->IdleLock);
+                }
+
+                ::InterlockedDecrement(&WalkContext->IdleWorkers);
+
+                if (!Node)
+                {
+                    continue;
+                }
+            }
+
+            // Skip the subdirectories which cannot be opened or enumerated.
+            if (::OpenWalkDirectoryTreeNode(WalkContext, Node))
+            {
+                ::WalkDirectoryTreeNode(WalkContext, Node, QueueIndex);
+            }
+            ::ReleaseWalkDirectoryTreeNode(Node);
+            if (0 == ::InterlockedDecrement(&WalkContext->PendingNodes))
+            {
+                // Let all idle workers exit.
+                ::WakeWalkDirectoryTreeWorkers(WalkContext, true);
+            }
+        }
+    }
+
+    // The enumeration state of a directory in the deterministic walk.
+    typedef struct _WALK_DIRECTORY_TREE_FRAME
+    {
+        PWALK_DIRECTORY_TREE_NODE Node;
+        MILE_FILE_ENUMERATE_INFORMATION_CLASS InformationClass;
+        PBYTE Buffer;
+        // The next entry in the buffer, or nullptr if the buffer needs to be
+        // filled again.
+        PBYTE Information;
+    } WALK_DIRECTORY_TREE_FRAME, *PWALK_DIRECTORY_TREE_FRAME;
+
+    const SIZE_T WalkDirectoryTreeBufferSize = 32768;
+
+    // Ends the enumeration of the directory after the end of the directory
+    // is reached or the enumeration fails, and returns false if the
+    // enumeration of the root directory fails. The subdirectories which
+    // cannot be enumerated are skipped.
+    static bool EndWalkDirectoryTreeFrame(
+        _In_ PWALK_DIRECTORY_TREE_FRAME Frame,
+        _In_ PWALK_DIRECTORY_TREE_NODE RootNode,
+        _Out_ PDWORD LastError)
+    {
+        bool Result = true;
+
+        if (Frame->Node == RootNode)
+        {
+            *LastError = ::GetLastError();
+            Result = (ERROR_NO_MORE_FILES == *LastError);
+        }
+        else
+        {
+            ::ReleaseWalkDirectoryTreeNode(Frame->Node);
+        }
+        ::MileFreeMemory(Frame->Buffer);
+
+        return Result;
+    }
+
+    // Walks the directory tree in pre-order on the calling thread with an
+    // explicit stack of the directories being enumerated, so the depth of the
+    // tree is not limited by the stack of the thread.
+    static BOOL WalkDirectoryTreeDeterministic(
+        _In_ PWALK_DIRECTORY_TREE_CONTEXT WalkContext,
+        _In_ PWALK_DIRECTORY_TREE_NODE RootNode)
+    {
+        PWALK_DIRECTORY_TREE_FRAME Frames = nullptr;
+        SIZE_T Capacity = 0;
+        SIZE_T Count = 0;
+
+        MILE_FILE_ENUMERATE_INFORMATION_CLASS InformationClass =
+            ::GetEnumerateInformationClass(
+                WalkContext->Fields | MILE_FILE_ENUMERATE_FIELD_BASIC);
+
+        BOOL Result = TRUE;
+        DWORD LastError = ERROR_SUCCESS;
+
+        PWALK_DIRECTORY_TREE_NODE Node = RootNode;
+        while (Node)
+        {
+            if (Count == Capacity)
+            {
+                SIZE_T NewCapacity = Capacity ? Capacity * 2 : 16;
+                LPVOID NewFrames = Frames
+                    ? ::MileReallocateMemory(
+                        Frames,
+                        NewCapacity * sizeof(WALK_DIRECTORY_TREE_FRAME))
+                    : ::MileAllocateMemory(
+                        NewCapacity * sizeof(WALK_DIRECTORY_TREE_FRAME));
+                if (!NewFrames)
+                {
+                    if (Node != RootNode)
+                    {
+                        ::ReleaseWalkDirectoryTreeNode(Node);
+                    }
+                    ::StopWalkDirectoryTree(WalkContext, ERROR_OUTOFMEMORY);
+                    break;
+                }
+                Frames = reinterpret_cast<PWALK_DIRECTORY_TREE_FRAME>(
+                    NewFrames);
+                Capacity = NewCapacity;
+            }
+
+            PWALK_DIRECTORY_TREE_FRAME Frame = &Frames[Count];
+            Frame->Node = Node;
+            Frame->InformationClass = InformationClass;
+            Frame->Buffer = reinterpret_cast<PBYTE>(
+                ::MileAllocateMemory(WalkDirectoryTreeBufferSize));
+            if (!Frame->Buffer)
+            {
+                if (Node != RootNode)
+                {
+                    ::ReleaseWalkDirectoryTreeNode(Node);
+                }
+                ::StopWalkDirectoryTree(WalkContext, ERROR_OUTOFMEMORY);
+                break;
+            }
+            Frame->Information = Frame->Buffer;
+            ++Count;
+
+            Node = nullptr;
+            if (!::StartFileEnumerateBuffer(
+                Frame->Node->Handle,
+                &Frame->InformationClass,
+                Frame->Buffer,
+                WalkDirectoryTreeBufferSize))
+            {
+                if (!::EndWalkDirectoryTreeFrame(Frame, RootNode, &LastError))
+                {
+                    Result = FALSE;
+                }
+                --Count;
+            }
+
+            // Continue the enumeration of the innermost directory until a
+            // subdirectory to be walked is found.
+            while (Count && !Node && !WalkContext->Stopped)
+            {
+                Frame = &Frames[Count - 1];
+
+                if (!Frame->Information)
+                {
+                    if (!::QueryFileEnumerateBuffer(
+                        Frame->Node->Handle,
+                        Frame->InformationClass,
+                        Frame->Buffer,
+                        WalkDirectoryTreeBufferSize,
+                        false))
+                    {
+                        if (!::EndWalkDirectoryTreeFrame(
+                            Frame,
+                            RootNode,
+                            &LastError))
+                        {
+                            Result = FALSE;
+                        }
+                        --Count;
+                        continue;
+                    }
+                    Frame->Information = Frame->Buffer;
+                }
+
+                MILE_FILE_ENUMERATE_VIEW View;
+                View.InformationClass = Frame->InformationClass;
+                ::FillFileEnumerateView(&View, Frame->Information);
+
+                // All information classes start with the next entry offset.
+                DWORD NextEntryOffset =
+                    *reinterpret_cast<PDWORD>(Frame->Information);
+                Frame->Information = NextEntryOffset
+                    ? Frame->Information + NextEntryOffset
+                    : nullptr;
+
+                Node = ::VisitWalkDirectoryTreeEntry(
+                    WalkContext,
+                    Frame->Node,
+                    &View);
+                if (Node && !::OpenWalkDirectoryTreeNode(WalkContext, Node))
+                {
+                    // Skip the subdirectories which cannot be opened.
+                    ::ReleaseWalkDirectoryTreeNode(Node);
+                    Node = nullptr;
+                }
+            }
+
+            if (WalkContext->Stopped && Node)
+            {
+                ::ReleaseWalkDirectoryTreeNode(Node);
+                Node = nullptr;
+            }
+        }
+
+        // Release the directories left by the terminated walk.
+        while (Count)
+        {
+            PWALK_DIRECTORY_TREE_FRAME Frame = &Frames[--Count];
+            if (Frame->Node != RootNode)
+            {
+                ::ReleaseWalkDirectoryTreeNode(Frame->Node);
+            }
+            ::MileFreeMemory(Frame->Buffer);
+        }
+        if (Frames)
+        {
+            ::MileFreeMemory(Frames);
+        }
+
+        if (!Result)
+        {
+            ::SetLastError(LastError);
+        }
+
+        return Result;
+    }
+}
+
+EXTERN_C BOOL WINAPI MileWalkDirectoryTree(
+    _In_ HANDLE RootDirectoryHandle,
+    _In_ DWORD Flags,
+    _In_ DWORD Fields,
+    _In_ DWORD MaximumDepth,
+    _In_ DWORD MaximumConcurrency,
+    _In_ MILE_WALK_DIRECTORY_TREE_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context)
+{
+    if (!RootDirectoryHandle ||
+        RootDirectoryHandle == INVALID_HANDLE_VALUE ||
+        !Callback)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if (!MaximumConcurrency)
+    {
+        MaximumConcurrency = ::MileGetNumberOfHardwareThreads();
+    }
+
+    WALK_DIRECTORY_TREE_CONTEXT WalkContext = {};
+    WalkContext.Flags = Flags;
+    WalkContext.Fields = Fields;
+    WalkContext.MaximumDepth = MaximumDepth;
+    WalkContext.Callback = Callback;
+    WalkContext.Context = Context;
+
+    // The walk holds the only reference to the root node, so the root node
+    // is never released and the root directory handle is never closed.
+    WCHAR RootPath[1] = {};
+    WALK_DIRECTORY_TREE_NODE RootNode = {};
+    RootNode.ReferenceCount = 1;
+    RootNode.Handle = RootDirectoryHandle;
+    RootNode.Path = RootPath;
+    RootNode.Name = RootPath;
+
+    BOOL Result = FALSE;
+    DWORD LastError = ERROR_SUCCESS;
+
+    if (Flags & MILE_WALK_DIRECTORY_TREE_FLAG_DETERMINISTIC)
+    {
+        Result = ::WalkDirectoryTreeDeterministic(&WalkContext, &RootNode);
+        LastError = Result ? ERROR_SUCCESS : ::GetLastError();
+    }
+    else
+    {
+        WalkContext.NumberOfQueues = MaximumConcurrency;
+        WalkContext.Queues = reinterpret_cast<PWALK_DIRECTORY_TREE_QUEUE>(
+            ::MileAllocateMemory(
+                MaximumConcurrency * sizeof(WALK_DIRECTORY_TREE_QUEUE)));
+        if (!WalkContext.Queues)
+        {
+            ::SetLastError(ERROR_OUTOFMEMORY);
+            return FALSE;
+        }
+        for (DWORD i = 0; i < MaximumConcurrency; ++i)
+        {
+            ::InitializeSRWLock(&WalkContext.Queues[i].Lock);
+        }
+        ::InitializeSRWLock(&WalkContext.IdleLock);
+        ::InitializeConditionVariable(&WalkContext.IdleCondition);
+
+        // The root directory is walked on the calling thread, and its
+        // subdirectories are queued for the workers.
+        Result = ::WalkDirectoryTreeNode(&WalkContext, &RootNode, 0);
+        LastError = Result ? ERROR_SUCCESS : ::GetLastError();
+
+        if (Result && !WalkContext.Stopped && WalkContext.PendingNodes > 0)
+        {
+            PTP_WORK Work = nullptr;
+            if (MaximumConcurrency > 1)
+            {
+                Work = ::CreateThreadpoolWork(
+                    ::WalkDirectoryTreeWorkCallback,
+                    &WalkContext,
+                    nullptr);
+            }
+            if (Work)
+            {
+                for (DWORD i = 0; i < MaximumConcurrency; ++i)
+                {
+                    ::SubmitThreadpoolWork(Work);
+                }
+                ::WaitForThreadpoolWorkCallbacks(Work, FALSE);
+                ::CloseThreadpoolWork(Work);
+            }
+            else
+            {
+                ::WalkDirectoryTreeWorkCallback(
+                    nullptr,
+                    &WalkContext,
+                    nullptr);
+            }
+        }
+
+        for (DWORD i = 0; i < MaximumConcurrency; ++i)
+        {
+            // Release the nodes left by the terminated walk.
+            PWALK_DIRECTORY_TREE_QUEUE Queue = &WalkContext.Queues[i];
+            for (SIZE_T j = 0; j < Queue->Count; ++j)
+            {
+                ::ReleaseWalkDirectoryTreeNode(
+                    Queue->Items[(Queue->Head + j) % Queue->Capacity]);
+            }
+            if (Queue->Items)
+            {
+                ::MileFreeMemory(Queue->Items);
+            }
+        }
+        ::MileFreeMemory(WalkContext.Queues);
+    }
+
+    if (Result && ERROR_SUCCESS != WalkContext.Error)
+    {
+        Result = FALSE;
+        LastError = WalkContext.Error;
+    }
+
+    if (!Result)
+    {
+        ::SetLastError(LastError);
+    }
+
+    return Result;
+}
+
+EXTERN_C BOOL WINAPI MileDeviceIoControl(
+    _In_ HANDLE DeviceHandle,
+    _In_ DWORD IoControlCode,
+    _In_opt_ LPVOID InputBuffer,
+    _In_ DWORD InputBufferSize,
+    _Out_opt_ LPVOID OutputBuffer,
+    _In_ DWORD OutputBufferSize,
+    _Out_opt_ LPDWORD BytesReturned)
+{
+    BOOL Result = FALSE;
+    DWORD LastError = ERROR_SUCCESS;
+    DWORD NumberOfBytesTransferred = 0;
+    OVERLAPPED Overlapped = {};
+    Overlapped.hEvent = ::AcquireOverlappedEvent();
+    if (Overlapped.hEvent)
+    {
+        Result = ::DeviceIoControl(
+            DeviceHandle,
+            IoControlCode,
+            InputBuffer,
+            InputBufferSize,
+            OutputBuffer,
+            OutputBufferSize,
+            &NumberOfBytesTransferred,
+            &Overlapped);
+        if (!Result)
+        {
+            LastError = ::GetLastError();
+
+            // A request that fills the output buffer partially can fail
+            // synchronously with ERROR_MORE_DATA, and the number of bytes
+            // returned is only available from the overlapped result.
+            if (ERROR_IO_PENDING == LastError ||
+                ERROR_MORE_DATA == LastError)
+            {
+                Result = ::GetOverlappedResult(
+                    DeviceHandle,
+                    &Overlapped,
+                    &NumberOfBytesTransferred,
+                    TRUE);
+                if (!Result)
+                {
+                    LastError = ::GetLastError();
+                }
+            }
+        }
+
+        ::ReleaseOverlappedEvent(Overlapped.hEvent);
+    }
+    else
+    {
+        LastError = ERROR_NO_SYSTEM_RESOURCES;
+    }
+
+    if (BytesReturned)
+    {
+        *BytesReturned = NumberOfBytesTransferred;
+    }
+
+    if (!Result)
+    {
+        ::SetLastError(LastError);
+    }
+
+    return Result;
+}
+
+EXTERN_C BOOL WINAPI MileGetFileAttributesByHandle(
+    _In_ HANDLE FileHandle,
+    _Out_ PDWORD FileAttributes)
+{
+    FILE_BASIC_INFO BasicInfo;
+
+    BOOL Result = ::GetFileInformationByHandleEx(
+        FileHandle,
+        FILE_INFO_BY_HANDLE_CLASS::FileBasicInfo,
+        &BasicInfo,
+        sizeof(FILE_BASIC_INFO));
+
+    *FileAttributes = Result
+        ? BasicInfo.FileAttributes
+        : INVALID_FILE_ATTRIBUTES;
+
+    return Result;
+}
+
+EXTERN_C BOOL WINAPI MileSetFileAttributesByHandle(
+    _In_ HANDLE FileHandle,
+    _In_ DWORD FileAttributes)
+{
+    FILE_BASIC_INFO BasicInfo = {};
+    BasicInfo.FileAttributes =
+        FileAttributes & (
+            FILE_SHARE_READ |
+            FILE_SHARE_WRITE |
+            FILE_SHARE_DELETE |
+            FILE_ATTRIBUTE_ARCHIVE |
+            FILE_ATTRIBUTE_TEMPORARY |
+            FILE_ATTRIBUTE_OFFLINE |
+            FILE_ATTRIBUTE_NOT_CONTENT_INDEXED |
+            FILE_ATTRIBUTE_NO_SCRUB_DATA) |
+        FILE_ATTRIBUTE_NORMAL;
+
+    return ::SetFileInformationByHandle(
+        FileHandle,
+        FILE_INFO_BY_HANDLE_CLASS::FileBasicInfo,
+        &BasicInfo,
+        sizeof(FILE_BASIC_INFO));
+}
+
+EXTERN_C BOOL WINAPI MileGetFileHardlinkCountByHandle(
+    _In_ HANDLE FileHandle,
+    _Out_ PDWORD HardlinkCount)
+{
+    FILE_STANDARD_INFO StandardInfo;
+
+    BOOL Result = ::GetFileInformationByHandleEx(
+        FileHandle,
+        FILE_INFO_BY_HANDLE_CLASS::FileStandardInfo,
+        &StandardInfo,
+        sizeof(FILE_STANDARD_INFO));
+
+    *HardlinkCount = Result
+        ? StandardInfo.NumberOfLinks
+        : static_cast<DWORD>(-1);
+
+    return Result;
+}
+
+EXTERN_C BOOL WINAPI MileDeleteFileByHandle(
+    _In_ HANDLE FileHandle)
+{
+    FILE_DISPOSITION_INFO DispostionInfo;
+    DispostionInfo.DeleteFile = TRUE;
+    if (::SetFileInformationByHandle(
+        FileHandle,
+        FILE_INFO_BY_HANDLE_CLASS::FileDispositionInfo,
+        &DispostionInfo,
+        sizeof(FILE_DISPOSITION_INFO)))
+    {
+        return TRUE;
+    }
+
+    FILE_DISPOSITION_INFO_EX DispostionInfoEx;
+    DispostionInfoEx.Flags = FILE_DISPOSITION_FLAG_DELETE;
+    return ::SetFileInformationByHandle(
+        FileHandle,
+        FILE_INFO_BY_HANDLE_CLASS::FileDispositionInfoEx,
+        &DispostionInfoEx,
+        sizeof(FILE_DISPOSITION_INFO_EX));
+}
+
+EXTERN_C BOOL WINAPI MileDeleteFileIgnoreReadonlyAttributeByHandle(
+    _In_ HANDLE FileHandle)
+{
+    BOOL Result = FALSE;
+
+    DWORD OldAttribute = 0;
+    // Save old attributes.
+    if (::MileGetFileAttributesByHandle(FileHandle, &OldAttribute))
+    {
+        // Get hardlink count.
+        DWORD HardlinkCount = 0;
+        if (::MileGetFileHardlinkCountByHandle(FileHandle, &HardlinkCount))
+        {
+            // Remove readonly attribute.
+            if (::MileSetFileAttributesByHandle(
+                FileHandle,
+                OldAttribute & (-1 ^ FILE_ATTRIBUTE_READONLY)))
+            {
+                // Delete the file.
+                Result = ::MileDeleteFileByHandle(FileHandle);
+                if (!Result || HardlinkCount > 1)
+                {
+                    // Restore attributes if failed or had another hard links.
+                    ::MileSetFileAttributesByHandle(FileHandle, OldAttribute);
+                }
+            }
+        }
+    }
+
+    return Result;
+}
+
+EXTERN_C BOOL WINAPI MileGetFileSizeByHandle(
+    _In_ HANDLE FileHandle,
+    _Out_ PULONGLONG FileSize)
+{
+    FILE_STANDARD_INFO StandardInfo;
+
+    BOOL Result = ::GetFileInformationByHandleEx(
+        FileHandle,
+        FILE_INFO_BY_HANDLE_CLASS::FileStandardInfo,
+        &StandardInfo,
+        sizeof(FILE_STANDARD_INFO));
+
+    *FileSize = Result
+        ? static_cast<ULONGLONG>(StandardInfo.EndOfFile.QuadPart)
+        : 0;
+
+    return Result;
+}
+
+EXTERN_C BOOL WINAPI MileGetFileAllocationSizeByHandle(
+    _In_ HANDLE FileHandle,
+    _Out_ PULONGLONG AllocationSize)
+{
+    FILE_STANDARD_INFO StandardInfo;
+
+    BOOL Result = ::GetFileInformationByHandleEx(
+        FileHandle,
+        FILE_INFO_BY_HANDLE_CLASS::FileStandardInfo,
+        &StandardInfo,
+        sizeof(FILE_STANDARD_INFO));
+
+    *AllocationSize = Result
+        ? static_cast<ULONGLONG>(StandardInfo.AllocationSize.QuadPart)
+        : 0;
+
+    return Result;
+}
+
+EXTERN_C BOOL WINAPI MileGetCompressedFileSizeByHandle(
+    _In_ HANDLE FileHandle,
+    _Out_ PULONGLONG CompressedFileSize)
+{
+    FILE_COMPRESSION_INFO FileCompressionInfo;
+
+    if (::GetFileInformationByHandleEx(
+        FileHandle,
+        FILE_INFO_BY_HANDLE_CLASS::FileCompressionInfo,
+        &FileCompressionInfo,
+        sizeof(FILE_COMPRESSION_INFO)))
+    {
+        *CompressedFileSize = static_cast<ULONGLONG>(
+            FileCompressionInfo.CompressedFileSize.QuadPart);
+
+        return TRUE;
+    }
+
+    return ::MileGetFileSizeByHandle(FileHandle, CompressedFileSize);
+}
+
+EXTERN_C BOOL WINAPI MileReadFileAt(
+    _In_ HANDLE FileHandle,
+    _Out_opt_ LPVOID Buffer,
+    _In_ DWORD NumberOfBytesToRead,
+    _In_ ULONGLONG Offset,
+    _Out_opt_ LPDWORD NumberOfBytesRead)
+{
+    BOOL Result = FALSE;
+    DWORD LastError = ERROR_SUCCESS;
+    DWORD NumberOfBytesTransferred = 0;
+    OVERLAPPED Overlapped = {};
+    Overlapped.Offset = static_cast<DWORD>(Offset);
+    Overlapped.OffsetHigh = static_cast<DWORD>(Offset >> 32);
+    Overlapped.hEvent = ::AcquireOverlappedEvent();
+    if (Overlapped.hEvent)
+    {
+        Result = ::ReadFile(
+            FileHandle,
+            Buffer,
+            NumberOfBytesToRead,
+            &NumberOfBytesTransferred,
+            &Overlapped);
+        if (!Result)
+        {
+            LastError = ::GetLastError();
+
+            if (ERROR_IO_PENDING == LastError)
+            {
+                Result = ::GetOverlappedResult(
+                    FileHandle,
+                    &Overlapped,
+                    &NumberOfBytesTransferred,
+                    TRUE);
+                if (!Result)
+                {
+                    LastError = ::GetLastError();
+                }
+            }
+        }
+
+        ::ReleaseOverlappedEvent(Overlapped.hEvent);
+    }
+    else
+    {
+        LastError = ERROR_NO_SYSTEM_RESOURCES;
+    }
+
+    if (NumberOfBytesRead)
+    {
+        *NumberOfBytesRead = NumberOfBytesTransferred;
+    }
+
+    if (!Result)
+    {
+        ::SetLastError(LastError);
+    }
+
+    return Result;
+}
+
+EXTERN_C BOOL WINAPI MileReadFile(
+    _In_ HANDLE FileHandle,
+    _Out_opt_ LPVOID Buffer,
+    _In_ DWORD NumberOfBytesToRead,
+    _Out_opt_ LPDWORD NumberOfBytesRead)
+{
+    bool FilePointerAvailable = false;
+    LARGE_INTEGER CurrentFilePointer = {};
+    {
+        LARGE_INTEGER DistanceToMove = {};
+        if (::SetFilePointerEx(
+            FileHandle,
+            DistanceToMove,
+            &CurrentFilePointer,
+            FILE_CURRENT))
+        {
+            FilePointerAvailable = true;
+        }
+    }
+
+    DWORD NumberOfBytesTransferred = 0;
+    BOOL Result = ::MileReadFileAt(
+        FileHandle,
+        Buffer,
+        NumberOfBytesToRead,
+        static_cast<ULONGLONG>(CurrentFilePointer.QuadPart),
+        &NumberOfBytesTransferred);
+    if (Result && FilePointerAvailable)
+    {
+        CurrentFilePointer.QuadPart += NumberOfBytesTransferred;
+        Result = ::SetFilePointerEx(
+            FileHandle,
+            CurrentFilePointer,
+            nullptr,
+            FILE_BEGIN);
+    }
+
+    if (NumberOfBytesRead)
+    {
+        *NumberOfBytesRead = NumberOfBytesTransferred;
+    }
+
+    return Result;
+}
+
+EXTERN_C BOOL WINAPI MileWriteFileAt(
+    _In_ HANDLE FileHandle,
+    _In_opt_ LPCVOID Buffer,
+    _In_ DWORD NumberOfBytesToWrite,
+    _In_ ULONGLONG Offset,
+    _Out_opt_ LPDWORD NumberOfBytesWritten)
+{
+    BOOL Result = FALSE;
+    DWORD LastError = ERROR_SUCCESS;
+    DWORD NumberOfBytesTransferred = 0;
+    OVERLAPPED Overlapped = {};
+    Overlapped.Offset = static_cast<DWORD>(Offset);
+    Overlapped.OffsetHigh = static_cast<DWORD>(Offset >> 32);
+    Overlapped.hEvent = ::AcquireOverlappedEvent();
+    if (Overlapped.hEvent)
+    {
+        Result = ::WriteFile(
+            FileHandle,
+            Buffer,
+            NumberOfBytesToWrite,
+            &NumberOfBytesTransferred,
+            &Overlapped);
+        if (!Result)
+        {
+            LastError = ::GetLastError();
+
+            if (ERROR_IO_PENDING == LastError)
+            {
+                Result = ::GetOverlappedResult(
+                    FileHandle,
+                    &Overlapped,
+                    &NumberOfBytesTransferred,
+                    TRUE);
+                if (!Result)
+                {
+                    LastError = ::GetLastError();
+                }
+            }
+        }
+
+        ::ReleaseOverlappedEvent(Overlapped.hEvent);
+    }
+    else
+    {
+        LastError = ERROR_NO_SYSTEM_RESOURCES;
+    }
+
+    if (NumberOfBytesWritten)
+    {
+        *NumberOfBytesWritten = NumberOfBytesTransferred;
+    }
+
+    if (!Result)
+    {
+        ::SetLastError(LastError);
+    }
+
+    return Result;
+}
+
+EXTERN_C BOOL WINAPI MileWriteFile(
+    _In_ HANDLE FileHandle,
+    _In_opt_ LPCVOID Buffer,
+    _In_ DWORD NumberOfBytesToWrite,
+    _Out_opt_ LPDWORD NumberOfBytesWritten)
+{
+    bool FilePointerAvailable = false;
+    LARGE_INTEGER CurrentFilePointer = {};
+    {
+        LARGE_INTEGER DistanceToMove = {};
+        if (::SetFilePointerEx(
+            FileHandle,
+            DistanceToMove,
+            &CurrentFilePointer,
+            FILE_CURRENT))
+        {
+            FilePointerAvailable = true;
+        }
+    }
+
+    DWORD NumberOfBytesTransferred = 0;
+    BOOL Result = ::MileWriteFileAt(
+        FileHandle,
+        Buffer,
+        NumberOfBytesToWrite,
+        static_cast<ULONGLONG>(CurrentFilePointer.QuadPart),
+        &NumberOfBytesTransferred);
+    if (Result && FilePointerAvailable)
+    {
+        CurrentFilePointer.QuadPart += NumberOfBytesTransferred;
+        Result = ::SetFilePointerEx(
+            FileHandle,
+            CurrentFilePointer,
+            nullptr,
+            FILE_BEGIN);
+    }
+
+    if (NumberOfBytesWritten)
+    {
+        *NumberOfBytesWritten = NumberOfBytesTransferred;
+    }
+
+    return Result;
+}
+
+EXTERN_C BOOL WINAPI MileReadFileScatter(
+    _In_ HANDLE FileHandle,
+    _In_ FILE_SEGMENT_ELEMENT SegmentArray[],
+    _In_ DWORD NumberOfBytesToRead,
+    _In_ ULONGLONG Offset,
+    _Out_opt_ LPDWORD NumberOfBytesRead)
+{
+    BOOL Result = FALSE;
+    DWORD LastError = ERROR_SUCCESS;
+    DWORD NumberOfBytesTransferred = 0;
+    OVERLAPPED Overlapped = {};
+    Overlapped.Offset = static_cast<DWORD>(Offset);
+    Overlapped.OffsetHigh = static_cast<DWORD>(Offset >> 32);
+    Overlapped.hEvent = ::AcquireOverlappedEvent();
+    if (Overlapped.hEvent)
+    {
+        Result = ::ReadFileScatter(
+            FileHandle,
+            SegmentArray,
+            NumberOfBytesToRead,
+            nullptr,
+            &Overlapped);
+        if (!Result)
+        {
+            LastError = ::GetLastError();
+
+            if (ERROR_IO_PENDING == LastError)
+            {
+                Result = ::GetOverlappedResult(
+                    FileHandle,
+                    &Overlapped,
+                    &NumberOfBytesTransferred,
+                    TRUE);
+                if (!Result)
+                {
+                    LastError = ::GetLastError();
+                }
+            }
+        }
+        else
+        {
+            Result = ::GetOverlappedResult(
+                FileHandle,
+                &Overlapped,
+                &NumberOfBytesTransferred,
+                FALSE);
+            if (!Result)
+            {
+                LastError = ::GetLastError();
+            }
+        }
+
+        ::ReleaseOverlappedEvent(Overlapped.hEvent);
+    }
+    else
+    {
+        LastError = ERROR_NO_SYSTEM_RESOURCES;
+    }
+
+    if (NumberOfBytesRead)
+    {
+        *NumberOfBytesRead = NumberOfBytesTransferred;
+    }
+
+    if (!Result)
+    {
+        ::SetLastError(LastError);
+    }
+
+    return Result;
+}
+
+EXTERN_C BOOL WINAPI MileWriteFileGather(
+    _In_ HANDLE FileHandle,
+    _In_ FILE_SEGMENT_ELEMENT SegmentArray[],
+    _In_ DWORD NumberOfBytesToWrite,
+    _In_ ULONGLONG Offset,
+    _Out_opt_ LPDWORD NumberOfBytesWritten)
+{
+    BOOL Result = FALSE;
+    DWORD LastError = ERROR_SUCCESS;
+    DWORD NumberOfBytesTransferred = 0;
+    OVERLAPPED Overlapped = {};
+    Overlapped.Offset = static_cast<DWORD>(Offset);
+    Overlapped.OffsetHigh = static_cast<DWORD>(Offset >> 32);
+    Overlapped.hEvent = ::AcquireOverlappedEvent();
+    if (Overlapped.hEvent)
+    {
+        Result = ::WriteFileGather(
+            FileHandle,
+            SegmentArray,
+            NumberOfBytesToWrite,
+            nullptr,
+            &Overlapped);
+        if (!Result)
+        {
+            LastError = ::GetLastError();
+
+            if (ERROR_IO_PENDING == LastError)
+            {
+                Result = ::GetOverlappedResult(
+                    FileHandle,
+                    &Overlapped,
+                    &NumberOfBytesTransferred,
+                    TRUE);
+                if (!Result)
+                {
+                    LastError = ::GetLastError();
+                }
+            }
+        }
+        else
+        {
+            Result = ::GetOverlappedResult(
+                FileHandle,
+                &Overlapped,
+                &NumberOfBytesTransferred,
+                FALSE);
+            if (!Result)
+            {
+                LastError = ::GetLastError();
+            }
+        }
+
+        ::ReleaseOverlappedEvent(Overlapped.hEvent);
+    }
+    else
+    {
+        LastError = ERROR_NO_SYSTEM_RESOURCES;
+    }
+
+    if (NumberOfBytesWritten)
+    {
+        *NumberOfBytesWritten = NumberOfBytesTransferred;
+    }
+
+    if (!Result)
+    {
+        ::SetLastError(LastError);
+    }
+
+    return Result;
+}
+
+namespace
+{
+    typedef struct _FILE_TRANSFER_REQUEST
+    {
+        OVERLAPPED Overlapped;
+        ULONGLONG Position;
+        DWORD Length;
+    } FILE_TRANSFER_REQUEST, *PFILE_TRANSFER_REQUEST;
+
+    static BOOL IssueFileTransferRequest(
+        _In_ HANDLE FileHandle,
+        _In_ bool IsWrite,
+        _In_ LPBYTE Buffer,
+        _In_ ULONGLONG Offset,
+        _In_ PFILE_TRANSFER_REQUEST Request)
+    {
+        ULONGLONG FileOffset = Offset + Request->Position;
+        Request->Overlapped.Internal = 0;
+        Request->Overlapped.InternalHigh = 0;
+        Request->Overlapped.Offset = static_cast<DWORD>(FileOffset);
+        Request->Overlapped.OffsetHigh = static_cast<DWORD>(FileOffset >> 32);
+
+        BOOL Result = IsWrite
+            ? ::WriteFile(
+                FileHandle,
+                Buffer + Request->Position,
+                Request->Length,
+                nullptr,
+                &Request->Overlapped)
+            : ::ReadFile(
+                FileHandle,
+                Buffer + Request->Position,
+                Request->Length,
+                nullptr,
+                &Request->Overlapped);
+        if (!Result && ERROR_IO_PENDING == ::GetLastError())
+        {
+            Result = TRUE;
+        }
+
+        return Result;
+    }
+
+    static BOOL TransferFileFull(
+        _In_ HANDLE FileHandle,
+        _In_ bool IsWrite,
+        _In_ LPBYTE Buffer,
+        _In_ ULONGLONG NumberOfBytesToTransfer,
+        _In_ ULONGLONG Offset,
+        _In_ DWORD ChunkSize,
+        _In_ DWORD MaximumOutstandingRequests,
+        _Out_opt_ PULONGLONG NumberOfBytesTransferred,
+        _In_opt_ MILE_FILE_TRANSFER_PROGRESS_CALLBACK_TYPE ProgressCallback,
+        _In_opt_ LPVOID Context)
+    {
+        if (NumberOfBytesTransferred)
+        {
+            *NumberOfBytesTransferred = 0;
+        }
+
+        if (!Buffer && NumberOfBytesToTransfer)
+        {
+            ::SetLastError(ERROR_INVALID_PARAMETER);
+            return FALSE;
+        }
+
+        if (!ChunkSize)
+        {
+            ChunkSize = 1024 * 1024;
+        }
+        if (!MaximumOutstandingRequests)
+        {
+            MaximumOutstandingRequests = 4;
+        }
+
+        // The requests are completed one by one in the order of issue, so
+        // the depth is not limited by the wait functions. Only the requests
+        // which can be used by the chunks of the range are allocated.
+        ULONGLONG NumberOfChunks = NumberOfBytesToTransfer / ChunkSize;
+        if (NumberOfBytesToTransfer % ChunkSize)
+        {
+            ++NumberOfChunks;
+        }
+        if (NumberOfChunks < MaximumOutstandingRequests)
+        {
+            MaximumOutstandingRequests = NumberOfChunks
+                ? static_cast<DWORD>(NumberOfChunks)
+                : 1;
+        }
+
+        PFILE_TRANSFER_REQUEST Requests =
+            reinterpret_cast<PFILE_TRANSFER_REQUEST>(::MileAllocateMemory(
+                sizeof(FILE_TRANSFER_REQUEST) * MaximumOutstandingRequests));
+        if (!Requests)
+        {
+            ::SetLastError(ERROR_OUTOFMEMORY);
+            return FALSE;
+        }
+
+        DWORD LastError = ERROR_SUCCESS;
+
+        DWORD NumberOfEvents = 0;
+        for (; NumberOfEvents < MaximumOutstandingRequests; ++NumberOfEvents)
+        {
+            HANDLE Event = ::AcquireOverlappedEvent();
+            if (!Event)
+            {
+                LastError = ERROR_NO_SYSTEM_RESOURCES;
+                break;
+            }
+            Requests[NumberOfEvents].Overlapped.hEvent = Event;
+        }
+
+        // The requests are used as a ring and completed in the order of
+        // issue, so the completed bytes are always a contiguous prefix.
+        ULONGLONG NextPosition = 0;
+        ULONGLONG CompletedBytes = 0;
+        DWORD Head = 0;
+        DWORD Outstanding = 0;
+        bool EndOfFile = false;
+
+        while (ERROR_SUCCESS == LastError)
+        {
+            while (!EndOfFile
+                && Outstanding < MaximumOutstandingRequests
+                && NextPosition < NumberOfBytesToTransfer)
+            {
+                PFILE_TRANSFER_REQUEST Request = &Requests[
+                    (Head + Outstanding) % MaximumOutstandingRequests];
+                ULONGLONG RemainingBytes = NumberOfBytesToTransfer - NextPosition;
+                Request->Position = NextPosition;
+                Request->Length = RemainingBytes < ChunkSize
+                    ? static_cast<DWORD>(RemainingBytes)
+                    : ChunkSize;
+                if (!::IssueFileTransferRequest(
+                    FileHandle,
+                    IsWrite,
+                    Buffer,
+                    Offset,
+                    Request))
+                {
+                    LastError = ::GetLastError();
+                    if (!IsWrite && ERROR_HANDLE_EOF == LastError)
+                    {
+                        LastError = ERROR_SUCCESS;
+                        EndOfFile = true;
+                    }
+                    break;
+                }
+                NextPosition += Request->Length;
+                ++Outstanding;
+            }
+
+            if (ERROR_SUCCESS != LastError || !Outstanding)
+            {
+                break;
+            }
+
+            PFILE_TRANSFER_REQUEST Request = &Requests[Head];
+            DWORD RequestBytes = 0;
+            if (!::GetOverlappedResult(
+                FileHandle,
+                &Request->Overlapped,
+                &RequestBytes,
+                TRUE))
+            {
+                LastError = ::GetLastError();
+                if (!IsWrite && ERROR_HANDLE_EOF == LastError)
+                {
+                    LastError = ERROR_SUCCESS;
+                    RequestBytes = 0;
+                }
+            }
+            Head = (Head + 1) % MaximumOutstandingRequests;
+            --Outstanding;
+
+            if (ERROR_SUCCESS != LastError)
+            {
+                break;
+            }
+
+            if (EndOfFile)
+            {
+                // Requests issued behind a short read are discarded.
+                continue;
+            }
+
+            if (IsWrite)
+            {
+                // Reissue the remainder of a partial write in place.
+                while (RequestBytes < Request->Length)
+                {
+                    Request->Position += RequestBytes;
+                    Request->Length -= RequestBytes;
+                    CompletedBytes += RequestBytes;
+                    RequestBytes = 0;
+                    if (!::IssueFileTransferRequest(
+                        FileHandle,
+                        IsWrite,
+                        Buffer,
+                        Offset,
+                        Request)
+                        || !::GetOverlappedResult(
+                            FileHandle,
+                            &Request->Overlapped,
+                            &RequestBytes,
+                            TRUE))
+                    {
+                        LastError = ::GetLastError();
+                        break;
+                    }
+                    if (!RequestBytes)
+                    {
+                        LastError = ERROR_WRITE_FAULT;
+                        break;
+                    }
+                }
+                if (ERROR_SUCCESS != LastError)
+                {
+                    break;
+                }
+            }
+            else if (RequestBytes < Request->Length)
+            {
+                EndOfFile = true;
+            }
+
+            CompletedBytes += RequestBytes;
+
+            if (ProgressCallback && !ProgressCallback(
+                CompletedBytes,
+                NumberOfBytesToTransfer,
+                Context))
+            {
+                LastError = ERROR_CANCELLED;
+                break;
+            }
+        }
+
+        // Cancel and drain the requests which are still in flight, because
+        // their buffers and OVERLAPPED structures are about to be released.
+        for (DWORD i = 0; i < Outstanding; ++i)
+        {
+            PFILE_TRANSFER_REQUEST Request = &Requests[
+                (Head + i) % MaximumOutstandingRequests];
+            ::CancelIoEx(FileHandle, &Request->Overlapped);
+        }
+        for (DWORD i = 0; i < Outstanding; ++i)
+        {
+            PFILE_TRANSFER_REQUEST Request = &Requests[
+                (Head + i) % MaximumOutstandingRequests];
+            DWORD RequestBytes = 0;
+            ::GetOverlappedResult(
+                FileHandle,
+                &Request->Overlapped,
+                &RequestBytes,
+                TRUE);
+        }
+
+        for (DWORD i = 0; i < NumberOfEvents; ++i)
+        {
+            ::ReleaseOverlappedEvent(Requests[i].Overlapped.hEvent);
+        }
+        ::MileFreeMemory(Requests);
+
+        if (NumberOfBytesTransferred)
+        {
+            *NumberOfBytesTransferred = CompletedBytes;
+        }
+
+        if (ERROR_SUCCESS != LastError)
+        {
+            ::SetLastError(LastError);
+            return FALSE;
+        }
+
+        return TRUE;
+    }
+}
+
+EXTERN_C BOOL WINAPI MileReadFileFull(
+    _In_ HANDLE FileHandle,
+    _Out_opt_ LPVOID Buffer,
+    _In_ ULONGLONG NumberOfBytesToRead,
+    _In_ ULONGLONG Offset,
+    _In_ DWORD ChunkSize,
+    _In_ DWORD MaximumOutstandingRequests,
+    _Out_opt_ PULONGLONG NumberOfBytesRead,
+    _In_opt_ MILE_FILE_TRANSFER_PROGRESS_CALLBACK_TYPE ProgressCallback,
+    _In_opt_ LPVOID Context)
+{
+    return ::TransferFileFull(
+        FileHandle,
+        false,
+        reinterpret_cast<LPBYTE>(Buffer),
+        NumberOfBytesToRead,
+        Offset,
+        ChunkSize,
+        MaximumOutstandingRequests,
+        NumberOfBytesRead,
+        ProgressCallback,
+        Context);
+}
+
+EXTERN_C BOOL WINAPI MileWriteFileFull(
+    _In_ HANDLE FileHandle,
+    _In_opt_ LPCVOID Buffer,
+    _In_ ULONGLONG NumberOfBytesToWrite,
+    _In_ ULONGLONG Offset,
+    _In_ DWORD ChunkSize,
+    _In_ DWORD MaximumOutstandingRequests,
+    _Out_opt_ PULONGLONG NumberOfBytesWritten,
+    _In_opt_ MILE_FILE_TRANSFER_PROGRESS_CALLBACK_TYPE ProgressCallback,
+    _In_opt_ LPVOID Context)
+{
+    return ::TransferFileFull(
+        FileHandle,
+        true,
+        const_cast<LPBYTE>(reinterpret_cast<const BYTE*>(Buffer)),
+        NumberOfBytesToWrite,
+        Offset,
+        ChunkSize,
+        MaximumOutstandingRequests,
+        NumberOfBytesWritten,
+        ProgressCallback,
+        Context);
+}
+
+namespace
+{
+    static DWORD GetAllocationGranularity()
+    {
+        static DWORD CachedResult = ([]() -> DWORD
+        {
+            SYSTEM_INFO SystemInfo;
+            ::GetSystemInfo(&SystemInfo);
+            return SystemInfo.dwAllocationGranularity;
+        }());
+
+        return CachedResult;
+    }
+
+    static FARPROC GetPrefetchVirtualMemoryProcAddress()
+    {
+        static FARPROC CachedResult = ([]() -> FARPROC
+        {
+            HMODULE ModuleHandle = ::GetModuleHandleW(L"kernel32.dll");
+            if (ModuleHandle)
+            {
+                return ::GetProcAddress(
+                    ModuleHandle,
+                    "PrefetchVirtualMemory");
+            }
+            return nullptr;
+        }());
+
+        return CachedResult;
+    }
+
+    static BOOL WINAPI PrefetchVirtualMemoryWrapper(
+        _In_ HANDLE hProcess,
+        _In_ ULONG_PTR NumberOfEntries,
+        _In_ PWIN32_MEMORY_RANGE_ENTRY VirtualAddresses,
+        _In_ ULONG Flags)
+    {
+        using ProcType = decltype(::PrefetchVirtualMemoryWrapper)*;
+
+        ProcType ProcAddress = reinterpret_cast<ProcType>(
+            ::GetPrefetchVirtualMemoryProcAddress());
+
+        if (ProcAddress)
+        {
+            return ProcAddress(
+                hProcess,
+                NumberOfEntries,
+                VirtualAddresses,
+                Flags);
+        }
+
+        ::SetLastError(ERROR_CALL_NOT_IMPLEMENTED);
+        return FALSE;
+    }
+}
+
+EXTERN_C BOOL WINAPI MileMapFile(
+    _In_ HANDLE FileHandle,
+    _In_ MILE_FILE_MAPPING_ACCESS Access,
+    _Out_ PMILE_FILE_MAPPING Mapping)
+{
+    if (!Mapping)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+    Mapping->MappingHandle = nullptr;
+    Mapping->Access = Access;
+    Mapping->FileSize = 0;
+
+    DWORD Protect = 0;
+    switch (Access)
+    {
+    case MILE_FILE_MAPPING_ACCESS_READ_ONLY:
+        Protect = PAGE_READONLY;
+        break;
+    case MILE_FILE_MAPPING_ACCESS_READ_WRITE:
+        Protect = PAGE_READWRITE;
+        break;
+    case MILE_FILE_MAPPING_ACCESS_COPY_ON_WRITE:
+        Protect = PAGE_WRITECOPY;
+        break;
+    default:
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if (!::MileGetFileSizeByHandle(FileHandle, &Mapping->FileSize))
+    {
+        return FALSE;
+    }
+
+    Mapping->MappingHandle = ::CreateFileMappingW(
+        FileHandle,
+        nullptr,
+        Protect,
+        0,
+        0,
+        nullptr);
+    return Mapping->MappingHandle ? TRUE : FALSE;
+}
+
+EXTERN_C BOOL WINAPI MileUnmapFile(
+    _Inout_ PMILE_FILE_MAPPING Mapping)
+{
+    if (!Mapping || !Mapping->MappingHandle)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    BOOL Result = ::CloseHandle(Mapping->MappingHandle);
+    Mapping->MappingHandle = nullptr;
+    return Result;
+}
+
+EXTERN_C BOOL WINAPI MileMapView(
+    _In_ PMILE_FILE_MAPPING Mapping,
+    _In_ ULONGLONG Offset,
+    _In_ SIZE_T Size,
+    _Out_ PMILE_FILE_VIEW View)
+{
+    if (!View)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+    View->Mapping = Mapping;
+    View->BaseAddress = nullptr;
+    View->MappedSize = 0;
+    View->Offset = 0;
+    View->Address = nullptr;
+    View->Size = 0;
+
+    if (!Mapping || !Mapping->MappingHandle || Offset >= Mapping->FileSize)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    ULONGLONG RemainingSize = Mapping->FileSize - Offset;
+    if (!Size)
+    {
+        if (RemainingSize > static_cast<SIZE_T>(-1))
+        {
+            ::SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+            return FALSE;
+        }
+        Size = static_cast<SIZE_T>(RemainingSize);
+    }
+    else if (Size > RemainingSize)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    ULONGLONG Granularity = ::GetAllocationGranularity();
+    ULONGLONG MappedOffset = Offset - (Offset % Granularity);
+    SIZE_T Delta = static_cast<SIZE_T>(Offset - MappedOffset);
+    if (Size > static_cast<SIZE_T>(-1) - Delta)
+    {
+        ::SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return FALSE;
+    }
+
+    DWORD DesiredAccess = 0;
+    switch (Mapping->Access)
+    {
+    case MILE_FILE_MAPPING_ACCESS_READ_WRITE:
+        DesiredAccess = FILE_MAP_READ | FILE_MAP_WRITE;
+        break;
+    case MILE_FILE_MAPPING_ACCESS_COPY_ON_WRITE:
+        DesiredAccess = FILE_MAP_COPY;
+        break;
+    default:
+        DesiredAccess = FILE_MAP_READ;
+        break;
+    }
+
+    LPVOID BaseAddress = ::MapViewOfFile(
+        Mapping->MappingHandle,
+        DesiredAccess,
+        static_cast<DWORD>(MappedOffset >> 32),
+        static_cast<DWORD>(MappedOffset),
+        Delta + Size);
+    if (!BaseAddress)
+    {
+        return FALSE;
+    }
+
+    View->BaseAddress = BaseAddress;
+    View->MappedSize = Delta + Size;
+    View->Offset = Offset;
+    View->Address = reinterpret_cast<LPBYTE>(BaseAddress) + Delta;
+    View->Size = Size;
+
+    return TRUE;
+}
+
+EXTERN_C BOOL WINAPI MileUnmapView(
+    _Inout_ PMILE_FILE_VIEW View)
+{
+    if (!View || !View->BaseAddress)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    BOOL Result = ::UnmapViewOfFile(View->BaseAddress);
+    View->BaseAddress = nullptr;
+    View->MappedSize = 0;
+    View->Address = nullptr;
+    View->Size = 0;
+    return Result;
+}
+
+EXTERN_C BOOL WINAPI MileSlideView(
+    _Inout_ PMILE_FILE_VIEW View,
+    _In_ ULONGLONG Offset,
+    _In_ SIZE_T Size)
+{
+    if (!View || !View->Mapping)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if (View->BaseAddress && Size)
+    {
+        ULONGLONG MappedOffset = View->Offset - static_cast<SIZE_T>(
+            reinterpret_cast<LPBYTE>(View->Address) -
+            reinterpret_cast<LPBYTE>(View->BaseAddress));
+        if (Offset >= MappedOffset
+            && Offset - MappedOffset <= View->MappedSize
+            && Size <= View->MappedSize - (Offset - MappedOffset))
+        {
+            View->Offset = Offset;
+            View->Address = reinterpret_cast<LPBYTE>(View->BaseAddress)
+                + static_cast<SIZE_T>(Offset - MappedOffset);
+            View->Size = Size;
+            return TRUE;
+        }
+    }
+
+    if (View->BaseAddress)
+    {
+        ::MileUnmapView(View);
+    }
+
+    return ::MileMapView(View->Mapping, Offset, Size, View);
+}
+
+EXTERN_C BOOL WINAPI MilePrefetchView(
+    _In_ PMILE_FILE_VIEW View,
+    _In_ SIZE_T Offset,
+    _In_ SIZE_T Size)
+{
+    if (!View || !View->Address || Offset >= View->Size)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if (!Size || Size > View->Size - Offset)
+    {
+        Size = View->Size - Offset;
+    }
+
+    WIN32_MEMORY_RANGE_ENTRY Range;
+    Range.VirtualAddress = reinterpret_cast<LPBYTE>(View->Address) + Offset;
+    Range.NumberOfBytes = Size;
+    return ::PrefetchVirtualMemoryWrapper(
+        ::GetCurrentProcess(),
+        1,
+        &Range,
+        0);
+}
+
+EXTERN_C BOOL WINAPI MileFlushView(
+    _In_ PMILE_FILE_VIEW View)
+{
+    if (!View || !View->Address)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    return ::FlushViewOfFile(View->Address, View->Size);
+}
+
+EXTERN_C BOOL WINAPI MileGetFileSectorSize(
+    _In_ HANDLE FileHandle,
+    _Out_ PDWORD SectorSize)
+{
+    if (!SectorSize)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    *SectorSize = 4096;
+
+    FILE_STORAGE_INFO StorageInfo;
+    if (::GetFileInformationByHandleEx(
+        FileHandle,
+        FileStorageInfo,
+        &StorageInfo,
+        sizeof(FILE_STORAGE_INFO)))
+    {
+        DWORD Candidate = StorageInfo.PhysicalBytesPerSectorForPerformance;
+        if (!Candidate)
+        {
+            Candidate = StorageInfo.LogicalBytesPerSector;
+        }
+        // Only accept the power of two values.
+        if (Candidate && !(Candidate & (Candidate - 1)))
+        {
+            *SectorSize = Candidate;
+        }
+    }
+
+    return TRUE;
+}
+
+namespace
+{
+    const DWORD MaximumUnbufferedBounceSize = 1024 * 1024;
+
+    static LPBYTE AllocateUnbufferedBounceBuffer(
+        _In_ DWORD RemainingSize,
+        _In_ DWORD SectorSize,
+        _Out_ PDWORD BounceSize)
+    {
+        DWORD Size = RemainingSize < MaximumUnbufferedBounceSize
+            ? RemainingSize
+            : MaximumUnbufferedBounceSize;
+        // Round up and reserve one more sector for the unaligned head.
+        Size = ((Size + SectorSize - 1) & ~(SectorSize - 1)) + SectorSize;
+        *BounceSize = Size;
+        return reinterpret_cast<LPBYTE>(::MileAllocateAlignedMemory(Size));
+    }
+
+    static BOOL ReadFileUnbufferedChunk(
+        _In_ HANDLE FileHandle,
+        _Out_ LPVOID Buffer,
+        _In_ DWORD NumberOfBytesToRead,
+        _In_ ULONGLONG Offset,
+        _Out_ LPDWORD NumberOfBytesRead)
+    {
+        if (!::MileReadFileAt(
+            FileHandle,
+            Buffer,
+            NumberOfBytesToRead,
+            Offset,
+            NumberOfBytesRead))
+        {
+            if (ERROR_HANDLE_EOF != ::GetLastError())
+            {
+                return FALSE;
+            }
+            *NumberOfBytesRead = 0;
+        }
+
+        return TRUE;
+    }
+
+    // Reads the existing content of a sector which is partially overwritten,
+    // and the content beyond the end of the file is zero.
+    static BOOL ReadFileUnbufferedPartialSector(
+        _In_ HANDLE FileHandle,
+        _In_ ULONGLONG FileSize,
+        _Out_ LPBYTE Sector,
+        _In_ DWORD SectorSize,
+        _In_ ULONGLONG Offset)
+    {
+        DWORD SectorRead = 0;
+        if (Offset < FileSize)
+        {
+            if (!::ReadFileUnbufferedChunk(
+                FileHandle,
+                Sector,
+                SectorSize,
+                Offset,
+                &SectorRead))
+            {
+                return FALSE;
+            }
+        }
+        std::memset(Sector + SectorRead, 0, SectorSize - SectorRead);
+
+        return TRUE;
+    }
+}
+
+EXTERN_C BOOL WINAPI MileReadFileUnbufferedAt(
+    _In_ HANDLE FileHandle,
+    _Out_opt_ LPVOID Buffer,
+    _In_ DWORD NumberOfBytesToRead,
+    _In_ ULONGLONG Offset,
+    _Out_opt_ LPDWORD NumberOfBytesRead)
+{
+    if (NumberOfBytesRead)
+    {
+        *NumberOfBytesRead = 0;
+    }
+
+    if (!Buffer && NumberOfBytesToRead)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    DWORD SectorSize = 0;
+    if (!::MileGetFileSectorSize(FileHandle, &SectorSize))
+    {
+        return FALSE;
+    }
+    const ULONGLONG SectorMask = SectorSize - 1;
+
+    LPBYTE Output = reinterpret_cast<LPBYTE>(Buffer);
+    DWORD Completed = 0;
+    bool EndOfFile = false;
+
+    if (!(Offset & SectorMask)
+        && !(reinterpret_cast<ULONG_PTR>(Output) & SectorMask))
+    {
+        DWORD DirectSize = NumberOfBytesToRead & ~static_cast<DWORD>(SectorMask);
+        if (DirectSize)
+        {
+            if (!::ReadFileUnbufferedChunk(
+                FileHandle,
+                Output,
+                DirectSize,
+                Offset,
+                &Completed))
+            {
+                return FALSE;
+            }
+            EndOfFile = (Completed < DirectSize);
+        }
+    }
+
+    if (!EndOfFile && Completed < NumberOfBytesToRead)
+    {
+        DWORD BounceSize = 0;
+        LPBYTE Bounce = ::AllocateUnbufferedBounceBuffer(
+            NumberOfBytesToRead - Completed,
+            SectorSize,
+            &BounceSize);
+        if (!Bounce)
+        {
+            ::SetLastError(ERROR_OUTOFMEMORY);
+            return FALSE;
+        }
+
+        BOOL Result = TRUE;
+        DWORD LastError = ERROR_SUCCESS;
+        while (Completed < NumberOfBytesToRead)
+        {
+            ULONGLONG Position = Offset + Completed;
+            ULONGLONG AlignedPosition = Position & ~SectorMask;
+            DWORD Skip = static_cast<DWORD>(Position - AlignedPosition);
+            DWORD Required = NumberOfBytesToRead - Completed;
+            if (Required > BounceSize - Skip)
+            {
+                Required = BounceSize - Skip;
+            }
+            DWORD AlignedSize = static_cast<DWORD>(
+                (Skip + Required + SectorMask) & ~SectorMask);
+
+            DWORD ChunkRead = 0;
+            if (!::ReadFileUnbufferedChunk(
+                FileHandle,
+                Bounce,
+                AlignedSize,
+                AlignedPosition,
+                &ChunkRead))
+            {
+                Result = FALSE;
+                LastError = ::GetLastError();
+                break;
+            }
+            if (ChunkRead <= Skip)
+            {
+                break;
+            }
+
+            DWORD Available = ChunkRead - Skip;
+            if (Available > Required)
+            {
+                Available = Required;
+            }
+            std::memcpy(Output + Completed, Bounce + Skip, Available);
+            Completed += Available;
+
+            if (Available < Required)
+            {
+                break;
+            }
+        }
+
+        ::MileFreeAlignedMemory(Bounce);
+
+        if (!Result)
+        {
+            if (NumberOfBytesRead)
+            {
+                *NumberOfBytesRead = Completed;
+            }
+            ::SetLastError(LastError);
+            return FALSE;
+        }
+    }
+
+    if (NumberOfBytesRead)
+    {
+        *NumberOfBytesRead = Completed;
+    }
+
+    return TRUE;
+}
+
+EXTERN_C BOOL WINAPI MileWriteFileUnbufferedAt(
+    _In_ HANDLE FileHandle,
+    _In_opt_ LPCVOID Buffer,
+    _In_ DWORD NumberOfBytesToWrite,
+    _In_ ULONGLONG Offset,
+    _Out_opt_ LPDWORD NumberOfBytesWritten)
+{
+    if (NumberOfBytesWritten)
+    {
+        *NumberOfBytesWritten = 0;
+    }
+
+    if (!Buffer && NumberOfBytesToWrite)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    DWORD SectorSize = 0;
+    if (!::MileGetFileSectorSize(FileHandle, &SectorSize))
+    {
+        return FALSE;
+    }
+    const ULONGLONG SectorMask = SectorSize - 1;
+
+    const BYTE* Input = reinterpret_cast<const BYTE*>(Buffer);
+    DWORD Completed = 0;
+
+    if (!(Offset & SectorMask)
+        && !(reinterpret_cast<ULONG_PTR>(Input) & SectorMask))
+    {
+        DWORD DirectSize = NumberOfBytesToWrite & ~static_cast<DWORD>(SectorMask);
+        if (DirectSize)
+        {
+            if (!::MileWriteFileAt(
+                FileHandle,
+                Input,
+                DirectSize,
+                Offset,
+                &Completed))
+            {
+                if (NumberOfBytesWritten)
+                {
+                    *NumberOfBytesWritten = Completed;
+                }
+                return FALSE;
+            }
+        }
+    }
+
+    if (Completed < NumberOfBytesToWrite)
+    {
+        ULONGLONG FileSize = 0;
+        if (!::MileGetFileSizeByHandle(FileHandle, &FileSize))
+        {
+            if (NumberOfBytesWritten)
+            {
+                *NumberOfBytesWritten = Completed;
+            }
+            return FALSE;
+        }
+
+        DWORD BounceSize = 0;
+        LPBYTE Bounce = ::AllocateUnbufferedBounceBuffer(
+            NumberOfBytesToWrite - Completed,
+            SectorSize,
+            &BounceSize);
+        if (!Bounce)
+        {
+            if (NumberOfBytesWritten)
+            {
+                *NumberOfBytesWritten = Completed;
+            }
+            ::SetLastError(ERROR_OUTOFMEMORY);
+            return FALSE;
+        }
+
+        BOOL Result = TRUE;
+        DWORD LastError = ERROR_SUCCESS;
+        ULONGLONG PaddedEnd = 0;
+        while (Completed < NumberOfBytesToWrite)
+        {
+            ULONGLONG Position = Offset + Completed;
+            ULONGLONG AlignedPosition = Position & ~SectorMask;
+            DWORD Skip = static_cast<DWORD>(Position - AlignedPosition);
+            DWORD Required = NumberOfBytesToWrite - Completed;
+            if (Required > BounceSize - Skip)
+            {
+                Required = BounceSize - Skip;
+            }
+            DWORD AlignedSize = static_cast<DWORD>(
+                (Skip + Required + SectorMask) & ~SectorMask);
+
+            // Only the partially overwritten head and tail sectors are
+            // merged with the existing content, and the rest of the chunk is
+            // copied from the caller buffer.
+            DWORD TailStart = AlignedSize - SectorSize;
+            if (Skip && !::ReadFileUnbufferedPartialSector(
+                FileHandle,
+                FileSize,
+                Bounce,
+                SectorSize,
+                AlignedPosition))
+            {
+                Result = FALSE;
+                LastError = ::GetLastError();
+                break;
+            }
+            if (((Skip + Required) & SectorMask) &&
+                (!Skip || TailStart) &&
+                !::ReadFileUnbufferedPartialSector(
+                    FileHandle,
+                    FileSize,
+                    Bounce + TailStart,
+                    SectorSize,
+                    AlignedPosition + TailStart))
+            {
+                Result = FALSE;
+                LastError = ::GetLastError();
+                break;
+            }
+            std::memcpy(Bounce + Skip, Input + Completed, Required);
+
+            DWORD ChunkWritten = 0;
+            if (!::MileWriteFileAt(
+                FileHandle,
+                Bounce,
+                AlignedSize,
+                AlignedPosition,
+                &ChunkWritten))
+            {
+                Result = FALSE;
+                LastError = ::GetLastError();
+                break;
+            }
+
+            Completed += Required;
+            PaddedEnd = AlignedPosition + AlignedSize;
+        }
+
+        ::MileFreeAlignedMemory(Bounce);
+
+        if (Result)
+        {
+            // Trim the padding of the last sector beyond the requested range.
+            ULONGLONG ExpectedEnd = Offset + NumberOfBytesToWrite;
+            if (ExpectedEnd < FileSize)
+            {
+                ExpectedEnd = FileSize;
+            }
+            if (PaddedEnd > ExpectedEnd)
+            {
+                FILE_END_OF_FILE_INFO EndOfFileInfo;
+                EndOfFileInfo.EndOfFile.QuadPart =
+                    static_cast<LONGLONG>(ExpectedEnd);
+                if (!::SetFileInformationByHandle(
+                    FileHandle,
+                    FileEndOfFileInfo,
+                    &EndOfFileInfo,
+                    sizeof(FILE_END_OF_FILE_INFO)))
+                {
+                    Result = FALSE;
+                    LastError = ::GetLastError();
+                }
+            }
+        }
+
+        if (!Result)
+        {
+            if (NumberOfBytesWritten)
+            {
+                *NumberOfBytesWritten = Completed;
+            }
+            ::SetLastError(LastError);
+            return FALSE;
+        }
+    }
+
+    if (NumberOfBytesWritten)
+    {
+        *NumberOfBytesWritten = Completed;
+    }
+
+    return TRUE;
+}
+
+EXTERN_C BOOL WINAPI MileWriteFileSparseAt(
+    _In_ HANDLE FileHandle,
+    _In_ LPCVOID Buffer,
+    _In_ DWORD NumberOfBytesToWrite,
+    _In_ ULONGLONG Offset,
+    _In_ DWORD BlockSize,
+    _Out_opt_ LPDWORD NumberOfBytesWritten,
+    _Out_opt_ LPDWORD NumberOfBytesSkipped)
+{
+    if (NumberOfBytesWritten)
+    {
+        *NumberOfBytesWritten = 0;
+    }
+    if (NumberOfBytesSkipped)
+    {
+        *NumberOfBytesSkipped = 0;
+    }
+
+    if (!Buffer && NumberOfBytesToWrite)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if (!BlockSize)
+    {
+        BlockSize = 64 * 1024;
+    }
+
+    ULONGLONG FileSize = 0;
+    if (!::MileGetFileSizeByHandle(FileHandle, &FileSize))
+    {
+        return FALSE;
+    }
+
+    const BYTE* Input = reinterpret_cast<const BYTE*>(Buffer);
+    DWORD Processed = 0;
+    DWORD Skipped = 0;
+    bool ZeroDataSupported = true;
+    BOOL Result = TRUE;
+
+    while (Result && Processed < NumberOfBytesToWrite)
+    {
+        // Merge the adjacent blocks of the same kind into a single run, and
+        // the blocks are aligned to the file offset rather than the buffer.
+        DWORD RunStart = Processed;
+        bool ZeroRun = false;
+        while (Processed < NumberOfBytesToWrite)
+        {
+            ULONGLONG BlockOffset = Offset + Processed;
+            DWORD BlockLength = static_cast<DWORD>(
+                BlockSize - (BlockOffset % BlockSize));
+            if (BlockLength > NumberOfBytesToWrite - Processed)
+            {
+                BlockLength = NumberOfBytesToWrite - Processed;
+            }
+            bool ZeroBlock = ::MileIsZeroMemory(
+                Input + Processed,
+                BlockLength);
+            if (Processed == RunStart)
+            {
+                ZeroRun = ZeroBlock;
+            }
+            else if (ZeroRun != ZeroBlock)
+            {
+                break;
+            }
+            Processed += BlockLength;
+        }
+
+        ULONGLONG RunOffset = Offset + RunStart;
+        DWORD RunLength = Processed - RunStart;
+
+        if (ZeroRun && ZeroDataSupported)
+        {
+            // The range beyond the end of the file is already unallocated.
+            if (RunOffset < FileSize)
+            {
+                FILE_ZERO_DATA_INFORMATION ZeroDataInformation;
+                ZeroDataInformation.FileOffset.QuadPart =
+                    static_cast<LONGLONG>(RunOffset);
+                ZeroDataInformation.BeyondFinalZero.QuadPart =
+                    static_cast<LONGLONG>(RunOffset + RunLength);
+                if (!::MileDeviceIoControl(
+                    FileHandle,
+                    FSCTL_SET_ZERO_DATA,
+                    &ZeroDataInformation,
+                    sizeof(ZeroDataInformation),
+                    nullptr,
+                    0,
+                    nullptr))
+                {
+                    DWORD LastError = ::GetLastError();
+                    if (ERROR_INVALID_FUNCTION != LastError &&
+                        ERROR_NOT_SUPPORTED != LastError)
+                    {
+                        Processed = RunStart;
+                        Result = FALSE;
+                        break;
+                    }
+
+                    // Write the zeros if the file system does not support
+                    // the sparse files.
+                    ZeroDataSupported = false;
+                    ZeroRun = false;
+                }
+            }
+
+            if (ZeroRun)
+            {
+                Skipped += RunLength;
+                continue;
+            }
+        }
+
+        DWORD RunWritten = 0;
+        Result = ::MileWriteFileAt(
+            FileHandle,
+            Input + RunStart,
+            RunLength,
+            RunOffset,
+            &RunWritten);
+        if (Result && RunWritten != RunLength)
+        {
+            ::SetLastError(ERROR_WRITE_FAULT);
+            Result = FALSE;
+        }
+        if (!Result)
+        {
+            Processed = RunStart + RunWritten;
+            break;
+        }
+        if (RunOffset + RunLength > FileSize)
+        {
+            FileSize = RunOffset + RunLength;
+        }
+    }
+
+    if (Result && Offset + NumberOfBytesToWrite > FileSize)
+    {
+        // Extend the file to cover the trailing unallocated range.
+        FILE_END_OF_FILE_INFO EndOfFileInfo;
+        EndOfFileInfo.EndOfFile.QuadPart =
+            static_cast<LONGLONG>(Offset + NumberOfBytesToWrite);
+        Result = ::SetFileInformationByHandle(
+            FileHandle,
+            FileEndOfFileInfo,
+            &EndOfFileInfo,
+            sizeof(FILE_END_OF_FILE_INFO));
+        if (!Result)
+        {
+            // Only the skipped bytes beyond the end of the file are lost.
+            DWORD Excess = static_cast<DWORD>(
+                Offset + NumberOfBytesToWrite - FileSize);
+            Processed -= Excess;
+            Skipped -= Excess;
+        }
+    }
+
+    if (NumberOfBytesWritten)
+    {
+        *NumberOfBytesWritten = Processed;
+    }
+    if (NumberOfBytesSkipped)
+    {
+        *NumberOfBytesSkipped = Skipped;
+    }
+
+    return Result;
+}
+
+EXTERN_C BOOL WINAPI MileEnumerateAllocatedRanges(
+    _In_ HANDLE FileHandle,
+    _In_ ULONGLONG Offset,
+    _In_ ULONGLONG Length,
+    _In_ MILE_ALLOCATED_RANGES_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context)
+{
+    if (!Callback)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if (!Length)
+    {
+        ULONGLONG FileSize = 0;
+        if (!::MileGetFileSizeByHandle(FileHandle, &FileSize))
+        {
+            return FALSE;
+        }
+        if (FileSize <= Offset)
+        {
+            return TRUE;
+        }
+        Length = FileSize - Offset;
+    }
+
+    FILE_ALLOCATED_RANGE_BUFFER Query;
+    Query.FileOffset.QuadPart = static_cast<LONGLONG>(Offset);
+    Query.Length.QuadPart = static_cast<LONGLONG>(Length);
+    FILE_ALLOCATED_RANGE_BUFFER Ranges[64];
+
+    for (;;)
+    {
+        DWORD BytesReturned = 0;
+        BOOL Result = ::MileDeviceIoControl(
+            FileHandle,
+            FSCTL_QUERY_ALLOCATED_RANGES,
+            &Query,
+            sizeof(Query),
+            Ranges,
+            sizeof(Ranges),
+            &BytesReturned);
+        DWORD LastError = Result ? ERROR_SUCCESS : ::GetLastError();
+        if (!Result && ERROR_MORE_DATA != LastError)
+        {
+            if (ERROR_INVALID_FUNCTION != LastError &&
+                ERROR_NOT_SUPPORTED != LastError)
+            {
+                return FALSE;
+            }
+
+            // The file system does not support sparse files, so the whole
+            // range is treated as allocated.
+            if (!Callback(&Query, 1, Context))
+            {
+                ::SetLastError(ERROR_CANCELLED);
+                return FALSE;
+            }
+            return TRUE;
+        }
+
+        DWORD NumberOfRanges =
+            BytesReturned / sizeof(FILE_ALLOCATED_RANGE_BUFFER);
+        if (NumberOfRanges && !Callback(Ranges, NumberOfRanges, Context))
+        {
+            ::SetLastError(ERROR_CANCELLED);
+            return FALSE;
+        }
+
+        if (ERROR_MORE_DATA != LastError || !NumberOfRanges)
+        {
+            return TRUE;
+        }
+
+        // Continue from the end of the last returned range.
+        PFILE_ALLOCATED_RANGE_BUFFER Last = &Ranges[NumberOfRanges - 1];
+        LONGLONG NextOffset =
+            Last->FileOffset.QuadPart + Last->Length.QuadPart;
+        Query.Length.QuadPart -= NextOffset - Query.FileOffset.QuadPart;
+        Query.FileOffset.QuadPart = NextOffset;
+        if (Query.Length.QuadPart <= 0)
+        {
+            return TRUE;
+        }
+    }
+}
+
+namespace
+{
+    typedef struct _COPY_FILE_RANGE
+    {
+        ULONGLONG Offset;
+        ULONGLONG Length;
+    } COPY_FILE_RANGE, *PCOPY_FILE_RANGE;
+
+    static BOOL AppendCopyFileRange(
+        _Inout_ PCOPY_FILE_RANGE* Ranges,
+        _Inout_ PSIZE_T Count,
+        _Inout_ PSIZE_T Capacity,
+        _In_ ULONGLONG Offset,
+        _In_ ULONGLONG Length)
+    {
+        if (*Count == *Capacity)
+        {
+            SIZE_T NewCapacity = *Capacity ? *Capacity * 2 : 16;
+            LPVOID NewRanges = *Ranges
+                ? ::MileReallocateMemory(
+                    *Ranges,
+                    NewCapacity * sizeof(COPY_FILE_RANGE))
+                : ::MileAllocateMemory(
+                    NewCapacity * sizeof(COPY_FILE_RANGE));
+            if (!NewRanges)
+            {
+                ::SetLastError(ERROR_OUTOFMEMORY);
+                return FALSE;
+            }
+            *Ranges = reinterpret_cast<PCOPY_FILE_RANGE>(NewRanges);
+            *Capacity = NewCapacity;
+        }
+
+        (*Ranges)[*Count].Offset = Offset;
+        (*Ranges)[*Count].Length = Length;
+        ++*Count;
+        return TRUE;
+    }
+
+    typedef struct _QUERY_COPY_FILE_RANGES_CONTEXT
+    {
+        PCOPY_FILE_RANGE Ranges;
+        SIZE_T Count;
+        SIZE_T Capacity;
+    } QUERY_COPY_FILE_RANGES_CONTEXT, *PQUERY_COPY_FILE_RANGES_CONTEXT;
+
+    static BOOL WINAPI QueryCopyFileRangesCallback(
+        _In_ PFILE_ALLOCATED_RANGE_BUFFER Ranges,
+        _In_ DWORD NumberOfRanges,
+        _In_opt_ LPVOID Context)
+    {
+        PQUERY_COPY_FILE_RANGES_CONTEXT QueryContext =
+            reinterpret_cast<PQUERY_COPY_FILE_RANGES_CONTEXT>(Context);
+        for (DWORD i = 0; i < NumberOfRanges; ++i)
+        {
+            if (!::AppendCopyFileRange(
+                &QueryContext->Ranges,
+                &QueryContext->Count,
+                &QueryContext->Capacity,
+                static_cast<ULONGLONG>(Ranges[i].FileOffset.QuadPart),
+                static_cast<ULONGLONG>(Ranges[i].Length.QuadPart)))
+            {
+                return FALSE;
+            }
+        }
+        return TRUE;
+    }
+
+    static BOOL QueryCopyFileRanges(
+        _In_ HANDLE FileHandle,
+        _In_ ULONGLONG FileSize,
+        _In_ bool Sparse,
+        _Out_ PCOPY_FILE_RANGE* Ranges,
+        _Out_ PSIZE_T Count)
+    {
+        *Ranges = nullptr;
+        *Count = 0;
+
+        if (!FileSize)
+        {
+            return TRUE;
+        }
+
+        QUERY_COPY_FILE_RANGES_CONTEXT Context = {};
+
+        BOOL Result = FALSE;
+        if (Sparse)
+        {
+            Result = ::MileEnumerateAllocatedRanges(
+                FileHandle,
+                0,
+                FileSize,
+                ::QueryCopyFileRangesCallback,
+                &Context);
+            if (!Result && ERROR_CANCELLED == ::GetLastError())
+            {
+                // The callback fails only if the memory allocation fails.
+                ::SetLastError(ERROR_OUTOFMEMORY);
+            }
+        }
+        else
+        {
+            Result = ::AppendCopyFileRange(
+                &Context.Ranges,
+                &Context.Count,
+                &Context.Capacity,
+                0,
+                FileSize);
+        }
+
+        if (!Result)
+        {
+            if (Context.Ranges)
+            {
+                DWORD LastError = ::GetLastError();
+                ::MileFreeMemory(Context.Ranges);
+                ::SetLastError(LastError);
+            }
+            return FALSE;
+        }
+
+        *Ranges = Context.Ranges;
+        *Count = Context.Count;
+        return TRUE;
+    }
+
+    enum COPY_FILE_SLOT_STATE
+    {
+        CopyFileSlotFree,
+        CopyFileSlotReading,
+        CopyFileSlotWriting,
+        CopyFileSlotDone,
+    };
+
+    typedef struct _COPY_FILE_SLOT
+    {
+        OVERLAPPED Overlapped;
+        LPBYTE Buffer;
+        ULONGLONG Offset;
+        DWORD Length;
+        DWORD Transferred;
+        COPY_FILE_SLOT_STATE State;
+    } COPY_FILE_SLOT, *PCOPY_FILE_SLOT;
+
+    static void PrepareCopyFileSlot(
+        _In_ PCOPY_FILE_SLOT Slot,
+        _In_ ULONGLONG Offset)
+    {
+        Slot->Overlapped.Internal = 0;
+        Slot->Overlapped.InternalHigh = 0;
+        Slot->Overlapped.Offset = static_cast<DWORD>(Offset);
+        Slot->Overlapped.OffsetHigh = static_cast<DWORD>(Offset >> 32);
+    }
+
+    static BOOL CopyFileContent(
+        _In_ HANDLE SourceFileHandle,
+        _In_ HANDLE TargetFileHandle,
+        _In_ PCOPY_FILE_RANGE Ranges,
+        _In_ SIZE_T RangeCount,
+        _In_ bool Unbuffered,
+        _In_ DWORD SectorSize,
+        _In_ DWORD ChunkSize,
+        _In_ DWORD MaximumOutstandingRequests,
+        _In_opt_ MILE_FILE_TRANSFER_PROGRESS_CALLBACK_TYPE ProgressCallback,
+        _In_opt_ LPVOID Context)
+    {
+        ULONGLONG TotalBytes = 0;
+        ULONGLONG NumberOfChunks = 0;
+        for (SIZE_T i = 0; i < RangeCount; ++i)
+        {
+            TotalBytes += Ranges[i].Length;
+            NumberOfChunks += Ranges[i].Length / ChunkSize;
+            if (Ranges[i].Length % ChunkSize)
+            {
+                ++NumberOfChunks;
+            }
+        }
+
+        // The slots are completed one by one in the order of issue, so the
+        // depth is not limited by the wait functions. Only the slots which
+        // can be used by the chunks of the ranges are allocated, because
+        // each slot holds a buffer of the chunk size.
+        if (NumberOfChunks < MaximumOutstandingRequests)
+        {
+            MaximumOutstandingRequests = NumberOfChunks
+                ? static_cast<DWORD>(NumberOfChunks)
+                : 1;
+        }
+
+        PCOPY_FILE_SLOT Slots = reinterpret_cast<PCOPY_FILE_SLOT>(
+            ::MileAllocateMemory(
+                sizeof(COPY_FILE_SLOT) * MaximumOutstandingRequests));
+        if (!Slots)
+        {
+            ::SetLastError(ERROR_OUTOFMEMORY);
+            return FALSE;
+        }
+
+        DWORD LastError = ERROR_SUCCESS;
+
+        DWORD NumberOfSlots = 0;
+        for (; NumberOfSlots < MaximumOutstandingRequests; ++NumberOfSlots)
+        {
+            PCOPY_FILE_SLOT Slot = &Slots[NumberOfSlots];
+            Slot->Buffer = reinterpret_cast<LPBYTE>(
+                ::MileAllocateAlignedMemory(ChunkSize));
+            if (!Slot->Buffer)
+            {
+                LastError = ERROR_OUTOFMEMORY;
+                break;
+            }
+            Slot->Overlapped.hEvent = ::AcquireOverlappedEvent();
+            if (!Slot->Overlapped.hEvent)
+            {
+                ::MileFreeAlignedMemory(Slot->Buffer);
+                LastError = ERROR_NO_SYSTEM_RESOURCES;
+                break;
+            }
+        }
+
+        SIZE_T RangeIndex = 0;
+        ULONGLONG RangeOffset = 0;
+        ULONGLONG CompletedBytes = 0;
+        DWORD Head = 0;
+        DWORD Outstanding = 0;
+
+        while (ERROR_SUCCESS == LastError)
+        {
+            // Keep the pipeline filled with reads.
+            while (Outstanding < MaximumOutstandingRequests
+                && RangeIndex < RangeCount)
+            {
+                PCOPY_FILE_SLOT Slot = &Slots[
+                    (Head + Outstanding) % MaximumOutstandingRequests];
+
+                ULONGLONG RemainingBytes =
+                    Ranges[RangeIndex].Length - RangeOffset;
+                Slot->Offset = Ranges[RangeIndex].Offset + RangeOffset;
+                Slot->Length = RemainingBytes < ChunkSize
+                    ? static_cast<DWORD>(RemainingBytes)
+                    : ChunkSize;
+                Slot->Transferred = 0;
+                RangeOffset += Slot->Length;
+                if (RangeOffset == Ranges[RangeIndex].Length)
+                {
+                    ++RangeIndex;
+                    RangeOffset = 0;
+                }
+
+                DWORD RequestSize = Slot->Length;
+                if (Unbuffered)
+                {
+                    RequestSize = (RequestSize + SectorSize - 1)
+                        & ~(SectorSize - 1);
+                }
+
+                ::PrepareCopyFileSlot(Slot, Slot->Offset);
+                if (!::ReadFile(
+                    SourceFileHandle,
+                    Slot->Buffer,
+                    RequestSize,
+                    nullptr,
+                    &Slot->Overlapped))
+                {
+                    DWORD Error = ::GetLastError();
+                    if (ERROR_HANDLE_EOF == Error)
+                    {
+                        // The source file is truncated during the copy.
+                        Slot->State = CopyFileSlotDone;
+                        ++Outstanding;
+                        continue;
+                    }
+                    if (ERROR_IO_PENDING != Error)
+                    {
+                        LastError = Error;
+                        break;
+                    }
+                }
+                Slot->State = CopyFileSlotReading;
+                ++Outstanding;
+            }
+
+            if (ERROR_SUCCESS != LastError || !Outstanding)
+            {
+                break;
+            }
+
+            // Turn the completed reads into writes in order. Only the read of
+            // the oldest chunk is waited for.
+            for (DWORD i = 0; i < Outstanding; ++i)
+            {
+                PCOPY_FILE_SLOT Slot = &Slots[
+                    (Head + i) % MaximumOutstandingRequests];
+                if (CopyFileSlotReading != Slot->State)
+                {
+                    continue;
+                }
+                if (i && !HasOverlappedIoCompleted(&Slot->Overlapped))
+                {
+                    break;
+                }
+
+                DWORD NumberOfBytesRead = 0;
+                if (!::GetOverlappedResult(
+                    SourceFileHandle,
+                    &Slot->Overlapped,
+                    &NumberOfBytesRead,
+                    TRUE))
+                {
+                    DWORD Error = ::GetLastError();
+                    if (ERROR_HANDLE_EOF != Error)
+                    {
+                        Slot->State = CopyFileSlotDone;
+                        LastError = Error;
+                        break;
+                    }
+                    NumberOfBytesRead = 0;
+                }
+                Slot->Transferred = NumberOfBytesRead < Slot->Length
+                    ? NumberOfBytesRead
+                    : Slot->Length;
+                if (!Slot->Transferred)
+                {
+                    Slot->State = CopyFileSlotDone;
+                    continue;
+                }
+
+                DWORD RequestSize = Slot->Transferred;
+                if (Unbuffered)
+                {
+                    // Pad the last partial sector with zeros, and the end of
+                    // the file will be trimmed after the copy.
+                    RequestSize = (RequestSize + SectorSize - 1)
+                        & ~(SectorSize - 1);
+                    std::memset(
+                        Slot->Buffer + Slot->Transferred,
+                        0,
+                        RequestSize - Slot->Transferred);
+                }
+
+                ::PrepareCopyFileSlot(Slot, Slot->Offset);
+                if (!::WriteFile(
+                    TargetFileHandle,
+                    Slot->Buffer,
+                    RequestSize,
+                    nullptr,
+                    &Slot->Overlapped))
+                {
+                    if (ERROR_IO_PENDING != ::GetLastError())
+                    {
+                        Slot->State = CopyFileSlotDone;
+                        LastError = ::GetLastError();
+                        break;
+                    }
+                }
+                Slot->Length = RequestSize;
+                Slot->State = CopyFileSlotWriting;
+            }
+
+            if (ERROR_SUCCESS != LastError)
+            {
+                break;
+            }
+
+            // Retire the oldest chunk.
+            PCOPY_FILE_SLOT Slot = &Slots[Head];
+            if (CopyFileSlotWriting == Slot->State)
+            {
+                DWORD NumberOfBytesWritten = 0;
+                if (!::GetOverlappedResult(
+                    TargetFileHandle,
+                    &Slot->Overlapped,
+                    &NumberOfBytesWritten,
+                    TRUE))
+                {
+                    Slot->State = CopyFileSlotDone;
+                    LastError = ::GetLastError();
+                    break;
+                }
+                if (NumberOfBytesWritten < Slot->Length)
+                {
+                    if (!::MileWriteFileFull(
+                        TargetFileHandle,
+                        Slot->Buffer + NumberOfBytesWritten,
+                        Slot->Length - NumberOfBytesWritten,
+                        Slot->Offset + NumberOfBytesWritten,
+                        0,
+                        1,
+                        nullptr,
+                        nullptr,
+                        nullptr))
+                    {
+                        Slot->State = CopyFileSlotDone;
+                        LastError = ::GetLastError();
+                        break;
+                    }
+                }
+            }
+            Slot->State = CopyFileSlotFree;
+            Head = (Head + 1) % MaximumOutstandingRequests;
+            --Outstanding;
+
+            CompletedBytes += Slot->Transferred;
+            if (ProgressCallback && !ProgressCallback(
+                CompletedBytes,
+                TotalBytes,
+                Context))
+            {
+                LastError = ERROR_CANCELLED;
+                break;
+            }
+        }
+
+        // Cancel and drain the requests which are still in flight.
+        for (DWORD i = 0; i < NumberOfSlots; ++i)
+        {
+            PCOPY_FILE_SLOT Slot = &Slots[i];
+            HANDLE FileHandle = nullptr;
+            if (CopyFileSlotReading == Slot->State)
+            {
+                FileHandle = SourceFileHandle;
+            }
+            else if (CopyFileSlotWriting == Slot->State)
+            {
+                FileHandle = TargetFileHandle;
+            }
+            if (FileHandle)
+            {
+                ::CancelIoEx(FileHandle, &Slot->Overlapped);
+                DWORD NumberOfBytesTransferred = 0;
+                ::GetOverlappedResult(
+                    FileHandle,
+                    &Slot->Overlapped,
+                    &NumberOfBytesTransferred,
+                    TRUE);
+            }
+            ::ReleaseOverlappedEvent(Slot->Overlapped.hEvent);
+            ::MileFreeAlignedMemory(Slot->Buffer);
+        }
+        ::MileFreeMemory(Slots);
+
+        if (ERROR_SUCCESS != LastError)
+        {
+            ::SetLastError(LastError);
+            return FALSE;
+        }
+
+        return TRUE;
+    }
+}
+
+EXTERN_C BOOL WINAPI MileCopyFileByHandle(
+    _In_ HANDLE SourceFileHandle,
+    _In_ HANDLE TargetFileHandle,
+    _In_ DWORD Flags,
+    _In_ DWORD ChunkSize,
+    _In_ DWORD MaximumOutstandingRequests,
+    _In_opt_ MILE_FILE_TRANSFER_PROGRESS_CALLBACK_TYPE ProgressCallback,
+    _In_opt_ LPVOID Context)
+{
+    bool Unbuffered = (Flags & MILE_COPY_FILE_FLAG_UNBUFFERED);
+
+    if (!ChunkSize)
+    {
+        ChunkSize = 1024 * 1024;
+    }
+    if (!MaximumOutstandingRequests)
+    {
+        MaximumOutstandingRequests = 4;
+    }
+
+    DWORD SectorSize = 1;
+    if (Unbuffered)
+    {
+        DWORD SourceSectorSize = 0;
+        DWORD TargetSectorSize = 0;
+        if (!::MileGetFileSectorSize(SourceFileHandle, &SourceSectorSize) ||
+            !::MileGetFileSectorSize(TargetFileHandle, &TargetSectorSize))
+        {
+            return FALSE;
+        }
+        SectorSize = SourceSectorSize > TargetSectorSize
+            ? SourceSectorSize
+            : TargetSectorSize;
+        ChunkSize = (ChunkSize + SectorSize - 1) & ~(SectorSize - 1);
+    }
+
+    FILE_BASIC_INFO BasicInfo;
+    if (!::GetFileInformationByHandleEx(
+        SourceFileHandle,
+        FileBasicInfo,
+        &BasicInfo,
+        sizeof(FILE_BASIC_INFO)))
+    {
+        return FALSE;
+    }
+
+    ULONGLONG FileSize = 0;
+    if (!::MileGetFileSizeByHandle(SourceFileHandle, &FileSize))
+    {
+        return FALSE;
+    }
+
+    bool Sparse = (BasicInfo.FileAttributes & FILE_ATTRIBUTE_SPARSE_FILE);
+    if (Sparse)
+    {
+        // Keep the holes in the target file unallocated. Fall back to the
+        // full copy if the target file system does not support sparse files.
+        FILE_SET_SPARSE_BUFFER SparseBuffer;
+        SparseBuffer.SetSparse = TRUE;
+        Sparse = ::MileDeviceIoControl(
+            TargetFileHandle,
+            FSCTL_SET_SPARSE,
+            &SparseBuffer,
+            sizeof(SparseBuffer),
+            nullptr,
+            0,
+            nullptr);
+    }
+
+    PCOPY_FILE_RANGE Ranges = nullptr;
+    SIZE_T RangeCount = 0;
+    if (!::QueryCopyFileRanges(
+        SourceFileHandle,
+        FileSize,
+        Sparse,
+        &Ranges,
+        &RangeCount))
+    {
+        return FALSE;
+    }
+
+    BOOL Result = ::CopyFileContent(
+        SourceFileHandle,
+        TargetFileHandle,
+        Ranges,
+        RangeCount,
+        Unbuffered,
+        SectorSize,
+        ChunkSize,
+        MaximumOutstandingRequests,
+        ProgressCallback,
+        Context);
+
+    if (Ranges)
+    {
+        ::MileFreeMemory(Ranges);
+    }
+
+    if (!Result)
+    {
+        return FALSE;
+    }
+
+    // Set the exact size, which covers the trailing hole of the sparse file
+    // and the padding of the unbuffered I/O.
+    FILE_END_OF_FILE_INFO EndOfFileInfo;
+    EndOfFileInfo.EndOfFile.QuadPart = static_cast<LONGLONG>(FileSize);
+    if (!::SetFileInformationByHandle(
+        TargetFileHandle,
+        FileEndOfFileInfo,
+        &EndOfFileInfo,
+        sizeof(FILE_END_OF_FILE_INFO)))
+    {
+        return FALSE;
+    }
+
+    // Copy the timestamps and attributes at last because the writes update
+    // the timestamps. The attributes which cannot be set in this way are
+    // excluded, and the change time is maintained by the file system.
+    BasicInfo.ChangeTime.QuadPart = 0;
+    BasicInfo.FileAttributes &=
+        FILE_ATTRIBUTE_READONLY |
+        FILE_ATTRIBUTE_HIDDEN |
+        FILE_ATTRIBUTE_SYSTEM |
+        FILE_ATTRIBUTE_ARCHIVE |
+        FILE_ATTRIBUTE_TEMPORARY |
+        FILE_ATTRIBUTE_OFFLINE |
+        FILE_ATTRIBUTE_NOT_CONTENT_INDEXED;
+    if (!BasicInfo.FileAttributes)
+    {
+        BasicInfo.FileAttributes = FILE_ATTRIBUTE_NORMAL;
+    }
+    return ::SetFileInformationByHandle(
+        TargetFileHandle,
+        FileBasicInfo,
+        &BasicInfo,
+        sizeof(FILE_BASIC_INFO));
+}
+
+EXTERN_C BOOL WINAPI MileCopyFileEx(
+    _In_ LPCWSTR ExistingFileName,
+    _In_ LPCWSTR NewFileName,
+    _In_ DWORD Flags,
+    _In_ DWORD ChunkSize,
+    _In_ DWORD MaximumOutstandingRequests,
+    _In_opt_ MILE_FILE_TRANSFER_PROGRESS_CALLBACK_TYPE ProgressCallback,
+    _In_opt_ LPVOID Context)
+{
+    DWORD FlagsAndAttributes = FILE_FLAG_OVERLAPPED;
+    if (Flags & MILE_COPY_FILE_FLAG_UNBUFFERED)
+    {
+        FlagsAndAttributes |= FILE_FLAG_NO_BUFFERING;
+    }
+    else
+    {
+        FlagsAndAttributes |= FILE_FLAG_SEQUENTIAL_SCAN;
+    }
+
+    HANDLE SourceFileHandle = ::MileCreateFile(
+        ExistingFileName,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FlagsAndAttributes,
+        nullptr);
+    if (INVALID_HANDLE_VALUE == SourceFileHandle)
+    {
+        return FALSE;
+    }
+
+    HANDLE TargetFileHandle = ::MileCreateFile(
+        NewFileName,
+        GENERIC_READ | GENERIC_WRITE | DELETE,
+        0,
+        nullptr,
+        (Flags & MILE_COPY_FILE_FLAG_FAIL_IF_EXISTS)
+        ? CREATE_NEW
+        : CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL | FlagsAndAttributes,
+        nullptr);
+    if (INVALID_HANDLE_VALUE == TargetFileHandle)
+    {
+        DWORD LastError = ::GetLastError();
+        ::CloseHandle(SourceFileHandle);
+        ::SetLastError(LastError);
+        return FALSE;
+    }
+
+    BOOL Result = ::MileCopyFileByHandle(
+        SourceFileHandle,
+        TargetFileHandle,
+        Flags,
+        ChunkSize,
+        MaximumOutstandingRequests,
+        ProgressCallback,
+        Context);
+    DWORD LastError = Result ? ERROR_SUCCESS : ::GetLastError();
+
+    if (!Result)
+    {
+        ::MileDeleteFileByHandle(TargetFileHandle);
+    }
+
+    ::CloseHandle(TargetFileHandle);
+    ::CloseHandle(SourceFileHandle);
+
+    if (!Result)
+    {
+        ::SetLastError(LastError);
+    }
+
+    return Result;
+}
+
+namespace
+{
+    typedef void(*PARALLEL_FOR_CALLBACK)(
+        _In_ SIZE_T Index,
+        _In_opt_ LPVOID Context);
+
+    typedef struct _PARALLEL_FOR_CONTEXT
+    {
+        SIZE_T Count;
+        PARALLEL_FOR_CALLBACK Callback;
+        LPVOID Context;
+        volatile LONG64 NextIndex;
+    } PARALLEL_FOR_CONTEXT, *PPARALLEL_FOR_CONTEXT;
+
+    static VOID CALLBACK ParallelForWorkCallback(
+        _Inout_ PTP_CALLBACK_INSTANCE Instance,
+        _Inout_opt_ PVOID Context,
+        _Inout_ PTP_WORK Work)
+    {
+        UNREFERENCED_PARAMETER(Instance);
+        UNREFERENCED_PARAMETER(Work);
+
+        PPARALLEL_FOR_CONTEXT ParallelContext =
+            reinterpret_cast<PPARALLEL_FOR_CONTEXT>(Context);
+
+        for (;;)
+        {
+            SIZE_T Index = static_cast<SIZE_T>(
+                ::InterlockedIncrement64(&ParallelContext->NextIndex) - 1);
+            if (Index >= ParallelContext->Count)
+            {
+                break;
+            }
+
+            ParallelContext->Callback(Index, ParallelContext->Context);
+        }
+    }
+
+    // Calls the callback for each index in [0, Count) on the system thread
+    // pool. The same work item is submitted once per worker, and the workers
+    // pull the indices from a shared counter.
+    static BOOL ParallelFor(
+        _In_ SIZE_T Count,
+        _In_ DWORD MaximumConcurrency,
+        _In_ PARALLEL_FOR_CALLBACK Callback,
+        _In_opt_ LPVOID Context)
+    {
+        if (!MaximumConcurrency)
+        {
+            MaximumConcurrency = ::MileGetNumberOfHardwareThreads();
+        }
+        if (MaximumConcurrency > Count)
+        {
+            MaximumConcurrency = static_cast<DWORD>(Count);
+        }
+
+        PARALLEL_FOR_CONTEXT ParallelContext;
+        ParallelContext.Count = Count;
+        ParallelContext.Callback = Callback;
+        ParallelContext.Context = Context;
+        ParallelContext.NextIndex = 0;
+
+        if (MaximumConcurrency > 1)
+        {
+            PTP_WORK Work = ::CreateThreadpoolWork(
+                ::ParallelForWorkCallback,
+                &ParallelContext,
+                nullptr);
+            if (!Work)
+            {
+                return FALSE;
+            }
+            for (DWORD i = 0; i < MaximumConcurrency; ++i)
+            {
+                ::SubmitThreadpoolWork(Work);
+            }
+            ::WaitForThreadpoolWorkCallbacks(Work, FALSE);
+            ::CloseThreadpoolWork(Work);
+        }
+        else
+        {
+            ::ParallelForWorkCallback(nullptr, &ParallelContext, nullptr);
+        }
+
+        return TRUE;
+    }
+
+    typedef struct _COPY_FILES_CONTEXT
+    {
+        PMILE_COPY_FILE_ITEM Items;
+        DWORD Flags;
+    } COPY_FILES_CONTEXT, *PCOPY_FILES_CONTEXT;
+
+    static void CopyFilesItemCallback(
+        _In_ SIZE_T Index,
+        _In_opt_ LPVOID Context)
+    {
+        PCOPY_FILES_CONTEXT CopyContext =
+            reinterpret_cast<PCOPY_FILES_CONTEXT>(Context);
+
+        PMILE_COPY_FILE_ITEM Item = &CopyContext->Items[Index];
+        Item->Error = ::MileCopyFileEx(
+            Item->ExistingFileName,
+            Item->NewFileName,
+            CopyContext->Flags,
+            0,
+            0,
+            nullptr,
+            nullptr)
+            ? ERROR_SUCCESS
+            : ::GetLastError();
+    }
+}
+
+EXTERN_C BOOL WINAPI MileCopyFiles(
+    _Inout_ PMILE_COPY_FILE_ITEM Items,
+    _In_ SIZE_T Count,
+    _In_ DWORD Flags,
+    _In_ DWORD MaximumConcurrency)
+{
+    if (!Items && Count)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    COPY_FILES_CONTEXT Context;
+    Context.Items = Items;
+    Context.Flags = Flags;
+    if (!::ParallelFor(
+        Count,
+        MaximumConcurrency,
+        ::CopyFilesItemCallback,
+        &Context))
+    {
+        return FALSE;
+    }
+
+    for (SIZE_T i = 0; i < Count; ++i)
+    {
+        if (ERROR_SUCCESS != Items[i].Error)
+        {
+            ::SetLastError(Items[i].Error);
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+namespace
+{
+    static BOOL CopyFileRangeByBytes(
+        _In_ HANDLE SourceFileHandle,
+        _In_ ULONGLONG SourceOffset,
+        _In_ HANDLE TargetFileHandle,
+        _In_ ULONGLONG TargetOffset,
+        _In_ ULONGLONG Length)
+    {
+        if (!Length)
+        {
+            return TRUE;
+        }
+
+        const DWORD MaximumBufferSize = 1024 * 1024;
+        DWORD BufferSize = Length < MaximumBufferSize
+            ? static_cast<DWORD>(Length)
+            : MaximumBufferSize;
+        LPBYTE Buffer = reinterpret_cast<LPBYTE>(
+            ::MileAllocateMemory(BufferSize));
+        if (!Buffer)
+        {
+            ::SetLastError(ERROR_OUTOFMEMORY);
+            return FALSE;
+        }
+
+        BOOL Result = TRUE;
+        while (Length)
+        {
+            DWORD Count = Length < BufferSize
+                ? static_cast<DWORD>(Length)
+                : BufferSize;
+
+            DWORD NumberOfBytesRead = 0;
+            Result = ::MileReadFileAt(
+                SourceFileHandle,
+                Buffer,
+                Count,
+                SourceOffset,
+                &NumberOfBytesRead);
+            if (Result && NumberOfBytesRead != Count)
+            {
+                ::SetLastError(ERROR_HANDLE_EOF);
+                Result = FALSE;
+            }
+            if (!Result)
+            {
+                break;
+            }
+
+            DWORD NumberOfBytesWritten = 0;
+            Result = ::MileWriteFileAt(
+                TargetFileHandle,
+                Buffer,
+                Count,
+                TargetOffset,
+                &NumberOfBytesWritten);
+            if (Result && NumberOfBytesWritten != Count)
+            {
+                ::SetLastError(ERROR_WRITE_FAULT);
+                Result = FALSE;
+            }
+            if (!Result)
+            {
+                break;
+            }
+
+            SourceOffset += Count;
+            TargetOffset += Count;
+            Length -= Count;
+        }
+
+        DWORD LastError = Result ? ERROR_SUCCESS : ::GetLastError();
+        ::MileFreeMemory(Buffer);
+        if (!Result)
+        {
+            ::SetLastError(LastError);
+        }
+
+        return Result;
+    }
+}
+
+EXTERN_C BOOL WINAPI MileCloneFileRange(
+    _In_ HANDLE SourceFileHandle,
+    _In_ ULONGLONG SourceOffset,
+    _In_ HANDLE TargetFileHandle,
+    _In_ ULONGLONG TargetOffset,
+    _In_ ULONGLONG Length,
+    _Out_opt_ PBOOL Cloned)
+{
+    if (Cloned)
+    {
+        *Cloned = FALSE;
+    }
+
+    if (!Length)
+    {
+        return TRUE;
+    }
+
+    // Only the file systems which support the block cloning like ReFS report
+    // the cluster size via the integrity information.
+    FSCTL_GET_INTEGRITY_INFORMATION_BUFFER IntegrityInformation;
+    if (!::MileDeviceIoControl(
+        SourceFileHandle,
+        FSCTL_GET_INTEGRITY_INFORMATION,
+        nullptr,
+        0,
+        &IntegrityInformation,
+        sizeof(IntegrityInformation),
+        nullptr))
+    {
+        return ::CopyFileRangeByBytes(
+            SourceFileHandle,
+            SourceOffset,
+            TargetFileHandle,
+            TargetOffset,
+            Length);
+    }
+
+    ULONGLONG ClusterSize = IntegrityInformation.ClusterSizeInBytes;
+    if (!ClusterSize ||
+        (SourceOffset % ClusterSize) != (TargetOffset % ClusterSize))
+    {
+        return ::CopyFileRangeByBytes(
+            SourceFileHandle,
+            SourceOffset,
+            TargetFileHandle,
+            TargetOffset,
+            Length);
+    }
+
+    // Split the range into the unaligned head, the cluster aligned body and
+    // the unaligned tail.
+    ULONGLONG HeadLength =
+        (ClusterSize - (SourceOffset % ClusterSize)) % ClusterSize;
+    if (HeadLength > Length)
+    {
+        HeadLength = Length;
+    }
+    ULONGLONG BodyLength =
+        ((Length - HeadLength) / ClusterSize) * ClusterSize;
+    ULONGLONG TailLength = Length - HeadLength - BodyLength;
+
+    if (!BodyLength)
+    {
+        return ::CopyFileRangeByBytes(
+            SourceFileHandle,
+            SourceOffset,
+            TargetFileHandle,
+            TargetOffset,
+            Length);
+    }
+
+    // The target range must be within the end of the target file.
+    ULONGLONG TargetFileSize = 0;
+    if (!::MileGetFileSizeByHandle(TargetFileHandle, &TargetFileSize))
+    {
+        return FALSE;
+    }
+    if (TargetFileSize < TargetOffset + Length)
+    {
+        FILE_END_OF_FILE_INFO EndOfFileInfo;
+        EndOfFileInfo.EndOfFile.QuadPart =
+            static_cast<LONGLONG>(TargetOffset + Length);
+        if (!::SetFileInformationByHandle(
+            TargetFileHandle,
+            FileEndOfFileInfo,
+            &EndOfFileInfo,
+            sizeof(FILE_END_OF_FILE_INFO)))
+        {
+            return FALSE;
+        }
+    }
+
+    if (!::CopyFileRangeByBytes(
+        SourceFileHandle,
+        SourceOffset,
+        TargetFileHandle,
+        TargetOffset,
+        HeadLength))
+    {
+        return FALSE;
+    }
+
+    ULONGLONG BodySourceOffset = SourceOffset + HeadLength;
+    ULONGLONG BodyTargetOffset = TargetOffset + HeadLength;
+
+    // Clone the body in chunks of at most 1 GiB, which is below the 4 GiB
+    // limit of a single request.
+    const ULONGLONG MaximumChunkSize =
+        ((1024 * 1024 * 1024) / ClusterSize) * ClusterSize;
+
+    ULONGLONG ClonedLength = 0;
+    while (ClonedLength < BodyLength)
+    {
+        ULONGLONG ChunkSize = BodyLength - ClonedLength;
+        if (MaximumChunkSize && ChunkSize > MaximumChunkSize)
+        {
+            ChunkSize = MaximumChunkSize;
+        }
+
+        DUPLICATE_EXTENTS_DATA DuplicateExtentsData;
+        DuplicateExtentsData.FileHandle = SourceFileHandle;
+        DuplicateExtentsData.SourceFileOffset.QuadPart =
+            static_cast<LONGLONG>(BodySourceOffset + ClonedLength);
+        DuplicateExtentsData.TargetFileOffset.QuadPart =
+            static_cast<LONGLONG>(BodyTargetOffset + ClonedLength);
+        DuplicateExtentsData.ByteCount.QuadPart =
+            static_cast<LONGLONG>(ChunkSize);
+        if (!::MileDeviceIoControl(
+            TargetFileHandle,
+            FSCTL_DUPLICATE_EXTENTS_TO_FILE,
+            &DuplicateExtentsData,
+            sizeof(DuplicateExtentsData),
+            nullptr,
+            0,
+            nullptr))
+        {
+            break;
+        }
+
+        ClonedLength += ChunkSize;
+    }
+
+    if (ClonedLength < BodyLength)
+    {
+        // Fall back to the byte copy for the rest of the body, for example
+        // the files are on the different volumes.
+        if (!::CopyFileRangeByBytes(
+            SourceFileHandle,
+            BodySourceOffset + ClonedLength,
+            TargetFileHandle,
+            BodyTargetOffset + ClonedLength,
+            BodyLength - ClonedLength))
+        {
+            return FALSE;
+        }
+    }
+    else if (Cloned)
+    {
+        *Cloned = TRUE;
+    }
+
+    return ::CopyFileRangeByBytes(
+        SourceFileHandle,
+        BodySourceOffset + BodyLength,
+        TargetFileHandle,
+        BodyTargetOffset + BodyLength,
+        TailLength);
+}
+
+EXTERN_C BOOL WINAPI MilePreallocateFile(
+    _In_ HANDLE FileHandle,
+    _In_ ULONGLONG AllocationSize)
+{
+    FILE_ALLOCATION_INFO AllocationInfo;
+    AllocationInfo.AllocationSize.QuadPart =
+        static_cast<LONGLONG>(AllocationSize);
+    return ::SetFileInformationByHandle(
+        FileHandle,
+        FileAllocationInfo,
+        &AllocationInfo,
+        sizeof(FILE_ALLOCATION_INFO));
+}
+
+namespace
+{
+    const ULONG NtFileInternalInformationClass = 6;
+    const ULONG NtFileAllInformationClass = 18;
+
+    // The layout of FILE_ALL_INFORMATION, and the layouts of FILE_BASIC_INFO
+    // and FILE_STANDARD_INFO are identical to FILE_BASIC_INFORMATION and
+    // FILE_STANDARD_INFORMATION.
+    typedef struct _NtFileAllInformation
+    {
+        FILE_BASIC_INFO BasicInformation;
+        FILE_STANDARD_INFO StandardInformation;
+        LARGE_INTEGER IndexNumber;
+        ULONG EaSize;
+        ACCESS_MASK AccessFlags;
+        LARGE_INTEGER CurrentByteOffset;
+        ULONG Mode;
+        ULONG AlignmentRequirement;
+        ULONG FileNameLength;
+        WCHAR FileName[1];
+    } NtFileAllInformation, * NtFileAllInformationPointer;
+
+    static FARPROC GetNtQueryInformationFileProcAddress()
+    {
+        static FARPROC CachedResult = ([]() -> FARPROC
+        {
+            HMODULE ModuleHandle = ::GetNtDllModuleHandle();
+            if (ModuleHandle)
+            {
+                return ::GetProcAddress(
+                    ModuleHandle,
+                    "NtQueryInformationFile");
+            }
+            return nullptr;
+        }());
+
+        return CachedResult;
+    }
+
+    static NTSTATUS NTAPI NtQueryInformationFileWrapper(
+        _In_ HANDLE FileHandle,
+        _Out_ NtIoStatusBlockPointer IoStatusBlock,
+        _Out_ PVOID FileInformation,
+        _In_ ULONG Length,
+        _In_ ULONG FileInformationClass)
+    {
+        using ProcType = decltype(::NtQueryInformationFileWrapper)*;
+
+        ProcType ProcAddress = reinterpret_cast<ProcType>(
+            ::GetNtQueryInformationFileProcAddress());
+
+        if (ProcAddress)
+        {
+            return ProcAddress(
+                FileHandle,
+                IoStatusBlock,
+                FileInformation,
+                Length,
+                FileInformationClass);
+        }
+
+        return NtStatusNotImplemented;
+    }
 
-        return TRUE;
+    static void FillFileMetadataBasic(
+        _Out_ PMILE_FILE_METADATA Metadata,
+        _In_ PFILE_BASIC_INFO BasicInfo)
+    {
+        Metadata->CreationTime = BasicInfo->CreationTime;
+        Metadata->LastAccessTime = BasicInfo->LastAccessTime;
+        Metadata->LastWriteTime = BasicInfo->LastWriteTime;
+        Metadata->ChangeTime = BasicInfo->ChangeTime;
+        Metadata->FileAttributes = BasicInfo->FileAttributes;
     }
 
-    return ::MileGetFileSizeByHandle(FileHandle, CompressedFileSize);
+    static void FillFileMetadataStandard(
+        _Out_ PMILE_FILE_METADATA Metadata,
+        _In_ PFILE_STANDARD_INFO StandardInfo)
+    {
+        Metadata->FileSize =
+            static_cast<ULONGLONG>(StandardInfo->EndOfFile.QuadPart);
+        Metadata->AllocationSize =
+            static_cast<ULONGLONG>(StandardInfo->AllocationSize.QuadPart);
+        Metadata->NumberOfLinks = StandardInfo->NumberOfLinks;
+        Metadata->DeletePending = StandardInfo->DeletePending;
+        Metadata->Directory = StandardInfo->Directory;
+    }
 }
 
-EXTERN_C BOOL WINAPI MileReadFile(
+EXTERN_C BOOL WINAPI MileQueryFileMetadata(
     _In_ HANDLE FileHandle,
-    _Out_opt_ LPVOID Buffer,
-    _In_ DWORD NumberOfBytesToRead,
-    _Out_opt_ LPDWORD NumberOfBytesRead)
+    _In_ DWORD Fields,
+    _Out_ PMILE_FILE_METADATA Metadata)
 {
-    BOOL Result = FALSE;
-    DWORD LastError = ERROR_SUCCESS;
-    DWORD NumberOfBytesTransferred = 0;
-    OVERLAPPED Overlapped = {};
-    Overlapped.hEvent = ::CreateEventW(
-        nullptr,
-        TRUE,
-        FALSE,
-        nullptr);
-    if (Overlapped.hEvent)
+    if (!Metadata)
     {
-        bool FilePointerAvailable = false;
-        LARGE_INTEGER CurrentFilePointer = {};
-        {
-            LARGE_INTEGER DistanceToMove = {};
-            if (::SetFilePointerEx(
-                FileHandle,
-                DistanceToMove,
-                &CurrentFilePointer,
-                FILE_CURRENT))
-            {
-                FilePointerAvailable = true;
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+    std::memset(Metadata, 0, sizeof(MILE_FILE_METADATA));
 
-                Overlapped.Offset = CurrentFilePointer.LowPart;
-                Overlapped.OffsetHigh = CurrentFilePointer.HighPart;
-            }
-        }
+    Fields &= MILE_FILE_METADATA_FIELD_ALL;
+    if (!Fields)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
 
-        Result = ::ReadFile(
+    // Query all fields in a single system call if more than one information
+    // class is requested. The fixed part is still filled if the file name
+    // does not fit into the buffer.
+    if (Fields & (Fields - 1))
+    {
+        NtFileAllInformation AllInformation;
+        NtIoStatusBlock IoStatusBlock;
+        NTSTATUS Status = ::NtQueryInformationFileWrapper(
             FileHandle,
-            Buffer,
-            NumberOfBytesToRead,
-            &NumberOfBytesTransferred,
-            &Overlapped);
-        if (!Result)
+            &IoStatusBlock,
+            &AllInformation,
+            sizeof(AllInformation),
+            NtFileAllInformationClass);
+        if (::IsNtStatusSuccess(Status) || NtStatusBufferOverflow == Status)
         {
-            LastError = ::GetLastError();
-
-            if (ERROR_IO_PENDING == LastError)
-            {
-                Result = ::GetOverlappedResult(
-                    FileHandle,
-                    &Overlapped,
-                    &NumberOfBytesTransferred,
-                    TRUE);
-                if (!Result)
-                {
-                    LastError = ::GetLastError();
-                }
-            }
+            ::FillFileMetadataBasic(
+                Metadata,
+                &AllInformation.BasicInformation);
+            ::FillFileMetadataStandard(
+                Metadata,
+                &AllInformation.StandardInformation);
+            Metadata->FileIndex =
+                static_cast<ULONGLONG>(AllInformation.IndexNumber.QuadPart);
+            Metadata->ValidFields = Fields;
+            return TRUE;
         }
+    }
 
-        if (Result && FilePointerAvailable)
+    if (Fields & MILE_FILE_METADATA_FIELD_BASIC)
+    {
+        FILE_BASIC_INFO BasicInfo;
+        if (!::GetFileInformationByHandleEx(
+            FileHandle,
+            FILE_INFO_BY_HANDLE_CLASS::FileBasicInfo,
+            &BasicInfo,
+            sizeof(FILE_BASIC_INFO)))
         {
-            CurrentFilePointer.QuadPart += NumberOfBytesTransferred;
-            Result = ::SetFilePointerEx(
-                FileHandle,
-                CurrentFilePointer,
-                nullptr,
-                FILE_BEGIN);
-            if (!Result)
-            {
-                LastError = ::GetLastError();
-            }
+            return FALSE;
         }
-
-        ::CloseHandle(Overlapped.hEvent);
-    }
-    else
-    {
-        LastError = ERROR_NO_SYSTEM_RESOURCES;
+        ::FillFileMetadataBasic(Metadata, &BasicInfo);
     }
 
-    if (NumberOfBytesRead)
+    if (Fields & MILE_FILE_METADATA_FIELD_STANDARD)
     {
-        *NumberOfBytesRead = NumberOfBytesTransferred;
+        FILE_STANDARD_INFO StandardInfo;
+        if (!::GetFileInformationByHandleEx(
+            FileHandle,
+            FILE_INFO_BY_HANDLE_CLASS::FileStandardInfo,
+            &StandardInfo,
+            sizeof(FILE_STANDARD_INFO)))
+        {
+            return FALSE;
+        }
+        ::FillFileMetadataStandard(Metadata, &StandardInfo);
     }
 
-    if (!Result)
+    if (Fields & MILE_FILE_METADATA_FIELD_INDEX)
     {
-        ::SetLastError(LastError);
+        // FILE_INTERNAL_INFORMATION only contains the file index, which
+        // avoids the extra queries made by GetFileInformationByHandle.
+        LARGE_INTEGER IndexNumber;
+        NtIoStatusBlock IoStatusBlock;
+        NTSTATUS Status = ::NtQueryInformationFileWrapper(
+            FileHandle,
+            &IoStatusBlock,
+            &IndexNumber,
+            sizeof(IndexNumber),
+            NtFileInternalInformationClass);
+        if (!::IsNtStatusSuccess(Status))
+        {
+            ::SetLastError(::RtlNtStatusToDosErrorWrapper(Status));
+            return FALSE;
+        }
+        Metadata->FileIndex = static_cast<ULONGLONG>(IndexNumber.QuadPart);
     }
 
-    return Result;
+    Metadata->ValidFields = Fields;
+    return TRUE;
 }
 
-EXTERN_C BOOL WINAPI MileWriteFile(
-    _In_ HANDLE FileHandle,
-    _In_opt_ LPCVOID Buffer,
-    _In_ DWORD NumberOfBytesToWrite,
-    _Out_opt_ LPDWORD NumberOfBytesWritten)
+namespace
 {
-    BOOL Result = FALSE;
-    DWORD LastError = ERROR_SUCCESS;
-    DWORD NumberOfBytesTransferred = 0;
-    OVERLAPPED Overlapped = {};
-    Overlapped.hEvent = ::CreateEventW(
-        nullptr,
-        TRUE,
-        FALSE,
-        nullptr);
-    if (Overlapped.hEvent)
+    static DWORD ExecuteFileBatchOperation(
+        _In_ HANDLE FileHandle,
+        _In_ PMILE_FILE_BATCH_OPERATION Operation,
+        _Out_ PULONGLONG Value)
     {
-        bool FilePointerAvailable = false;
-        LARGE_INTEGER CurrentFilePointer = {};
+        *Value = 0;
+
+        BOOL Result = FALSE;
+        switch (Operation->Type)
+        {
+        case MILE_FILE_BATCH_OPERATION_GET_SIZE:
+        {
+            Result = ::MileGetFileSizeByHandle(FileHandle, Value);
+            break;
+        }
+        case MILE_FILE_BATCH_OPERATION_GET_ALLOCATION_SIZE:
+        {
+            Result = ::MileGetFileAllocationSizeByHandle(FileHandle, Value);
+            break;
+        }
+        case MILE_FILE_BATCH_OPERATION_GET_COMPRESSED_SIZE:
+        {
+            Result = ::MileGetCompressedFileSizeByHandle(FileHandle, Value);
+            break;
+        }
+        case MILE_FILE_BATCH_OPERATION_GET_ATTRIBUTES:
         {
-            LARGE_INTEGER DistanceToMove = {};
-            if (::SetFilePointerEx(
+            DWORD FileAttributes = 0;
+            Result = ::MileGetFileAttributesByHandle(
                 FileHandle,
-                DistanceToMove,
-                &CurrentFilePointer,
-                FILE_CURRENT))
-            {
-                FilePointerAvailable = true;
+                &FileAttributes);
+            *Value = FileAttributes;
+            break;
+        }
+        case MILE_FILE_BATCH_OPERATION_SET_ATTRIBUTES:
+        {
+            Result = ::MileSetFileAttributesByHandle(
+                FileHandle,
+                Operation->FileAttributes);
+            break;
+        }
+        case MILE_FILE_BATCH_OPERATION_GET_HARDLINK_COUNT:
+        {
+            DWORD HardlinkCount = 0;
+            Result = ::MileGetFileHardlinkCountByHandle(
+                FileHandle,
+                &HardlinkCount);
+            *Value = HardlinkCount;
+            break;
+        }
+        default:
+        {
+            ::SetLastError(ERROR_INVALID_PARAMETER);
+            break;
+        }
+        }
 
-                Overlapped.Offset = CurrentFilePointer.LowPart;
-                Overlapped.OffsetHigh = CurrentFilePointer.HighPart;
-            }
+        return Result ? ERROR_SUCCESS : ::GetLastError();
+    }
+
+    typedef struct _FILE_BATCH_OPERATION_CONTEXT
+    {
+        const HANDLE* FileHandles;
+        const LPCWSTR* FileNames;
+        PMILE_FILE_BATCH_OPERATION Operation;
+        PMILE_FILE_BATCH_RESULT Results;
+    } FILE_BATCH_OPERATION_CONTEXT, *PFILE_BATCH_OPERATION_CONTEXT;
+
+    static void FileBatchOperationItemCallback(
+        _In_ SIZE_T Index,
+        _In_opt_ LPVOID Context)
+    {
+        PFILE_BATCH_OPERATION_CONTEXT BatchContext =
+            reinterpret_cast<PFILE_BATCH_OPERATION_CONTEXT>(Context);
+        PMILE_FILE_BATCH_RESULT Result = &BatchContext->Results[Index];
+
+        if (BatchContext->FileHandles)
+        {
+            Result->Error = ::ExecuteFileBatchOperation(
+                BatchContext->FileHandles[Index],
+                BatchContext->Operation,
+                &Result->Value);
+            return;
         }
 
-        Result = ::WriteFile(
-            FileHandle,
-            Buffer,
-            NumberOfBytesToWrite,
-            &NumberOfBytesTransferred,
-            &Overlapped);
-        if (!Result)
+        Result->Value = 0;
+
+        DWORD DesiredAccess = FILE_READ_ATTRIBUTES;
+        if (MILE_FILE_BATCH_OPERATION_SET_ATTRIBUTES ==
+            BatchContext->Operation->Type)
         {
-            LastError = ::GetLastError();
+            DesiredAccess |= FILE_WRITE_ATTRIBUTES;
+        }
 
-            if (ERROR_IO_PENDING == LastError)
-            {
-                Result = ::GetOverlappedResult(
-                    FileHandle,
-                    &Overlapped,
-                    &NumberOfBytesTransferred,
-                    TRUE);
-                if (!Result)
-                {
-                    LastError = ::GetLastError();
-                }
-            }
+        HANDLE FileHandle = ::MileCreateFile(
+            BatchContext->FileNames[Index],
+            DesiredAccess,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_FLAG_BACKUP_SEMANTICS,
+            nullptr);
+        if (INVALID_HANDLE_VALUE == FileHandle)
+        {
+            Result->Error = ::GetLastError();
+            return;
         }
 
-        if (Result && FilePointerAvailable)
+        Result->Error = ::ExecuteFileBatchOperation(
+            FileHandle,
+            BatchContext->Operation,
+            &Result->Value);
+
+        ::CloseHandle(FileHandle);
+    }
+
+    static BOOL ExecuteFileBatch(
+        _In_ PFILE_BATCH_OPERATION_CONTEXT Context,
+        _In_ SIZE_T Count,
+        _In_ DWORD MaximumConcurrency)
+    {
+        if (!::ParallelFor(
+            Count,
+            MaximumConcurrency,
+            ::FileBatchOperationItemCallback,
+            Context))
         {
-            CurrentFilePointer.QuadPart += NumberOfBytesTransferred;
-            Result = ::SetFilePointerEx(
-                FileHandle,
-                CurrentFilePointer,
-                nullptr,
-                FILE_BEGIN);
-            if (!Result)
+            return FALSE;
+        }
+
+        for (SIZE_T i = 0; i < Count; ++i)
+        {
+            if (ERROR_SUCCESS != Context->Results[i].Error)
             {
-                LastError = ::GetLastError();
+                ::SetLastError(Context->Results[i].Error);
+                return FALSE;
             }
         }
 
-        ::CloseHandle(Overlapped.hEvent);
-    }
-    else
-    {
-        LastError = ERROR_NO_SYSTEM_RESOURCES;
+        return TRUE;
     }
+}
 
-    if (NumberOfBytesWritten)
+EXTERN_C BOOL WINAPI MileBatchFileOperationByHandle(
+    _In_ const HANDLE* FileHandles,
+    _In_ SIZE_T Count,
+    _In_ PMILE_FILE_BATCH_OPERATION Operation,
+    _Out_ PMILE_FILE_BATCH_RESULT Results,
+    _In_ DWORD MaximumConcurrency)
+{
+    if (!Operation || (Count && (!FileHandles || !Results)))
     {
-        *NumberOfBytesWritten = NumberOfBytesTransferred;
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
     }
 
-    if (!Result)
+    FILE_BATCH_OPERATION_CONTEXT Context;
+    Context.FileHandles = FileHandles;
+    Context.FileNames = nullptr;
+    Context.Operation = Operation;
+    Context.Results = Results;
+    return ::ExecuteFileBatch(&Context, Count, MaximumConcurrency);
+}
+
+EXTERN_C BOOL WINAPI MileBatchFileOperation(
+    _In_ const LPCWSTR* FileNames,
+    _In_ SIZE_T Count,
+    _In_ PMILE_FILE_BATCH_OPERATION Operation,
+    _Out_ PMILE_FILE_BATCH_RESULT Results,
+    _In_ DWORD MaximumConcurrency)
+{
+    if (!Operation || (Count && (!FileNames || !Results)))
     {
-        ::SetLastError(LastError);
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
     }
 
-    return Result;
+    FILE_BATCH_OPERATION_CONTEXT Context;
+    Context.FileHandles = nullptr;
+    Context.FileNames = FileNames;
+    Context.Operation = Operation;
+    Context.Results = Results;
+    return ::ExecuteFileBatch(&Context, Count, MaximumConcurrency);
 }
 
 EXTERN_C BOOL WINAPI MileGetNtfsCompressionAttributeByHandle(
@@ -1550,17 +6063,298 @@ EXTERN_C HANDLE WINAPI MileCreateFile(
     }
     else
     {
-        LastError = ERROR_INVALID_PARAMETER;
+        LastError = ERROR_INVALID_PARAMETER;
+    }
+
+    if (INVALID_HANDLE_VALUE == FileHandle)
+    {
+        ::SetLastError(LastError);
+    }
+
+    return FileHandle;
+}
+
+namespace
+{
+    const ULONG NtObjectCaseInsensitive = 0x00000040;
+
+    const ULONG NtFileAttributeValidFlags = 0x00007FA7;
+
+    const ULONG NtFileOpen = 0x00000001;
+    const ULONG NtFileCreate = 0x00000002;
+    const ULONG NtFileOpenIf = 0x00000003;
+    const ULONG NtFileOverwrite = 0x00000004;
+    const ULONG NtFileOverwriteIf = 0x00000005;
+
+    const ULONG_PTR NtFileCreated = 0x00000002;
+
+    const ULONG NtFileWriteThrough = 0x00000002;
+    const ULONG NtFileSequentialOnly = 0x00000004;
+    const ULONG NtFileNoIntermediateBuffering = 0x00000008;
+    const ULONG NtFileSynchronousIoNonAlert = 0x00000020;
+    const ULONG NtFileNonDirectoryFile = 0x00000040;
+    const ULONG NtFileRandomAccess = 0x00000800;
+    const ULONG NtFileDeleteOnClose = 0x00001000;
+    const ULONG NtFileOpenForBackupIntent = 0x00004000;
+    const ULONG NtFileOpenReparsePoint = 0x00200000;
+    const ULONG NtFileOpenNoRecall = 0x00400000;
+
+    typedef struct _NtObjectAttributes
+    {
+        ULONG Length;
+        HANDLE RootDirectory;
+        NtUnicodeStringPointer ObjectName;
+        ULONG Attributes;
+        PVOID SecurityDescriptor;
+        PVOID SecurityQualityOfService;
+    } NtObjectAttributes, * NtObjectAttributesPointer;
+
+    static FARPROC GetNtCreateFileProcAddress()
+    {
+        static FARPROC CachedResult = ([]() -> FARPROC
+        {
+            HMODULE ModuleHandle = ::GetNtDllModuleHandle();
+            if (ModuleHandle)
+            {
+                return ::GetProcAddress(
+                    ModuleHandle,
+                    "NtCreateFile");
+            }
+            return nullptr;
+        }());
+
+        return CachedResult;
+    }
+
+    static NTSTATUS NTAPI NtCreateFileWrapper(
+        _Out_ PHANDLE FileHandle,
+        _In_ ACCESS_MASK DesiredAccess,
+        _In_ NtObjectAttributesPointer ObjectAttributes,
+        _Out_ NtIoStatusBlockPointer IoStatusBlock,
+        _In_opt_ PLARGE_INTEGER AllocationSize,
+        _In_ ULONG FileAttributes,
+        _In_ ULONG ShareAccess,
+        _In_ ULONG CreateDisposition,
+        _In_ ULONG CreateOptions,
+        _In_opt_ PVOID EaBuffer,
+        _In_ ULONG EaLength)
+    {
+        using ProcType = decltype(::NtCreateFileWrapper)*;
+
+        ProcType ProcAddress = reinterpret_cast<ProcType>(
+            ::GetNtCreateFileProcAddress());
+
+        if (ProcAddress)
+        {
+            return ProcAddress(
+                FileHandle,
+                DesiredAccess,
+                ObjectAttributes,
+                IoStatusBlock,
+                AllocationSize,
+                FileAttributes,
+                ShareAccess,
+                CreateDisposition,
+                CreateOptions,
+                EaBuffer,
+                EaLength);
+        }
+
+        return NtStatusNotImplemented;
+    }
+}
+
+EXTERN_C HANDLE WINAPI MileCreateFileRelative(
+    _In_ HANDLE ParentDirectoryHandle,
+    _In_ LPCWSTR FileName,
+    _In_ DWORD DesiredAccess,
+    _In_ DWORD ShareMode,
+    _In_ DWORD CreationDisposition,
+    _In_ DWORD FlagsAndAttributes)
+{
+    if (!ParentDirectoryHandle ||
+        INVALID_HANDLE_VALUE == ParentDirectoryHandle ||
+        !FileName)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    std::size_t FileNameLength = 0;
+    if (S_OK != ::StringCchLengthW(
+        FileName,
+        MAXSHORT / sizeof(wchar_t),
+        &FileNameLength))
+    {
+        ::SetLastError(ERROR_FILENAME_EXCED_RANGE);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    ULONG CreateDisposition = 0;
+    switch (CreationDisposition)
+    {
+    case CREATE_NEW:
+        CreateDisposition = NtFileCreate;
+        break;
+    case CREATE_ALWAYS:
+        CreateDisposition = NtFileOverwriteIf;
+        break;
+    case OPEN_EXISTING:
+        CreateDisposition = NtFileOpen;
+        break;
+    case OPEN_ALWAYS:
+        CreateDisposition = NtFileOpenIf;
+        break;
+    case TRUNCATE_EXISTING:
+        CreateDisposition = NtFileOverwrite;
+        break;
+    default:
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    // Map the flags in the same way as CreateFileW.
+    ULONG CreateOptions = 0;
+    if (!(FlagsAndAttributes & FILE_FLAG_OVERLAPPED))
+    {
+        CreateOptions |= NtFileSynchronousIoNonAlert;
+    }
+    if (FlagsAndAttributes & FILE_FLAG_WRITE_THROUGH)
+    {
+        CreateOptions |= NtFileWriteThrough;
+    }
+    if (FlagsAndAttributes & FILE_FLAG_NO_BUFFERING)
+    {
+        CreateOptions |= NtFileNoIntermediateBuffering;
+    }
+    if (FlagsAndAttributes & FILE_FLAG_RANDOM_ACCESS)
+    {
+        CreateOptions |= NtFileRandomAccess;
+    }
+    if (FlagsAndAttributes & FILE_FLAG_SEQUENTIAL_SCAN)
+    {
+        CreateOptions |= NtFileSequentialOnly;
+    }
+    if (FlagsAndAttributes & FILE_FLAG_DELETE_ON_CLOSE)
+    {
+        CreateOptions |= NtFileDeleteOnClose;
+        DesiredAccess |= DELETE;
+    }
+    if (FlagsAndAttributes & FILE_FLAG_BACKUP_SEMANTICS)
+    {
+        CreateOptions |= NtFileOpenForBackupIntent;
+    }
+    else
+    {
+        CreateOptions |= NtFileNonDirectoryFile;
+    }
+    if (FlagsAndAttributes & FILE_FLAG_OPEN_REPARSE_POINT)
+    {
+        CreateOptions |= NtFileOpenReparsePoint;
+    }
+    if (FlagsAndAttributes & FILE_FLAG_OPEN_NO_RECALL)
+    {
+        CreateOptions |= NtFileOpenNoRecall;
     }
 
-    if (INVALID_HANDLE_VALUE == FileHandle)
+    NtUnicodeString ObjectName;
+    ObjectName.Length = static_cast<USHORT>(FileNameLength * sizeof(wchar_t));
+    ObjectName.MaximumLength = ObjectName.Length;
+    ObjectName.Buffer = const_cast<PWCH>(FileName);
+
+    NtObjectAttributes ObjectAttributes = {};
+    ObjectAttributes.Length = sizeof(NtObjectAttributes);
+    ObjectAttributes.RootDirectory = ParentDirectoryHandle;
+    ObjectAttributes.ObjectName = &ObjectName;
+    if (!(FlagsAndAttributes & FILE_FLAG_POSIX_SEMANTICS))
     {
-        ::SetLastError(LastError);
+        ObjectAttributes.Attributes = NtObjectCaseInsensitive;
+    }
+
+    HANDLE FileHandle = nullptr;
+    NtIoStatusBlock IoStatusBlock = {};
+    NTSTATUS Status = ::NtCreateFileWrapper(
+        &FileHandle,
+        DesiredAccess | SYNCHRONIZE | FILE_READ_ATTRIBUTES,
+        &ObjectAttributes,
+        &IoStatusBlock,
+        nullptr,
+        FlagsAndAttributes & NtFileAttributeValidFlags,
+        ShareMode,
+        CreateDisposition,
+        CreateOptions,
+        nullptr,
+        0);
+    if (!::IsNtStatusSuccess(Status))
+    {
+        ::SetLastError(::RtlNtStatusToDosErrorWrapper(Status));
+        return INVALID_HANDLE_VALUE;
     }
 
+    // Report the existing file in the same way as CreateFileW.
+    ::SetLastError(
+        ((CREATE_ALWAYS == CreationDisposition ||
+            OPEN_ALWAYS == CreationDisposition) &&
+            NtFileCreated != IoStatusBlock.Information)
+        ? ERROR_ALREADY_EXISTS
+        : ERROR_SUCCESS);
+
     return FileHandle;
 }
 
+EXTERN_C HANDLE WINAPI MileOpenFileById(
+    _In_ HANDLE VolumeHandle,
+    _In_ ULONGLONG FileId,
+    _In_ DWORD DesiredAccess,
+    _In_ DWORD ShareMode,
+    _In_ DWORD FlagsAndAttributes)
+{
+    FILE_ID_DESCRIPTOR FileIdDescriptor = {};
+    FileIdDescriptor.dwSize = sizeof(FILE_ID_DESCRIPTOR);
+    FileIdDescriptor.Type = FILE_ID_TYPE::FileIdType;
+    FileIdDescriptor.FileId.QuadPart = static_cast<LONGLONG>(FileId);
+
+    return ::OpenFileById(
+        VolumeHandle,
+        &FileIdDescriptor,
+        DesiredAccess,
+        ShareMode,
+        nullptr,
+        FlagsAndAttributes);
+}
+
+EXTERN_C DWORD WINAPI MileGetFilePathById(
+    _In_ HANDLE VolumeHandle,
+    _In_ ULONGLONG FileId,
+    _Out_writes_opt_(FilePathLength) LPWSTR FilePath,
+    _In_ DWORD FilePathLength,
+    _In_ DWORD Flags)
+{
+    HANDLE FileHandle = ::MileOpenFileById(
+        VolumeHandle,
+        FileId,
+        FILE_READ_ATTRIBUTES,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        FILE_FLAG_BACKUP_SEMANTICS);
+    if (INVALID_HANDLE_VALUE == FileHandle)
+    {
+        return 0;
+    }
+
+    DWORD Result = ::GetFinalPathNameByHandleW(
+        FileHandle,
+        FilePath,
+        FilePathLength,
+        Flags);
+    DWORD LastError = ::GetLastError();
+
+    ::CloseHandle(FileHandle);
+
+    ::SetLastError(LastError);
+
+    return Result;
+}
+
 EXTERN_C BOOL WINAPI MileDeleteFileIgnoreReadonlyAttribute(
     _In_ LPCWSTR FileName)
 {
@@ -1655,10 +6449,450 @@ EXTERN_C BOOL WINAPI MileCreateDirectory(
     return Result;
 }
 
-EXTERN_C BOOL WINAPI MileSocketRecv(
+struct _MILE_IO_ENGINE
+{
+    HANDLE CompletionPort;
+    DWORD NumberOfWorkerThreads;
+    HANDLE WorkerThreads[ANYSIZE_ARRAY];
+};
+
+namespace
+{
+    const ULONG_PTR IoEngineStopKey = static_cast<ULONG_PTR>(-1);
+
+    typedef struct _IO_ENGINE_OPERATION
+    {
+        OVERLAPPED Overlapped;
+        HANDLE Handle;
+        MILE_IO_COMPLETION_CALLBACK_TYPE Callback;
+        LPVOID Context;
+        DWORD Flags;
+    } IO_ENGINE_OPERATION, *PIO_ENGINE_OPERATION;
+
+    static PIO_ENGINE_OPERATION AllocateIoEngineOperation(
+        _In_ PMILE_IO_ENGINE Engine,
+        _In_ HANDLE Handle,
+        _In_ ULONGLONG Offset,
+        _In_ MILE_IO_COMPLETION_CALLBACK_TYPE Callback,
+        _In_opt_ LPVOID Context)
+    {
+        if (!Engine || !Callback)
+        {
+            ::SetLastError(ERROR_INVALID_PARAMETER);
+            return nullptr;
+        }
+
+        PIO_ENGINE_OPERATION Operation = reinterpret_cast<PIO_ENGINE_OPERATION>(
+            ::MileAllocateMemory(sizeof(IO_ENGINE_OPERATION)));
+        if (!Operation)
+        {
+            ::SetLastError(ERROR_OUTOFMEMORY);
+            return nullptr;
+        }
+
+        Operation->Overlapped.Offset = static_cast<DWORD>(Offset);
+        Operation->Overlapped.OffsetHigh = static_cast<DWORD>(Offset >> 32);
+        Operation->Handle = Handle;
+        Operation->Callback = Callback;
+        Operation->Context = Context;
+
+        return Operation;
+    }
+
+    static BOOL CompleteIoEngineSubmission(
+        _In_ PIO_ENGINE_OPERATION Operation,
+        _In_ BOOL Result,
+        _In_ DWORD LastError)
+    {
+        // The completion packet will be queued if the operation succeeded
+        // immediately or is pending, otherwise nothing will be queued.
+        if (Result || ERROR_IO_PENDING == LastError)
+        {
+            return TRUE;
+        }
+
+        ::MileFreeMemory(Operation);
+        ::SetLastError(LastError);
+        return FALSE;
+    }
+
+    static DWORD WINAPI IoEngineWorkerThreadRoutine(
+        _In_ LPVOID lpThreadParameter)
+    {
+        PMILE_IO_ENGINE Engine = reinterpret_cast<PMILE_IO_ENGINE>(
+            lpThreadParameter);
+
+        const ULONG MaximumEntries = 64;
+        OVERLAPPED_ENTRY Entries[MaximumEntries];
+
+        for (;;)
+        {
+            ULONG NumberOfEntries = 0;
+            if (!::GetQueuedCompletionStatusEx(
+                Engine->CompletionPort,
+                Entries,
+                MaximumEntries,
+                &NumberOfEntries,
+                INFINITE,
+                FALSE))
+            {
+                // The completion port has been closed or is no longer
+                // usable, and the wait never times out.
+                break;
+            }
+
+            ULONG NumberOfStopRequests = 0;
+
+            for (ULONG i = 0; i < NumberOfEntries; ++i)
+            {
+                if (!Entries[i].lpOverlapped)
+                {
+                    if (IoEngineStopKey == Entries[i].lpCompletionKey)
+                    {
+                        ++NumberOfStopRequests;
+                    }
+                    continue;
+                }
+
+                PIO_ENGINE_OPERATION Operation =
+                    reinterpret_cast<PIO_ENGINE_OPERATION>(
+                        Entries[i].lpOverlapped);
+
+                DWORD NumberOfBytesTransferred = 0;
+                DWORD Error = ERROR_SUCCESS;
+                if (!::GetOverlappedResult(
+                    Operation->Handle,
+                    &Operation->Overlapped,
+                    &NumberOfBytesTransferred,
+                    FALSE))
+                {
+                    Error = ::GetLastError();
+                }
+
+                Operation->Callback(
+                    Error,
+                    NumberOfBytesTransferred,
+                    Operation->Context);
+
+                ::MileFreeMemory(Operation);
+            }
+
+            if (NumberOfStopRequests)
+            {
+                // Each worker only consumes one stop request, so give the
+                // other stop requests dequeued in the same batch back to the
+                // other workers.
+                while (--NumberOfStopRequests)
+                {
+                    ::PostQueuedCompletionStatus(
+                        Engine->CompletionPort,
+                        0,
+                        IoEngineStopKey,
+                        nullptr);
+                }
+                break;
+            }
+        }
+
+        return 0;
+    }
+}
+
+EXTERN_C PMILE_IO_ENGINE WINAPI MileCreateIoEngine(
+    _In_ DWORD NumberOfWorkerThreads)
+{
+    if (!NumberOfWorkerThreads)
+    {
+        NumberOfWorkerThreads = ::MileGetNumberOfHardwareThreads();
+    }
+
+    PMILE_IO_ENGINE Engine = reinterpret_cast<PMILE_IO_ENGINE>(
+        ::MileAllocateMemory(
+            sizeof(MILE_IO_ENGINE) +
+            sizeof(HANDLE) * (NumberOfWorkerThreads - ANYSIZE_ARRAY)));
+    if (!Engine)
+    {
+        ::SetLastError(ERROR_OUTOFMEMORY);
+        return nullptr;
+    }
+
+    Engine->CompletionPort = ::CreateIoCompletionPort(
+        INVALID_HANDLE_VALUE,
+        nullptr,
+        0,
+        NumberOfWorkerThreads);
+    if (!Engine->CompletionPort)
+    {
+        DWORD LastError = ::GetLastError();
+        ::MileFreeMemory(Engine);
+        ::SetLastError(LastError);
+        return nullptr;
+    }
+
+    for (DWORD i = 0; i < NumberOfWorkerThreads; ++i)
+    {
+        HANDLE WorkerThread = ::MileCreateThread(
+            nullptr,
+            0,
+            ::IoEngineWorkerThreadRoutine,
+            Engine,
+            0,
+            nullptr);
+        if (!WorkerThread)
+        {
+            DWORD LastError = ::GetLastError();
+            ::MileCloseIoEngine(Engine);
+            ::SetLastError(LastError);
+            return nullptr;
+        }
+
+        Engine->WorkerThreads[Engine->NumberOfWorkerThreads++] = WorkerThread;
+    }
+
+    return Engine;
+}
+
+EXTERN_C VOID WINAPI MileCloseIoEngine(
+    _In_ PMILE_IO_ENGINE Engine)
+{
+    if (!Engine)
+    {
+        return;
+    }
+
+    for (DWORD i = 0; i < Engine->NumberOfWorkerThreads; ++i)
+    {
+        ::PostQueuedCompletionStatus(
+            Engine->CompletionPort,
+            0,
+            IoEngineStopKey,
+            nullptr);
+    }
+
+    for (DWORD i = 0; i < Engine->NumberOfWorkerThreads; ++i)
+    {
+        ::WaitForSingleObject(Engine->WorkerThreads[i], INFINITE);
+        ::CloseHandle(Engine->WorkerThreads[i]);
+    }
+
+    ::CloseHandle(Engine->CompletionPort);
+
+    ::MileFreeMemory(Engine);
+}
+
+EXTERN_C BOOL WINAPI MileIoEngineBindHandle(
+    _In_ PMILE_IO_ENGINE Engine,
+    _In_ HANDLE FileHandle)
+{
+    if (!Engine)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if (Engine->CompletionPort != ::CreateIoCompletionPort(
+        FileHandle,
+        Engine->CompletionPort,
+        0,
+        0))
+    {
+        return FALSE;
+    }
+
+    // The completion is always retrieved from the completion port, so there
+    // is no need to signal the handle when the operation is completed.
+    ::SetFileCompletionNotificationModes(
+        FileHandle,
+        FILE_SKIP_SET_EVENT_ON_HANDLE);
+
+    return TRUE;
+}
+
+EXTERN_C BOOL WINAPI MileIoEngineSubmitRead(
+    _In_ PMILE_IO_ENGINE Engine,
+    _In_ HANDLE FileHandle,
+    _Out_opt_ LPVOID Buffer,
+    _In_ DWORD NumberOfBytesToRead,
+    _In_ ULONGLONG Offset,
+    _In_ MILE_IO_COMPLETION_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context)
+{
+    PIO_ENGINE_OPERATION Operation = ::AllocateIoEngineOperation(
+        Engine,
+        FileHandle,
+        Offset,
+        Callback,
+        Context);
+    if (!Operation)
+    {
+        return FALSE;
+    }
+
+    BOOL Result = ::ReadFile(
+        FileHandle,
+        Buffer,
+        NumberOfBytesToRead,
+        nullptr,
+        &Operation->Overlapped);
+    return ::CompleteIoEngineSubmission(
+        Operation,
+        Result,
+        Result ? ERROR_SUCCESS : ::GetLastError());
+}
+
+EXTERN_C BOOL WINAPI MileIoEngineSubmitWrite(
+    _In_ PMILE_IO_ENGINE Engine,
+    _In_ HANDLE FileHandle,
+    _In_opt_ LPCVOID Buffer,
+    _In_ DWORD NumberOfBytesToWrite,
+    _In_ ULONGLONG Offset,
+    _In_ MILE_IO_COMPLETION_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context)
+{
+    PIO_ENGINE_OPERATION Operation = ::AllocateIoEngineOperation(
+        Engine,
+        FileHandle,
+        Offset,
+        Callback,
+        Context);
+    if (!Operation)
+    {
+        return FALSE;
+    }
+
+    BOOL Result = ::WriteFile(
+        FileHandle,
+        Buffer,
+        NumberOfBytesToWrite,
+        nullptr,
+        &Operation->Overlapped);
+    return ::CompleteIoEngineSubmission(
+        Operation,
+        Result,
+        Result ? ERROR_SUCCESS : ::GetLastError());
+}
+
+EXTERN_C BOOL WINAPI MileIoEngineSubmitDeviceIoControl(
+    _In_ PMILE_IO_ENGINE Engine,
+    _In_ HANDLE DeviceHandle,
+    _In_ DWORD IoControlCode,
+    _In_opt_ LPVOID InputBuffer,
+    _In_ DWORD InputBufferSize,
+    _Out_opt_ LPVOID OutputBuffer,
+    _In_ DWORD OutputBufferSize,
+    _In_ MILE_IO_COMPLETION_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context)
+{
+    PIO_ENGINE_OPERATION Operation = ::AllocateIoEngineOperation(
+        Engine,
+        DeviceHandle,
+        0,
+        Callback,
+        Context);
+    if (!Operation)
+    {
+        return FALSE;
+    }
+
+    BOOL Result = ::DeviceIoControl(
+        DeviceHandle,
+        IoControlCode,
+        InputBuffer,
+        InputBufferSize,
+        OutputBuffer,
+        OutputBufferSize,
+        nullptr,
+        &Operation->Overlapped);
+    return ::CompleteIoEngineSubmission(
+        Operation,
+        Result,
+        Result ? ERROR_SUCCESS : ::GetLastError());
+}
+
+EXTERN_C BOOL WINAPI MileIoEngineSubmitSocketRecv(
+    _In_ PMILE_IO_ENGINE Engine,
     _In_ SOCKET SocketHandle,
     _Out_opt_ LPVOID Buffer,
     _In_ DWORD NumberOfBytesToRecv,
+    _In_ DWORD Flags,
+    _In_ MILE_IO_COMPLETION_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context)
+{
+    PIO_ENGINE_OPERATION Operation = ::AllocateIoEngineOperation(
+        Engine,
+        reinterpret_cast<HANDLE>(SocketHandle),
+        0,
+        Callback,
+        Context);
+    if (!Operation)
+    {
+        ::WSASetLastError(static_cast<int>(::GetLastError()));
+        return FALSE;
+    }
+    Operation->Flags = Flags;
+
+    WSABUF WSABuffer;
+    WSABuffer.len = static_cast<ULONG>(NumberOfBytesToRecv);
+    WSABuffer.buf = reinterpret_cast<char*>(Buffer);
+
+    BOOL Result = (SOCKET_ERROR != ::WSARecv(
+        SocketHandle,
+        &WSABuffer,
+        1,
+        nullptr,
+        &Operation->Flags,
+        &Operation->Overlapped,
+        nullptr));
+    return ::CompleteIoEngineSubmission(
+        Operation,
+        Result,
+        Result ? ERROR_SUCCESS : ::WSAGetLastError());
+}
+
+EXTERN_C BOOL WINAPI MileIoEngineSubmitSocketSend(
+    _In_ PMILE_IO_ENGINE Engine,
+    _In_ SOCKET SocketHandle,
+    _In_opt_ LPCVOID Buffer,
+    _In_ DWORD NumberOfBytesToSend,
+    _In_ DWORD Flags,
+    _In_ MILE_IO_COMPLETION_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context)
+{
+    PIO_ENGINE_OPERATION Operation = ::AllocateIoEngineOperation(
+        Engine,
+        reinterpret_cast<HANDLE>(SocketHandle),
+        0,
+        Callback,
+        Context);
+    if (!Operation)
+    {
+        ::WSASetLastError(static_cast<int>(::GetLastError()));
+        return FALSE;
+    }
+
+    WSABUF WSABuffer;
+    WSABuffer.len = static_cast<ULONG>(NumberOfBytesToSend);
+    WSABuffer.buf = const_cast<char*>(
+        reinterpret_cast<const char*>(Buffer));
+
+    BOOL Result = (SOCKET_ERROR != ::WSASend(
+        SocketHandle,
+        &WSABuffer,
+        1,
+        nullptr,
+        Flags,
+        &Operation->Overlapped,
+        nullptr));
+    return ::CompleteIoEngineSubmission(
+        Operation,
+        Result,
+        Result ? ERROR_SUCCESS : ::WSAGetLastError());
+}
+
+EXTERN_C BOOL WINAPI MileSocketRecvV(
+    _In_ SOCKET SocketHandle,
+    _In_ LPWSABUF Buffers,
+    _In_ DWORD BufferCount,
     _Out_opt_ LPDWORD NumberOfBytesRecvd,
     _Inout_ LPDWORD Flags)
 {
@@ -1666,22 +6900,13 @@ EXTERN_C BOOL WINAPI MileSocketRecv(
     int LastError = 0;
     DWORD NumberOfBytesTransferred = 0;
     OVERLAPPED Overlapped = {};
-    Overlapped.hEvent = ::CreateEventW(
-        nullptr,
-        TRUE,
-        FALSE,
-        nullptr);
+    Overlapped.hEvent = ::AcquireOverlappedEvent();
     if (Overlapped.hEvent)
     {
-        WSABUF WSABuffer;
-        WSABuffer.len = static_cast<ULONG>(NumberOfBytesToRecv);
-        WSABuffer.buf = const_cast<char*>(
-            reinterpret_cast<const char*>(Buffer));
-
         Result = (SOCKET_ERROR != ::WSARecv(
             SocketHandle,
-            &WSABuffer,
-            1,
+            Buffers,
+            BufferCount,
             &NumberOfBytesTransferred,
             Flags,
             &Overlapped,
@@ -1705,7 +6930,7 @@ EXTERN_C BOOL WINAPI MileSocketRecv(
             }
         }
 
-        ::CloseHandle(Overlapped.hEvent);
+        ::ReleaseOverlappedEvent(Overlapped.hEvent);
     }
     else
     {
@@ -1725,10 +6950,29 @@ EXTERN_C BOOL WINAPI MileSocketRecv(
     return Result;
 }
 
-EXTERN_C BOOL WINAPI MileSocketSend(
+EXTERN_C BOOL WINAPI MileSocketRecv(
     _In_ SOCKET SocketHandle,
-    _In_opt_ LPCVOID Buffer,
-    _In_ DWORD NumberOfBytesToSend,
+    _Out_opt_ LPVOID Buffer,
+    _In_ DWORD NumberOfBytesToRecv,
+    _Out_opt_ LPDWORD NumberOfBytesRecvd,
+    _Inout_ LPDWORD Flags)
+{
+    WSABUF WSABuffer;
+    WSABuffer.len = static_cast<ULONG>(NumberOfBytesToRecv);
+    WSABuffer.buf = reinterpret_cast<char*>(Buffer);
+
+    return ::MileSocketRecvV(
+        SocketHandle,
+        &WSABuffer,
+        1,
+        NumberOfBytesRecvd,
+        Flags);
+}
+
+EXTERN_C BOOL WINAPI MileSocketSendV(
+    _In_ SOCKET SocketHandle,
+    _In_ LPWSABUF Buffers,
+    _In_ DWORD BufferCount,
     _Out_opt_ LPDWORD NumberOfBytesSent,
     _In_ DWORD Flags)
 {
@@ -1736,22 +6980,13 @@ EXTERN_C BOOL WINAPI MileSocketSend(
     int LastError = 0;
     DWORD NumberOfBytesTransferred = 0;
     OVERLAPPED Overlapped = {};
-    Overlapped.hEvent = ::CreateEventW(
-        nullptr,
-        TRUE,
-        FALSE,
-        nullptr);
+    Overlapped.hEvent = ::AcquireOverlappedEvent();
     if (Overlapped.hEvent)
     {
-        WSABUF WSABuffer;
-        WSABuffer.len = static_cast<ULONG>(NumberOfBytesToSend);
-        WSABuffer.buf = const_cast<char*>(
-            reinterpret_cast<const char*>(Buffer));
-
         Result = (SOCKET_ERROR != ::WSASend(
             SocketHandle,
-            &WSABuffer,
-            1,
+            Buffers,
+            BufferCount,
             &NumberOfBytesTransferred,
             Flags,
             &Overlapped,
@@ -1775,7 +7010,7 @@ EXTERN_C BOOL WINAPI MileSocketSend(
             }
         }
 
-        ::CloseHandle(Overlapped.hEvent);
+        ::ReleaseOverlappedEvent(Overlapped.hEvent);
     }
     else
     {
@@ -1794,3 +7029,23 @@ EXTERN_C BOOL WINAPI MileSocketSend(
 
     return Result;
 }
+
+EXTERN_C BOOL WINAPI MileSocketSend(
+    _In_ SOCKET SocketHandle,
+    _In_opt_ LPCVOID Buffer,
+    _In_ DWORD NumberOfBytesToSend,
+    _Out_opt_ LPDWORD NumberOfBytesSent,
+    _In_ DWORD Flags)
+{
+    WSABUF WSABuffer;
+    WSABuffer.len = static_cast<ULONG>(NumberOfBytesToSend);
+    WSABuffer.buf = const_cast<char*>(
+        reinterpret_cast<const char*>(Buffer));
+
+    return ::MileSocketSendV(
+        SocketHandle,
+        &WSABuffer,
+        1,
+        NumberOfBytesSent,
+        Flags);
+}
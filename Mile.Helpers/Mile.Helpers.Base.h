@@ -14,6 +14,7 @@
 #define MILE_WINDOWS_HELPERS_BASE
 
 #include <Windows.h>
+#include <winioctl.h>
 
 /**
  * @brief Allocates a block of memory from the default heap of the calling
@@ -60,6 +61,42 @@ EXTERN_C LPVOID WINAPI MileReallocateMemory(
 EXTERN_C BOOL WINAPI MileFreeMemory(
     _In_ LPVOID Block);
 
+/**
+ * @brief Allocates a block of memory aligned to the allocation granularity of
+ *        the system, which satisfies the buffer alignment requirement of the
+ *        unbuffered I/O. The allocated memory will be initialized to zero.
+ * @param Size The number of bytes to be allocated.
+ * @return If the function succeeds, the return value is a pointer to the
+ *         allocated memory block. If the function fails, the return value is
+ *         nullptr. To get extended error information, call GetLastError.
+ * @remark For more information, see VirtualAlloc.
+*/
+EXTERN_C LPVOID WINAPI MileAllocateAlignedMemory(
+    _In_ SIZE_T Size);
+
+/**
+ * @brief Frees a memory block allocated by the MileAllocateAlignedMemory
+ *        function.
+ * @param Block A pointer to the memory block to be freed.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileFreeAlignedMemory(
+    _In_ LPVOID Block);
+
+/**
+ * @brief Determines whether all bytes of the specified memory block are zero.
+ *        The memory block is scanned with SIMD instructions if available.
+ * @param Buffer A pointer to the memory block.
+ * @param Size The size in bytes of the memory block.
+ * @return If all bytes of the memory block are zero, the return value is
+ *         nonzero. Otherwise, the return value is zero.
+*/
+EXTERN_C BOOL WINAPI MileIsZeroMemory(
+    _In_ LPCVOID Buffer,
+    _In_ SIZE_T Size);
+
 /**
  * @brief Returns version information about the currently running operating
  *        system.
@@ -307,6 +344,310 @@ EXTERN_C BOOL WINAPI MileEnumerateFileByHandle(
     _In_ MILE_ENUMERATE_FILE_CALLBACK_TYPE Callback,
     _In_opt_ LPVOID Context);
 
+/**
+ * @brief The information classes used by the file enumerator.
+*/
+typedef enum _MILE_FILE_ENUMERATE_INFORMATION_CLASS
+{
+    /**
+     * @brief The information is FILE_ID_BOTH_DIR_INFO, which contains the
+     *        8.3 short name and the 64-bit file ID.
+    */
+    MILE_FILE_ENUMERATE_ID_BOTH_DIRECTORY_INFORMATION = 0,
+
+    /**
+     * @brief The information is FILE_FULL_DIR_INFO, which contains the
+     *        timestamps, sizes and attributes.
+    */
+    MILE_FILE_ENUMERATE_FULL_DIRECTORY_INFORMATION = 1,
+
+    /**
+     * @brief The information is FILE_ID_EXTD_DIR_INFO, which contains the
+     *        128-bit file ID and the reparse point tag.
+    */
+    MILE_FILE_ENUMERATE_ID_EXTD_DIRECTORY_INFORMATION = 2,
+
+    /**
+     * @brief The information is FILE_NAMES_INFORMATION, which only contains
+     *        the file name.
+    */
+    MILE_FILE_ENUMERATE_NAMES_INFORMATION = 3,
+
+} MILE_FILE_ENUMERATE_INFORMATION_CLASS, *PMILE_FILE_ENUMERATE_INFORMATION_CLASS;
+
+/**
+ * @brief The timestamps, sizes and attributes are required in the file
+ *        enumeration.
+*/
+#define MILE_FILE_ENUMERATE_FIELD_BASIC 0x00000001
+
+/**
+ * @brief The file ID is required in the file enumeration.
+*/
+#define MILE_FILE_ENUMERATE_FIELD_FILE_ID 0x00000002
+
+/**
+ * @brief The 8.3 short name is required in the file enumeration.
+*/
+#define MILE_FILE_ENUMERATE_FIELD_SHORT_NAME 0x00000004
+
+/**
+ * @brief All fields are required in the file enumeration.
+*/
+#define MILE_FILE_ENUMERATE_FIELD_ALL 0x00000007
+
+/**
+ * @brief Fetch the next enumeration buffer in the background while the
+ *        callback processes the current one, which overlaps the latency of
+ *        the file system with the processing. The callback is always called
+ *        on the calling thread.
+*/
+#define MILE_FILE_ENUMERATE_FLAG_DOUBLE_BUFFERED 0x00010000
+
+/**
+ * @brief The lightweight view of a found file or directory queried from the
+ *        file enumerator, which points into the enumeration buffer without
+ *        copying. The view is only valid during the callback.
+*/
+typedef struct _MILE_FILE_ENUMERATE_VIEW
+{
+    MILE_FILE_ENUMERATE_INFORMATION_CLASS InformationClass;
+    PVOID Information;
+    LPCWSTR FileName;
+    DWORD FileNameLength;
+} MILE_FILE_ENUMERATE_VIEW, *PMILE_FILE_ENUMERATE_VIEW;
+
+/**
+ * @brief The file enumerate view callback type.
+ * @param View The file enumerate view. The FileName member is not null
+ *             terminated, and the FileNameLength member is the length of the
+ *             file name in characters.
+ * @param Context The user context.
+ * @return If the return value is non-zero, the file enumerate will be
+ *         continued. If the return value is zero, the file enumerate
+ *         will be terminated.
+*/
+typedef BOOL(WINAPI* MILE_ENUMERATE_FILE_VIEW_CALLBACK_TYPE)(
+    _In_ PMILE_FILE_ENUMERATE_VIEW View,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief Enumerates files in a directory without copying the information of
+ *        each file, and the file names are not truncated. The information
+ *        class is always MILE_FILE_ENUMERATE_ID_BOTH_DIRECTORY_INFORMATION.
+ * @param FileHandle The handle of the file to be searched a directory for a
+ *                   file or subdirectory with a name. This handle must be
+ *                   opened with the appropriate permissions for the requested
+ *                   change. This handle should not be a pipe handle.
+ * @param Callback The file enumerate view callback.
+ * @param Context The user context.
+ * @return If the function succeeds, the return value is TRUE. If the function
+ *         fails, the return value is FALSE. To get extended error information,
+ *         call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileEnumerateFileViewByHandle(
+    _In_ HANDLE FileHandle,
+    _In_ MILE_ENUMERATE_FILE_VIEW_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief Enumerates files in a directory without copying the information of
+ *        each file, with the lightest information class which contains the
+ *        required fields and the specified buffer size.
+ * @param FileHandle The handle of the file to be searched a directory for a
+ *                   file or subdirectory with a name. This handle must be
+ *                   opened with the appropriate permissions for the requested
+ *                   change. This handle should not be a pipe handle.
+ * @param Fields The required fields, which can be zero or a combination of
+ *               the MILE_FILE_ENUMERATE_FIELD_* values, optionally combined
+ *               with MILE_FILE_ENUMERATE_FLAG_DOUBLE_BUFFERED. Only the file
+ *               names are queried if no field is required. The
+ *               InformationClass member of the view indicates the chosen
+ *               information class.
+ * @param BufferSize The size in bytes of the enumeration buffer, from 4 KiB to
+ *                   1 MiB. A larger buffer reduces the number of system calls
+ *                   for huge directories. If this parameter is zero, 32 KiB
+ *                   will be used.
+ * @param Callback The file enumerate view callback.
+ * @param Context The user context.
+ * @return If the function succeeds, the return value is TRUE. If the function
+ *         fails, the return value is FALSE. To get extended error information,
+ *         call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileEnumerateFileByHandleEx(
+    _In_ HANDLE FileHandle,
+    _In_ DWORD Fields,
+    _In_ SIZE_T BufferSize,
+    _In_ MILE_ENUMERATE_FILE_VIEW_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief The file enumerate batch callback type.
+ * @param Views The array of the file enumerate views decoded from a single
+ *              fill of the enumeration buffer, which is only valid during the
+ *              callback.
+ * @param Count The number of the file enumerate views.
+ * @param Context The user context.
+ * @return If the return value is non-zero, the file enumerate will be
+ *         continued. If the return value is zero, the file enumerate
+ *         will be terminated.
+*/
+typedef BOOL(WINAPI* MILE_ENUMERATE_FILE_BATCH_CALLBACK_TYPE)(
+    _In_ PMILE_FILE_ENUMERATE_VIEW Views,
+    _In_ SIZE_T Count,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief Enumerates files in a directory like MileEnumerateFileByHandleEx,
+ *        but the callback is called once per fill of the enumeration buffer
+ *        with all decoded entries, which amortizes the cost of the callback.
+ * @param FileHandle The handle of the file to be searched a directory for a
+ *                   file or subdirectory with a name. This handle must be
+ *                   opened with the appropriate permissions for the requested
+ *                   change. This handle should not be a pipe handle.
+ * @param Fields The required fields, which can be zero or a combination of
+ *               the MILE_FILE_ENUMERATE_FIELD_* values, optionally combined
+ *               with MILE_FILE_ENUMERATE_FLAG_DOUBLE_BUFFERED.
+ * @param BufferSize The size in bytes of the enumeration buffer, from 4 KiB to
+ *                   1 MiB. If this parameter is zero, 32 KiB will be used.
+ * @param Callback The file enumerate batch callback.
+ * @param Context The user context.
+ * @return If the function succeeds, the return value is TRUE. If the function
+ *         fails, the return value is FALSE. To get extended error information,
+ *         call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileEnumerateFileBatchByHandle(
+    _In_ HANDLE FileHandle,
+    _In_ DWORD Fields,
+    _In_ SIZE_T BufferSize,
+    _In_ MILE_ENUMERATE_FILE_BATCH_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief Descend into the directories which are reparse points, such as the
+ *        junctions and the directory symbolic links, in the directory tree
+ *        walk. The cycles are only bounded by the maximum depth and the
+ *        maximum path length.
+*/
+#define MILE_WALK_DIRECTORY_TREE_FLAG_FOLLOW_REPARSE_POINTS 0x00000001
+
+/**
+ * @brief Do not report the reparse points in the directory tree walk.
+*/
+#define MILE_WALK_DIRECTORY_TREE_FLAG_SKIP_REPARSE_POINTS 0x00000002
+
+/**
+ * @brief Walk the directory tree on the calling thread in the deterministic
+ *        pre-order, which means each directory is reported before its
+ *        subtree, and the subtree is walked before the next sibling.
+*/
+#define MILE_WALK_DIRECTORY_TREE_FLAG_DETERMINISTIC 0x00000004
+
+/**
+ * @brief The action returned from the directory tree walk callback.
+*/
+typedef enum _MILE_WALK_DIRECTORY_TREE_ACTION
+{
+    /**
+     * @brief Continue the walk.
+    */
+    MILE_WALK_DIRECTORY_TREE_CONTINUE = 0,
+
+    /**
+     * @brief Continue the walk, but do not descend into the directory of the
+     *        current entry.
+    */
+    MILE_WALK_DIRECTORY_TREE_SKIP_SUBTREE = 1,
+
+    /**
+     * @brief Terminate the walk.
+    */
+    MILE_WALK_DIRECTORY_TREE_STOP = 2,
+} MILE_WALK_DIRECTORY_TREE_ACTION, *PMILE_WALK_DIRECTORY_TREE_ACTION;
+
+/**
+ * @brief The entry found in the directory tree walk.
+*/
+typedef struct _MILE_WALK_DIRECTORY_TREE_ENTRY
+{
+    /**
+     * @brief The handle of the directory which contains the entry.
+    */
+    HANDLE DirectoryHandle;
+
+    /**
+     * @brief The null-terminated path of the directory which contains the
+     *        entry, relative to the root directory. It is an empty string for
+     *        the entries of the root directory.
+    */
+    LPCWSTR DirectoryPath;
+
+    /**
+     * @brief The depth of the entry, which is zero for the entries of the root
+     *        directory.
+    */
+    DWORD Depth;
+
+    /**
+     * @brief The file attributes of the entry.
+    */
+    DWORD FileAttributes;
+
+    /**
+     * @brief The file enumerate view of the entry.
+    */
+    MILE_FILE_ENUMERATE_VIEW View;
+} MILE_WALK_DIRECTORY_TREE_ENTRY, *PMILE_WALK_DIRECTORY_TREE_ENTRY;
+
+/**
+ * @brief The directory tree walk callback type.
+ * @param Entry The found entry, which is only valid during the callback.
+ * @param Context The user context.
+ * @return The action of the walk after the callback.
+*/
+typedef MILE_WALK_DIRECTORY_TREE_ACTION(
+    WINAPI* MILE_WALK_DIRECTORY_TREE_CALLBACK_TYPE)(
+    _In_ PMILE_WALK_DIRECTORY_TREE_ENTRY Entry,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief Walks a directory tree recursively. The subdirectories are opened
+ *        relative to their parent directories, and are distributed across
+ *        the workers of the system thread pool by work stealing unless
+ *        MILE_WALK_DIRECTORY_TREE_FLAG_DETERMINISTIC is specified. The
+ *        subdirectories which cannot be opened or enumerated, or whose
+ *        relative paths exceed 32767 characters, are skipped.
+ * @param RootDirectoryHandle The handle of the root directory. This handle
+ *                            must be opened with the FILE_LIST_DIRECTORY
+ *                            access right.
+ * @param Flags The flags, which can be zero or a combination of the
+ *              MILE_WALK_DIRECTORY_TREE_FLAG_* values.
+ * @param Fields The required fields, which can be zero or a combination of
+ *               the MILE_FILE_ENUMERATE_FIELD_* values. The
+ *               MILE_FILE_ENUMERATE_FIELD_BASIC value is always implied.
+ * @param MaximumDepth The maximum depth of the entries to be reported. If this
+ *                     parameter is zero, only the entries of the root
+ *                     directory are reported. Use MAXDWORD for no limit.
+ * @param MaximumConcurrency The maximum number of the concurrent workers. If
+ *                           this parameter is zero, the number of hardware
+ *                           threads will be used.
+ * @param Callback The directory tree walk callback, which may be called
+ *                 concurrently from multiple threads unless
+ *                 MILE_WALK_DIRECTORY_TREE_FLAG_DETERMINISTIC is specified.
+ * @param Context The user context.
+ * @return If the function succeeds, the return value is TRUE. If the function
+ *         fails, the return value is FALSE. To get extended error information,
+ *         call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileWalkDirectoryTree(
+    _In_ HANDLE RootDirectoryHandle,
+    _In_ DWORD Flags,
+    _In_ DWORD Fields,
+    _In_ DWORD MaximumDepth,
+    _In_ DWORD MaximumConcurrency,
+    _In_ MILE_WALK_DIRECTORY_TREE_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context);
+
 /**
  * @brief Sends a control code directly to a specified device driver, causing
  *        the corresponding device to perform the corresponding operation.
@@ -526,129 +867,970 @@ EXTERN_C BOOL WINAPI MileWriteFile(
     _Out_opt_ LPDWORD NumberOfBytesWritten);
 
 /**
- * @brief Gets the NTFS compression attribute.
- * @param FileHandle A handle to the file or directory on which the
- *                   operation is to be performed. To retrieve a handle,
- *                   use the CreateFile or a similar API.
- * @param CompressionAlgorithm Specifies the compression algorithm that is
- *                             used to compress this file. Currently defined
- *                             algorithms are:
- *                             COMPRESSION_FORMAT_NONE
- *                                 Uncompress the file or directory.
- *                             COMPRESSION_FORMAT_DEFAULT
- *                                 Compress the file or directory, using the
- *                                 default compression format.
- *                             COMPRESSION_FORMAT_LZNT1
- *                                 Compress the file or directory, using the
- *                                 LZNT1 compression format.
+ * @brief Reads data from the specified file or input/output (I/O) device at
+ *        the specified offset without using or updating the file pointer, so
+ *        multiple threads can read the disjoint ranges of the same handle in
+ *        parallel.
+ * @param FileHandle A handle to the file or I/O device. The FileHandle
+ *                   parameter must have been created with read access. If the
+ *                   handle is not opened with FILE_FLAG_OVERLAPPED, the system
+ *                   still updates the file pointer to the end of the read.
+ * @param Buffer A pointer to the buffer that receives the data read from a file
+ *               or device.
+ * @param NumberOfBytesToRead The maximum number of bytes to be read.
+ * @param Offset The byte offset in the file where the read begins.
+ * @param NumberOfBytesRead A pointer to the variable that receives the number
+ *                          of bytes read.
  * @return If the function succeeds, the return value is nonzero. If the
  *         function fails, the return value is zero. To get extended error
  *         information, call GetLastError.
 */
-EXTERN_C BOOL WINAPI MileGetNtfsCompressionAttributeByHandle(
+EXTERN_C BOOL WINAPI MileReadFileAt(
     _In_ HANDLE FileHandle,
-    _Out_ PUSHORT CompressionAlgorithm);
+    _Out_opt_ LPVOID Buffer,
+    _In_ DWORD NumberOfBytesToRead,
+    _In_ ULONGLONG Offset,
+    _Out_opt_ LPDWORD NumberOfBytesRead);
 
 /**
- * @brief Sets the NTFS compression attribute.
- * @param FileHandle A handle to the file or directory on which the
- *                   operation is to be performed. To retrieve a handle,
- *                   use the CreateFile or a similar API.
- * @param CompressionAlgorithm Specifies the compression algorithm that is
- *                             used to compress this file. Currently defined
- *                             algorithms are:
- *                             COMPRESSION_FORMAT_NONE
- *                                 Uncompress the file or directory.
- *                             COMPRESSION_FORMAT_DEFAULT
- *                                 Compress the file or directory, using the
- *                                 default compression format.
- *                             COMPRESSION_FORMAT_LZNT1
- *                                 Compress the file or directory, using the
- *                                 LZNT1 compression format.
+ * @brief Writes data to the specified file or input/output (I/O) device at
+ *        the specified offset without using or updating the file pointer, so
+ *        multiple threads can write the disjoint ranges of the same handle in
+ *        parallel.
+ * @param FileHandle A handle to the file or I/O device. The FileHandle
+ *                   parameter must have been created with the write access. If
+ *                   the handle is not opened with FILE_FLAG_OVERLAPPED, the
+ *                   system still updates the file pointer to the end of the
+ *                   write.
+ * @param Buffer A pointer to the buffer containing the data to be written to
+ *               the file or device.
+ * @param NumberOfBytesToWrite The number of bytes to be written to the file or
+ *                             device.
+ * @param Offset The byte offset in the file where the write begins.
+ * @param NumberOfBytesWritten A pointer to the variable that receives the
+ *                             number of bytes written.
  * @return If the function succeeds, the return value is nonzero. If the
  *         function fails, the return value is zero. To get extended error
  *         information, call GetLastError.
 */
-EXTERN_C BOOL WINAPI MileSetNtfsCompressionAttributeByHandle(
+EXTERN_C BOOL WINAPI MileWriteFileAt(
     _In_ HANDLE FileHandle,
-    _In_ USHORT CompressionAlgorithm);
+    _In_opt_ LPCVOID Buffer,
+    _In_ DWORD NumberOfBytesToWrite,
+    _In_ ULONGLONG Offset,
+    _Out_opt_ LPDWORD NumberOfBytesWritten);
 
 /**
- * @brief Gets the Windows Overlay Filter file compression attribute.
- * @param FileHandle A handle to the file on which the operation is to be
- *                   performed. To retrieve a handle, use the CreateFile
- *                   or a similar API.
- * @param CompressionAlgorithm Specifies the compression algorithm that is
- *                             used to compress this file. Currently defined
- *                             algorithms are:
- *                             FILE_PROVIDER_COMPRESSION_XPRESS4K
- *                                 Indicates that the data for the file should
- *                                 be compressed in 4kb chunks with the XPress
- *                                 algorithm. This algorithm is designed to be
- *                                 computationally lightweight, and provides
- *                                 for rapid access to data.
- *                             FILE_PROVIDER_COMPRESSION_LZX
- *                                 Indicates that the data for the file should
- *                                 be compressed in 32kb chunks with the LZX
- *                                 algorithm. This algorithm is designed to be
- *                                 highly compact, and provides for small
- *                                 footprint for infrequently accessed data.
- *                             FILE_PROVIDER_COMPRESSION_XPRESS8K
- *                                 Indicates that the data for the file should
- *                                 be compressed in 8kb chunks with the XPress
- *                                 algorithm.
- *                             FILE_PROVIDER_COMPRESSION_XPRESS16K
- *                                 Indicates that the data for the file should
- *                                 be compressed in 16kb chunks with the XPress
- *                                 algorithm.
+ * @brief Reads data from the specified file at the specified offset and
+ *        stores it in an array of buffers.
+ * @param FileHandle A handle to the file. The file handle must be created with
+ *                   the GENERIC_READ right, and the FILE_FLAG_OVERLAPPED and
+ *                   FILE_FLAG_NO_BUFFERING flags.
+ * @param SegmentArray A pointer to an array of FILE_SEGMENT_ELEMENT buffers
+ *                     that receives the data. Each element can receive one
+ *                     page of data, and must be aligned on a system memory
+ *                     page size boundary. The array must contain enough
+ *                     elements to store NumberOfBytesToRead bytes of data,
+ *                     plus one element for a terminating NULL.
+ * @param NumberOfBytesToRead The total number of bytes to be read. It must be
+ *                            a multiple of the sector size of the file system
+ *                            that contains the file.
+ * @param Offset The byte offset in the file where the read begins. It must be
+ *               a multiple of the sector size of the file system that
+ *               contains the file.
+ * @param NumberOfBytesRead A pointer to the variable that receives the number
+ *                          of bytes read.
  * @return If the function succeeds, the return value is nonzero. If the
  *         function fails, the return value is zero. To get extended error
  *         information, call GetLastError.
+ * @remark For more information, see ReadFileScatter.
 */
-EXTERN_C BOOL WINAPI MileGetWofFileCompressionAttributeByHandle(
+EXTERN_C BOOL WINAPI MileReadFileScatter(
     _In_ HANDLE FileHandle,
-    _Out_ PDWORD CompressionAlgorithm);
+    _In_ FILE_SEGMENT_ELEMENT SegmentArray[],
+    _In_ DWORD NumberOfBytesToRead,
+    _In_ ULONGLONG Offset,
+    _Out_opt_ LPDWORD NumberOfBytesRead);
 
 /**
- * @brief Sets the Windows Overlay Filter file compression attribute.
- * @param FileHandle A handle to the file on which the operation is to be
- *                   performed. To retrieve a handle, use the CreateFile
- *                   or a similar API.
- * @param CompressionAlgorithm Specifies the compression algorithm that is
- *                             used to compress this file. Currently defined
- *                             algorithms are:
- *                             FILE_PROVIDER_COMPRESSION_XPRESS4K
- *                                 Indicates that the data for the file should
- *                                 be compressed in 4kb chunks with the XPress
- *                                 algorithm. This algorithm is designed to be
- *                                 computationally lightweight, and provides
- *                                 for rapid access to data.
- *                             FILE_PROVIDER_COMPRESSION_LZX
- *                                 Indicates that the data for the file should
- *                                 be compressed in 32kb chunks with the LZX
- *                                 algorithm. This algorithm is designed to be
- *                                 highly compact, and provides for small
- *                                 footprint for infrequently accessed data.
- *                             FILE_PROVIDER_COMPRESSION_XPRESS8K
- *                                 Indicates that the data for the file should
- *                                 be compressed in 8kb chunks with the XPress
- *                                 algorithm.
- *                             FILE_PROVIDER_COMPRESSION_XPRESS16K
- *                                 Indicates that the data for the file should
- *                                 be compressed in 16kb chunks with the XPress
- *                                 algorithm.
+ * @brief Retrieves data from an array of buffers and writes the data to the
+ *        specified file at the specified offset.
+ * @param FileHandle A handle to the file. The file handle must be created with
+ *                   the GENERIC_WRITE right, and the FILE_FLAG_OVERLAPPED and
+ *                   FILE_FLAG_NO_BUFFERING flags.
+ * @param SegmentArray A pointer to an array of FILE_SEGMENT_ELEMENT buffers
+ *                     that contain the data. Each element contains one page
+ *                     of data, and must be aligned on a system memory page
+ *                     size boundary. The array must contain enough elements
+ *                     to hold NumberOfBytesToWrite bytes of data, plus one
+ *                     element for a terminating NULL.
+ * @param NumberOfBytesToWrite The total number of bytes to be written. It must
+ *                             be a multiple of the sector size of the file
+ *                             system that contains the file.
+ * @param Offset The byte offset in the file where the write begins. It must be
+ *               a multiple of the sector size of the file system that
+ *               contains the file.
+ * @param NumberOfBytesWritten A pointer to the variable that receives the
+ *                             number of bytes written.
  * @return If the function succeeds, the return value is nonzero. If the
  *         function fails, the return value is zero. To get extended error
  *         information, call GetLastError.
+ * @remark For more information, see WriteFileGather.
 */
-EXTERN_C BOOL WINAPI MileSetWofFileCompressionAttributeByHandle(
+EXTERN_C BOOL WINAPI MileWriteFileGather(
     _In_ HANDLE FileHandle,
-    _In_ DWORD CompressionAlgorithm);
+    _In_ FILE_SEGMENT_ELEMENT SegmentArray[],
+    _In_ DWORD NumberOfBytesToWrite,
+    _In_ ULONGLONG Offset,
+    _Out_opt_ LPDWORD NumberOfBytesWritten);
 
 /**
- * @brief Removes the Windows Overlay Filter file compression attribute.
- * @param FileHandle A handle to the file on which the operation is to be
- *                   performed. To retrieve a handle, use the CreateFile
+ * @brief The progress callback type of the large file transfer functions.
+ * @param TotalBytesTransferred The number of bytes transferred so far.
+ * @param TotalBytesToTransfer The total number of bytes to be transferred.
+ * @param Context The user context.
+ * @return Return nonzero to continue the transfer, or zero to cancel it.
+*/
+typedef BOOL(WINAPI* MILE_FILE_TRANSFER_PROGRESS_CALLBACK_TYPE)(
+    _In_ ULONGLONG TotalBytesTransferred,
+    _In_ ULONGLONG TotalBytesToTransfer,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief Reads a range of the specified file which may exceed the 4 GiB limit
+ *        of a single read by splitting it into chunks and keeping multiple
+ *        overlapped requests in flight. The file pointer is not used.
+ * @param FileHandle A handle to the file. The file handle must be created with
+ *                   the read access, and should be created with
+ *                   FILE_FLAG_OVERLAPPED to have multiple requests in flight.
+ * @param Buffer A pointer to the buffer that receives the data read from the
+ *               file.
+ * @param NumberOfBytesToRead The number of bytes to be read.
+ * @param Offset The byte offset in the file where the read begins.
+ * @param ChunkSize The size in bytes of each request. If this parameter is
+ *                  zero, 1 MiB will be used.
+ * @param MaximumOutstandingRequests The maximum number of requests in flight,
+ *                                   which is limited to the number of chunks
+ *                                   in the range. If this parameter is zero,
+ *                                   4 will be used.
+ * @param NumberOfBytesRead A pointer to the variable that receives the number
+ *                          of bytes read. It is less than NumberOfBytesToRead
+ *                          if the end of the file is reached.
+ * @param ProgressCallback The optional progress callback, which is called
+ *                         after each request is completed. The transfer is
+ *                         cancelled with ERROR_CANCELLED if it returns zero.
+ * @param Context The user context passed to the progress callback.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileReadFileFull(
+    _In_ HANDLE FileHandle,
+    _Out_opt_ LPVOID Buffer,
+    _In_ ULONGLONG NumberOfBytesToRead,
+    _In_ ULONGLONG Offset,
+    _In_ DWORD ChunkSize,
+    _In_ DWORD MaximumOutstandingRequests,
+    _Out_opt_ PULONGLONG NumberOfBytesRead,
+    _In_opt_ MILE_FILE_TRANSFER_PROGRESS_CALLBACK_TYPE ProgressCallback,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief Writes a range of the specified file which may exceed the 4 GiB
+ *        limit of a single write by splitting it into chunks and keeping
+ *        multiple overlapped requests in flight. Partial writes are reissued
+ *        until the whole chunk is written. The file pointer is not used.
+ * @param FileHandle A handle to the file. The file handle must be created with
+ *                   the write access, and should be created with
+ *                   FILE_FLAG_OVERLAPPED to have multiple requests in flight.
+ * @param Buffer A pointer to the buffer containing the data to be written to
+ *               the file.
+ * @param NumberOfBytesToWrite The number of bytes to be written.
+ * @param Offset The byte offset in the file where the write begins.
+ * @param ChunkSize The size in bytes of each request. If this parameter is
+ *                  zero, 1 MiB will be used.
+ * @param MaximumOutstandingRequests The maximum number of requests in flight,
+ *                                   which is limited to the number of chunks
+ *                                   in the range. If this parameter is zero,
+ *                                   4 will be used.
+ * @param NumberOfBytesWritten A pointer to the variable that receives the
+ *                             number of bytes written.
+ * @param ProgressCallback The optional progress callback, which is called
+ *                         after each request is completed. The transfer is
+ *                         cancelled with ERROR_CANCELLED if it returns zero.
+ * @param Context The user context passed to the progress callback.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileWriteFileFull(
+    _In_ HANDLE FileHandle,
+    _In_opt_ LPCVOID Buffer,
+    _In_ ULONGLONG NumberOfBytesToWrite,
+    _In_ ULONGLONG Offset,
+    _In_ DWORD ChunkSize,
+    _In_ DWORD MaximumOutstandingRequests,
+    _Out_opt_ PULONGLONG NumberOfBytesWritten,
+    _In_opt_ MILE_FILE_TRANSFER_PROGRESS_CALLBACK_TYPE ProgressCallback,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief The access of the file mapping and the views mapped from it.
+*/
+typedef enum _MILE_FILE_MAPPING_ACCESS
+{
+    /**
+     * @brief The views are read-only.
+    */
+    MILE_FILE_MAPPING_ACCESS_READ_ONLY = 0,
+
+    /**
+     * @brief The views are readable and writable, and the modifications are
+     *        written back to the file.
+    */
+    MILE_FILE_MAPPING_ACCESS_READ_WRITE = 1,
+
+    /**
+     * @brief The views are readable and writable, but the modifications are
+     *        private to the views and never written back to the file.
+    */
+    MILE_FILE_MAPPING_ACCESS_COPY_ON_WRITE = 2
+
+} MILE_FILE_MAPPING_ACCESS, *PMILE_FILE_MAPPING_ACCESS;
+
+/**
+ * @brief The file mapping struct.
+*/
+typedef struct _MILE_FILE_MAPPING
+{
+    HANDLE MappingHandle;
+    MILE_FILE_MAPPING_ACCESS Access;
+    ULONGLONG FileSize;
+} MILE_FILE_MAPPING, *PMILE_FILE_MAPPING;
+
+/**
+ * @brief The file view struct. BaseAddress and MappedSize describe the region
+ *        actually mapped, which is aligned to the allocation granularity, and
+ *        Address and Size describe the requested range.
+*/
+typedef struct _MILE_FILE_VIEW
+{
+    PMILE_FILE_MAPPING Mapping;
+    LPVOID BaseAddress;
+    SIZE_T MappedSize;
+    ULONGLONG Offset;
+    LPVOID Address;
+    SIZE_T Size;
+} MILE_FILE_VIEW, *PMILE_FILE_VIEW;
+
+/**
+ * @brief Creates a file mapping for the whole content of the specified file.
+ * @param FileHandle A handle to the file. The file handle must be created with
+ *                   the read access, and also the write access if Access is
+ *                   MILE_FILE_MAPPING_ACCESS_READ_WRITE. The file handle can be
+ *                   closed after the file mapping is created.
+ * @param Access The access of the file mapping.
+ * @param Mapping The file mapping struct which receives the file mapping.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+ * @remark For more information, see CreateFileMappingW.
+*/
+EXTERN_C BOOL WINAPI MileMapFile(
+    _In_ HANDLE FileHandle,
+    _In_ MILE_FILE_MAPPING_ACCESS Access,
+    _Out_ PMILE_FILE_MAPPING Mapping);
+
+/**
+ * @brief Closes the file mapping. The views mapped from it remain valid until
+ *        they are unmapped.
+ * @param Mapping The file mapping struct.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileUnmapFile(
+    _Inout_ PMILE_FILE_MAPPING Mapping);
+
+/**
+ * @brief Maps a range of the file mapping into the address space of the
+ *        current process.
+ * @param Mapping The file mapping struct, which must outlive the view.
+ * @param Offset The byte offset in the file where the view begins. It does
+ *               not need to be aligned.
+ * @param Size The number of bytes of the view. If this parameter is zero, the
+ *             view extends to the end of the file.
+ * @param View The file view struct which receives the view.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+ * @remark For more information, see MapViewOfFile.
+*/
+EXTERN_C BOOL WINAPI MileMapView(
+    _In_ PMILE_FILE_MAPPING Mapping,
+    _In_ ULONGLONG Offset,
+    _In_ SIZE_T Size,
+    _Out_ PMILE_FILE_VIEW View);
+
+/**
+ * @brief Unmaps the view from the address space of the current process.
+ * @param View The file view struct.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+ * @remark For more information, see UnmapViewOfFile.
+*/
+EXTERN_C BOOL WINAPI MileUnmapView(
+    _Inout_ PMILE_FILE_VIEW View);
+
+/**
+ * @brief Moves the view to another range of the file, which is useful for
+ *        scanning files larger than the address space with a sliding window.
+ *        The view is reused without remapping if the new range is inside the
+ *        region already mapped.
+ * @param View The file view struct.
+ * @param Offset The byte offset in the file where the view begins.
+ * @param Size The number of bytes of the view. If this parameter is zero, the
+ *             view extends to the end of the file.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero and the view is unmapped.
+ *         To get extended error information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileSlideView(
+    _Inout_ PMILE_FILE_VIEW View,
+    _In_ ULONGLONG Offset,
+    _In_ SIZE_T Size);
+
+/**
+ * @brief Hints the system to read a range of the view into memory ahead of
+ *        time with large, concurrent I/O requests.
+ * @param View The file view struct.
+ * @param Offset The byte offset relative to the beginning of the view.
+ * @param Size The number of bytes to prefetch. If this parameter is zero, the
+ *             range extends to the end of the view.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+ * @remark For more information, see PrefetchVirtualMemory.
+*/
+EXTERN_C BOOL WINAPI MilePrefetchView(
+    _In_ PMILE_FILE_VIEW View,
+    _In_ SIZE_T Offset,
+    _In_ SIZE_T Size);
+
+/**
+ * @brief Writes the dirty pages of the view to the file. Call FlushFileBuffers
+ *        on the file handle afterwards to make the data durable.
+ * @param View The file view struct.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+ * @remark For more information, see FlushViewOfFile.
+*/
+EXTERN_C BOOL WINAPI MileFlushView(
+    _In_ PMILE_FILE_VIEW View);
+
+/**
+ * @brief Retrieves the sector size which the offset, size and buffer address
+ *        of the unbuffered I/O on the specified file should be aligned to.
+ * @param FileHandle A handle to the file.
+ * @param SectorSize A pointer to the variable that receives the sector size.
+ *                   It falls back to 4096 if the storage information cannot be
+ *                   queried, which is a safe alignment for all common devices.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileGetFileSectorSize(
+    _In_ HANDLE FileHandle,
+    _Out_ PDWORD SectorSize);
+
+/**
+ * @brief Reads data from the file opened with FILE_FLAG_NO_BUFFERING at the
+ *        specified offset without alignment requirements. The aligned part is
+ *        read into the caller buffer directly if the buffer is aligned, and
+ *        the rest is read through a sector-aligned bounce buffer.
+ * @param FileHandle A handle to the file opened with FILE_FLAG_NO_BUFFERING.
+ * @param Buffer A pointer to the buffer that receives the data.
+ * @param NumberOfBytesToRead The maximum number of bytes to be read.
+ * @param Offset The byte offset in the file where the read begins.
+ * @param NumberOfBytesRead A pointer to the variable that receives the number
+ *                          of bytes read, which is less than
+ *                          NumberOfBytesToRead if the end of the file is
+ *                          reached.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileReadFileUnbufferedAt(
+    _In_ HANDLE FileHandle,
+    _Out_opt_ LPVOID Buffer,
+    _In_ DWORD NumberOfBytesToRead,
+    _In_ ULONGLONG Offset,
+    _Out_opt_ LPDWORD NumberOfBytesRead);
+
+/**
+ * @brief Writes data to the file opened with FILE_FLAG_NO_BUFFERING at the
+ *        specified offset without alignment requirements. The aligned part is
+ *        written from the caller buffer directly if the buffer is aligned, the
+ *        partial sectors are merged with the existing content by
+ *        read-modify-write, and the end of the file is trimmed to the exact
+ *        size if the last sector is padded.
+ * @param FileHandle A handle to the file opened with FILE_FLAG_NO_BUFFERING.
+ *                   The file handle must be created with both the read and
+ *                   write access.
+ * @param Buffer A pointer to the buffer containing the data to be written.
+ * @param NumberOfBytesToWrite The number of bytes to be written.
+ * @param Offset The byte offset in the file where the write begins.
+ * @param NumberOfBytesWritten A pointer to the variable that receives the
+ *                             number of bytes written.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileWriteFileUnbufferedAt(
+    _In_ HANDLE FileHandle,
+    _In_opt_ LPCVOID Buffer,
+    _In_ DWORD NumberOfBytesToWrite,
+    _In_ ULONGLONG Offset,
+    _Out_opt_ LPDWORD NumberOfBytesWritten);
+
+/**
+ * @brief Writes data to the specified file at the specified offset, and the
+ *        all-zero blocks of the data are converted to unallocated ranges
+ *        instead of being written. The file size is extended to the end of
+ *        the write even if the data ends with the all-zero blocks.
+ * @param FileHandle A handle to the file. The file handle must be created with
+ *                   the write access, and the file should be marked as sparse
+ *                   by FSCTL_SET_SPARSE, otherwise the file system still
+ *                   allocates the zeroed ranges.
+ * @param Buffer A pointer to the buffer containing the data to be written to
+ *               the file.
+ * @param NumberOfBytesToWrite The number of bytes to be written to the file.
+ * @param Offset The byte offset in the file where the write begins.
+ * @param BlockSize The size in bytes of the blocks aligned to the file offset
+ *                  which are checked for zeros. If this parameter is zero,
+ *                  64 KiB will be used, which is the sparse allocation unit
+ *                  of NTFS with the default cluster size.
+ * @param NumberOfBytesWritten A pointer to the variable that receives the
+ *                             number of bytes written, including the skipped
+ *                             bytes.
+ * @param NumberOfBytesSkipped A pointer to the variable that receives the
+ *                             number of bytes which are converted to the
+ *                             unallocated ranges instead of being written.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+ * @remark For more information, see FSCTL_SET_ZERO_DATA.
+*/
+EXTERN_C BOOL WINAPI MileWriteFileSparseAt(
+    _In_ HANDLE FileHandle,
+    _In_ LPCVOID Buffer,
+    _In_ DWORD NumberOfBytesToWrite,
+    _In_ ULONGLONG Offset,
+    _In_ DWORD BlockSize,
+    _Out_opt_ LPDWORD NumberOfBytesWritten,
+    _Out_opt_ LPDWORD NumberOfBytesSkipped);
+
+/**
+ * @brief The callback type of MileEnumerateAllocatedRanges.
+ * @param Ranges The batch of the allocated ranges, which are sorted by the
+ *               offset and do not overlap.
+ * @param NumberOfRanges The number of the allocated ranges in the batch.
+ * @param Context The user context.
+ * @return Return nonzero to continue the enumeration, or zero to stop it.
+*/
+typedef BOOL(WINAPI* MILE_ALLOCATED_RANGES_CALLBACK_TYPE)(
+    _In_ PFILE_ALLOCATED_RANGE_BUFFER Ranges,
+    _In_ DWORD NumberOfRanges,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief Enumerates the allocated ranges of the specified file in batches,
+ *        which makes it possible to skip the unallocated ranges of sparse
+ *        files. The whole range is reported as allocated if the file system
+ *        does not support sparse files.
+ * @param FileHandle A handle to the file. The file handle must be created with
+ *                   the read access.
+ * @param Offset The offset in bytes of the range to be enumerated.
+ * @param Length The length in bytes of the range to be enumerated. If this
+ *               parameter is zero, the range extends to the end of the file.
+ * @param Callback The callback which receives the allocated ranges.
+ * @param Context The user context passed to the callback.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError. If the callback stops the
+ *         enumeration, the last error is ERROR_CANCELLED.
+ * @remark For more information, see FSCTL_QUERY_ALLOCATED_RANGES.
+*/
+EXTERN_C BOOL WINAPI MileEnumerateAllocatedRanges(
+    _In_ HANDLE FileHandle,
+    _In_ ULONGLONG Offset,
+    _In_ ULONGLONG Length,
+    _In_ MILE_ALLOCATED_RANGES_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief The copy operation fails if the target file already exists.
+*/
+#define MILE_COPY_FILE_FLAG_FAIL_IF_EXISTS 0x00000001
+
+/**
+ * @brief The copy operation is performed using unbuffered I/O, bypassing the
+ *        system cache, which is recommended for very large files.
+*/
+#define MILE_COPY_FILE_FLAG_UNBUFFERED 0x00000002
+
+/**
+ * @brief Copies the content, attributes and timestamps from the source file
+ *        to the target file. The content is copied by pipelining overlapped
+ *        reads and writes with multiple chunks in flight, and only the
+ *        allocated ranges are copied if the source file is sparse.
+ * @param SourceFileHandle A handle to the source file. The file handle must be
+ *                         created with the read access and should be created
+ *                         with FILE_FLAG_OVERLAPPED.
+ * @param TargetFileHandle A handle to the target file. The file handle must be
+ *                         created with the write access and should be created
+ *                         with FILE_FLAG_OVERLAPPED.
+ * @param Flags The copy flags. If MILE_COPY_FILE_FLAG_UNBUFFERED is specified,
+ *              both handles must be created with FILE_FLAG_NO_BUFFERING.
+ * @param ChunkSize The size in bytes of each chunk. If this parameter is zero,
+ *                  1 MiB will be used.
+ * @param MaximumOutstandingRequests The maximum number of chunks in flight,
+ *                                   which is limited to the number of chunks
+ *                                   in the file. If this parameter is zero, 4
+ *                                   will be used.
+ * @param ProgressCallback The optional progress callback, which is called
+ *                         after each chunk is written. The copy is cancelled
+ *                         with ERROR_CANCELLED if it returns zero.
+ * @param Context The user context passed to the progress callback.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileCopyFileByHandle(
+    _In_ HANDLE SourceFileHandle,
+    _In_ HANDLE TargetFileHandle,
+    _In_ DWORD Flags,
+    _In_ DWORD ChunkSize,
+    _In_ DWORD MaximumOutstandingRequests,
+    _In_opt_ MILE_FILE_TRANSFER_PROGRESS_CALLBACK_TYPE ProgressCallback,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief Copies an existing file to a new file with the content, attributes
+ *        and timestamps. The new file is deleted if the copy fails or is
+ *        cancelled.
+ * @param ExistingFileName The name of the existing file.
+ * @param NewFileName The name of the new file.
+ * @param Flags The copy flags, which can be a combination of
+ *              MILE_COPY_FILE_FLAG_FAIL_IF_EXISTS and
+ *              MILE_COPY_FILE_FLAG_UNBUFFERED.
+ * @param ChunkSize The size in bytes of each chunk. If this parameter is zero,
+ *                  1 MiB will be used.
+ * @param MaximumOutstandingRequests The maximum number of chunks in flight,
+ *                                   which is limited to the number of chunks
+ *                                   in the file. If this parameter is zero, 4
+ *                                   will be used.
+ * @param ProgressCallback The optional progress callback, which is called
+ *                         after each chunk is written. The copy is cancelled
+ *                         with ERROR_CANCELLED if it returns zero.
+ * @param Context The user context passed to the progress callback.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileCopyFileEx(
+    _In_ LPCWSTR ExistingFileName,
+    _In_ LPCWSTR NewFileName,
+    _In_ DWORD Flags,
+    _In_ DWORD ChunkSize,
+    _In_ DWORD MaximumOutstandingRequests,
+    _In_opt_ MILE_FILE_TRANSFER_PROGRESS_CALLBACK_TYPE ProgressCallback,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief The item of the batch file copy operation.
+*/
+typedef struct _MILE_COPY_FILE_ITEM
+{
+    LPCWSTR ExistingFileName;
+    LPCWSTR NewFileName;
+    DWORD Error;
+} MILE_COPY_FILE_ITEM, *PMILE_COPY_FILE_ITEM;
+
+/**
+ * @brief Copies many files concurrently on the system thread pool, which is
+ *        suitable for a large number of small files.
+ * @param Items The array of the copy items. The Error member of each item
+ *              receives the result of the item, ERROR_SUCCESS if succeeded.
+ * @param Count The number of the copy items.
+ * @param Flags The copy flags, which can be a combination of
+ *              MILE_COPY_FILE_FLAG_FAIL_IF_EXISTS and
+ *              MILE_COPY_FILE_FLAG_UNBUFFERED.
+ * @param MaximumConcurrency The maximum number of files copied concurrently.
+ *                           If this parameter is zero, the number of logical
+ *                           processors in the current group will be used.
+ * @return If all items are copied, the return value is nonzero. Otherwise,
+ *         the return value is zero and GetLastError returns the error of the
+ *         first failed item.
+*/
+EXTERN_C BOOL WINAPI MileCopyFiles(
+    _Inout_ PMILE_COPY_FILE_ITEM Items,
+    _In_ SIZE_T Count,
+    _In_ DWORD Flags,
+    _In_ DWORD MaximumConcurrency);
+
+/**
+ * @brief Copies a range of the source file to the target file by cloning the
+ *        extents with the block cloning of the file system, which shares the
+ *        clusters instead of copying the data. The unaligned head and tail of
+ *        the range are copied by bytes, and the whole range is copied by bytes
+ *        if the file system does not support the block cloning.
+ * @param SourceFileHandle A handle to the source file. The file handle must be
+ *                         created with the read access and should not be
+ *                         created with FILE_FLAG_NO_BUFFERING.
+ * @param SourceOffset The byte offset in the source file of the range.
+ * @param TargetFileHandle A handle to the target file on the same volume. The
+ *                         file handle must be created with the write access
+ *                         and should not be created with
+ *                         FILE_FLAG_NO_BUFFERING. The target file is extended
+ *                         to the end of the range if needed.
+ * @param TargetOffset The byte offset in the target file of the range.
+ * @param Length The length in bytes of the range.
+ * @param Cloned A pointer to the variable that receives whether the cluster
+ *               aligned part of the range is cloned. It is zero if the range
+ *               is copied by bytes.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+ * @remark For more information, see FSCTL_DUPLICATE_EXTENTS_TO_FILE.
+*/
+EXTERN_C BOOL WINAPI MileCloneFileRange(
+    _In_ HANDLE SourceFileHandle,
+    _In_ ULONGLONG SourceOffset,
+    _In_ HANDLE TargetFileHandle,
+    _In_ ULONGLONG TargetOffset,
+    _In_ ULONGLONG Length,
+    _Out_opt_ PBOOL Cloned);
+
+/**
+ * @brief Reserves the disk space for the specified file without changing the
+ *        end of the file, which helps the file system to allocate contiguous
+ *        extents for the file which will be written later.
+ * @param FileHandle A handle to the file. The file handle must be created with
+ *                   the GENERIC_WRITE access right.
+ * @param AllocationSize The number of bytes to be reserved for the file.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+ * @remark For more information, see FILE_ALLOCATION_INFO.
+*/
+EXTERN_C BOOL WINAPI MilePreallocateFile(
+    _In_ HANDLE FileHandle,
+    _In_ ULONGLONG AllocationSize);
+
+/**
+ * @brief The timestamps and attributes of the file, which are the
+ *        CreationTime, LastAccessTime, LastWriteTime, ChangeTime and
+ *        FileAttributes members of MILE_FILE_METADATA.
+*/
+#define MILE_FILE_METADATA_FIELD_BASIC 0x00000001
+
+/**
+ * @brief The sizes and link information of the file, which are the FileSize,
+ *        AllocationSize, NumberOfLinks, DeletePending and Directory members of
+ *        MILE_FILE_METADATA.
+*/
+#define MILE_FILE_METADATA_FIELD_STANDARD 0x00000002
+
+/**
+ * @brief The 64-bit file index of the file, which is the FileIndex member of
+ *        MILE_FILE_METADATA.
+*/
+#define MILE_FILE_METADATA_FIELD_INDEX 0x00000004
+
+/**
+ * @brief All fields of MILE_FILE_METADATA.
+*/
+#define MILE_FILE_METADATA_FIELD_ALL 0x00000007
+
+/**
+ * @brief The metadata of a file retrieved by MileQueryFileMetadata.
+*/
+typedef struct _MILE_FILE_METADATA
+{
+    DWORD ValidFields;
+    LARGE_INTEGER CreationTime;
+    LARGE_INTEGER LastAccessTime;
+    LARGE_INTEGER LastWriteTime;
+    LARGE_INTEGER ChangeTime;
+    DWORD FileAttributes;
+    ULONGLONG FileSize;
+    ULONGLONG AllocationSize;
+    DWORD NumberOfLinks;
+    BOOLEAN DeletePending;
+    BOOLEAN Directory;
+    ULONGLONG FileIndex;
+} MILE_FILE_METADATA, *PMILE_FILE_METADATA;
+
+/**
+ * @brief Retrieves the specified metadata of a file with the fewest system
+ *        calls. All requested fields are retrieved in a single system call
+ *        if possible, which is cheaper than calling MileGetFileSizeByHandle,
+ *        MileGetFileAllocationSizeByHandle, MileGetFileHardlinkCountByHandle
+ *        and MileGetFileAttributesByHandle separately.
+ * @param FileHandle A handle to the file that contains the information to be
+ *                   retrieved. This handle should not be a pipe handle.
+ * @param Fields The fields to be retrieved, which can be a combination of the
+ *               MILE_FILE_METADATA_FIELD_* values.
+ * @param Metadata A pointer to the structure that receives the metadata. The
+ *                 ValidFields member receives the retrieved fields, and other
+ *                 members are zero.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileQueryFileMetadata(
+    _In_ HANDLE FileHandle,
+    _In_ DWORD Fields,
+    _Out_ PMILE_FILE_METADATA Metadata);
+
+/**
+ * @brief The types of the operations performed by the batch file operation
+ *        functions.
+*/
+typedef enum _MILE_FILE_BATCH_OPERATION_TYPE
+{
+    /**
+     * @brief Retrieves the file size by MileGetFileSizeByHandle.
+    */
+    MILE_FILE_BATCH_OPERATION_GET_SIZE = 0,
+
+    /**
+     * @brief Retrieves the allocation size by
+     *        MileGetFileAllocationSizeByHandle.
+    */
+    MILE_FILE_BATCH_OPERATION_GET_ALLOCATION_SIZE = 1,
+
+    /**
+     * @brief Retrieves the compressed size by
+     *        MileGetCompressedFileSizeByHandle.
+    */
+    MILE_FILE_BATCH_OPERATION_GET_COMPRESSED_SIZE = 2,
+
+    /**
+     * @brief Retrieves the attributes by MileGetFileAttributesByHandle.
+    */
+    MILE_FILE_BATCH_OPERATION_GET_ATTRIBUTES = 3,
+
+    /**
+     * @brief Sets the attributes by MileSetFileAttributesByHandle.
+    */
+    MILE_FILE_BATCH_OPERATION_SET_ATTRIBUTES = 4,
+
+    /**
+     * @brief Retrieves the hardlink count by
+     *        MileGetFileHardlinkCountByHandle.
+    */
+    MILE_FILE_BATCH_OPERATION_GET_HARDLINK_COUNT = 5,
+
+} MILE_FILE_BATCH_OPERATION_TYPE, *PMILE_FILE_BATCH_OPERATION_TYPE;
+
+/**
+ * @brief The descriptor of the operation performed on every item by the batch
+ *        file operation functions.
+*/
+typedef struct _MILE_FILE_BATCH_OPERATION
+{
+    MILE_FILE_BATCH_OPERATION_TYPE Type;
+    DWORD FileAttributes;
+} MILE_FILE_BATCH_OPERATION, *PMILE_FILE_BATCH_OPERATION;
+
+/**
+ * @brief The result of an item of the batch file operation functions. Error
+ *        is ERROR_SUCCESS if the operation succeeded, and Value receives the
+ *        retrieved value of the query operations.
+*/
+typedef struct _MILE_FILE_BATCH_RESULT
+{
+    DWORD Error;
+    ULONGLONG Value;
+} MILE_FILE_BATCH_RESULT, *PMILE_FILE_BATCH_RESULT;
+
+/**
+ * @brief Performs the same operation on many file handles concurrently on the
+ *        system thread pool.
+ * @param FileHandles The array of the file handles. The file handles must be
+ *                    created with the access rights required by the
+ *                    operation.
+ * @param Count The number of the file handles.
+ * @param Operation The operation to be performed on each file handle.
+ * @param Results The array of Count elements which receives the result of
+ *                each file handle.
+ * @param MaximumConcurrency The maximum number of the operations performed
+ *                           concurrently. If this parameter is zero, the
+ *                           number of logical processors in the current group
+ *                           will be used.
+ * @return If the operation succeeds on all file handles, the return value is
+ *         nonzero. Otherwise, the return value is zero and GetLastError
+ *         returns the error of the first failed item.
+*/
+EXTERN_C BOOL WINAPI MileBatchFileOperationByHandle(
+    _In_ const HANDLE* FileHandles,
+    _In_ SIZE_T Count,
+    _In_ PMILE_FILE_BATCH_OPERATION Operation,
+    _Out_ PMILE_FILE_BATCH_RESULT Results,
+    _In_ DWORD MaximumConcurrency);
+
+/**
+ * @brief Performs the same operation on many files concurrently on the system
+ *        thread pool. Each file is opened with the minimal access rights
+ *        required by the operation and closed after the operation.
+ * @param FileNames The array of the file names.
+ * @param Count The number of the file names.
+ * @param Operation The operation to be performed on each file.
+ * @param Results The array of Count elements which receives the result of
+ *                each file.
+ * @param MaximumConcurrency The maximum number of the operations performed
+ *                           concurrently. If this parameter is zero, the
+ *                           number of logical processors in the current group
+ *                           will be used.
+ * @return If the operation succeeds on all files, the return value is
+ *         nonzero. Otherwise, the return value is zero and GetLastError
+ *         returns the error of the first failed item.
+*/
+EXTERN_C BOOL WINAPI MileBatchFileOperation(
+    _In_ const LPCWSTR* FileNames,
+    _In_ SIZE_T Count,
+    _In_ PMILE_FILE_BATCH_OPERATION Operation,
+    _Out_ PMILE_FILE_BATCH_RESULT Results,
+    _In_ DWORD MaximumConcurrency);
+
+/**
+ * @brief Gets the NTFS compression attribute.
+ * @param FileHandle A handle to the file or directory on which the
+ *                   operation is to be performed. To retrieve a handle,
+ *                   use the CreateFile or a similar API.
+ * @param CompressionAlgorithm Specifies the compression algorithm that is
+ *                             used to compress this file. Currently defined
+ *                             algorithms are:
+ *                             COMPRESSION_FORMAT_NONE
+ *                                 Uncompress the file or directory.
+ *                             COMPRESSION_FORMAT_DEFAULT
+ *                                 Compress the file or directory, using the
+ *                                 default compression format.
+ *                             COMPRESSION_FORMAT_LZNT1
+ *                                 Compress the file or directory, using the
+ *                                 LZNT1 compression format.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileGetNtfsCompressionAttributeByHandle(
+    _In_ HANDLE FileHandle,
+    _Out_ PUSHORT CompressionAlgorithm);
+
+/**
+ * @brief Sets the NTFS compression attribute.
+ * @param FileHandle A handle to the file or directory on which the
+ *                   operation is to be performed. To retrieve a handle,
+ *                   use the CreateFile or a similar API.
+ * @param CompressionAlgorithm Specifies the compression algorithm that is
+ *                             used to compress this file. Currently defined
+ *                             algorithms are:
+ *                             COMPRESSION_FORMAT_NONE
+ *                                 Uncompress the file or directory.
+ *                             COMPRESSION_FORMAT_DEFAULT
+ *                                 Compress the file or directory, using the
+ *                                 default compression format.
+ *                             COMPRESSION_FORMAT_LZNT1
+ *                                 Compress the file or directory, using the
+ *                                 LZNT1 compression format.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileSetNtfsCompressionAttributeByHandle(
+    _In_ HANDLE FileHandle,
+    _In_ USHORT CompressionAlgorithm);
+
+/**
+ * @brief Gets the Windows Overlay Filter file compression attribute.
+ * @param FileHandle A handle to the file on which the operation is to be
+ *                   performed. To retrieve a handle, use the CreateFile
+ *                   or a similar API.
+ * @param CompressionAlgorithm Specifies the compression algorithm that is
+ *                             used to compress this file. Currently defined
+ *                             algorithms are:
+ *                             FILE_PROVIDER_COMPRESSION_XPRESS4K
+ *                                 Indicates that the data for the file should
+ *                                 be compressed in 4kb chunks with the XPress
+ *                                 algorithm. This algorithm is designed to be
+ *                                 computationally lightweight, and provides
+ *                                 for rapid access to data.
+ *                             FILE_PROVIDER_COMPRESSION_LZX
+ *                                 Indicates that the data for the file should
+ *                                 be compressed in 32kb chunks with the LZX
+ *                                 algorithm. This algorithm is designed to be
+ *                                 highly compact, and provides for small
+ *                                 footprint for infrequently accessed data.
+ *                             FILE_PROVIDER_COMPRESSION_XPRESS8K
+ *                                 Indicates that the data for the file should
+ *                                 be compressed in 8kb chunks with the XPress
+ *                                 algorithm.
+ *                             FILE_PROVIDER_COMPRESSION_XPRESS16K
+ *                                 Indicates that the data for the file should
+ *                                 be compressed in 16kb chunks with the XPress
+ *                                 algorithm.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileGetWofFileCompressionAttributeByHandle(
+    _In_ HANDLE FileHandle,
+    _Out_ PDWORD CompressionAlgorithm);
+
+/**
+ * @brief Sets the Windows Overlay Filter file compression attribute.
+ * @param FileHandle A handle to the file on which the operation is to be
+ *                   performed. To retrieve a handle, use the CreateFile
+ *                   or a similar API.
+ * @param CompressionAlgorithm Specifies the compression algorithm that is
+ *                             used to compress this file. Currently defined
+ *                             algorithms are:
+ *                             FILE_PROVIDER_COMPRESSION_XPRESS4K
+ *                                 Indicates that the data for the file should
+ *                                 be compressed in 4kb chunks with the XPress
+ *                                 algorithm. This algorithm is designed to be
+ *                                 computationally lightweight, and provides
+ *                                 for rapid access to data.
+ *                             FILE_PROVIDER_COMPRESSION_LZX
+ *                                 Indicates that the data for the file should
+ *                                 be compressed in 32kb chunks with the LZX
+ *                                 algorithm. This algorithm is designed to be
+ *                                 highly compact, and provides for small
+ *                                 footprint for infrequently accessed data.
+ *                             FILE_PROVIDER_COMPRESSION_XPRESS8K
+ *                                 Indicates that the data for the file should
+ *                                 be compressed in 8kb chunks with the XPress
+ *                                 algorithm.
+ *                             FILE_PROVIDER_COMPRESSION_XPRESS16K
+ *                                 Indicates that the data for the file should
+ *                                 be compressed in 16kb chunks with the XPress
+ *                                 algorithm.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileSetWofFileCompressionAttributeByHandle(
+    _In_ HANDLE FileHandle,
+    _In_ DWORD CompressionAlgorithm);
+
+/**
+ * @brief Removes the Windows Overlay Filter file compression attribute.
+ * @param FileHandle A handle to the file on which the operation is to be
+ *                   performed. To retrieve a handle, use the CreateFile
  *                   or a similar API.
  * @return If the function succeeds, the return value is nonzero. If the
  *         function fails, the return value is zero. To get extended error
@@ -739,6 +1921,90 @@ EXTERN_C HANDLE WINAPI MileCreateFile(
     _In_ DWORD FlagsAndAttributes,
     _In_opt_ HANDLE TemplateFile);
 
+/**
+ * @brief Creates or opens a file or directory relative to an opened parent
+ *        directory, which avoids parsing the full path from the root of the
+ *        volume and keeps the cost of each open independent of the depth.
+ * @param ParentDirectoryHandle The handle of the parent directory, which
+ *                              should be opened with the FILE_TRAVERSE access
+ *                              right.
+ * @param FileName The name of the file or directory to be created or opened,
+ *                 relative to the parent directory. Only backslashes (\\) are
+ *                 accepted as the separator in this name.
+ * @param DesiredAccess The requested access to the file or directory, which
+ *                      can be summarized as read, write, both or neither zero).
+ * @param ShareMode The requested sharing mode of the file or directory.
+ * @param CreationDisposition An action to take on a file or directory that
+ *                            exists or does not exist.
+ * @param FlagsAndAttributes The file or directory attributes and flags, which
+ *                           are interpreted in the same way as CreateFileW.
+ *                           FILE_FLAG_BACKUP_SEMANTICS must be specified to
+ *                           open a directory.
+ * @return If the function succeeds, the return value is an open handle to the
+ *         specified file or directory. If the function fails, the return
+ *         value is INVALID_HANDLE_VALUE. To get extended error information,
+ *         call GetLastError.
+ * @remark For more information, see NtCreateFile.
+*/
+EXTERN_C HANDLE WINAPI MileCreateFileRelative(
+    _In_ HANDLE ParentDirectoryHandle,
+    _In_ LPCWSTR FileName,
+    _In_ DWORD DesiredAccess,
+    _In_ DWORD ShareMode,
+    _In_ DWORD CreationDisposition,
+    _In_ DWORD FlagsAndAttributes);
+
+/**
+ * @brief Opens a file or directory by its 64-bit file ID, which avoids the
+ *        path lookup when revisiting a known file.
+ * @param VolumeHandle The handle of any file or directory on the volume which
+ *                     contains the file to be opened.
+ * @param FileId The 64-bit file ID of the file to be opened, which can be the
+ *               FileId member of MILE_FILE_ENUMERATE_INFORMATION.
+ * @param DesiredAccess The requested access to the file or directory, which
+ *                      can be summarized as read, write, both or neither zero).
+ * @param ShareMode The requested sharing mode of the file or directory.
+ * @param FlagsAndAttributes The file flags. FILE_FLAG_BACKUP_SEMANTICS must be
+ *                           specified to open a directory.
+ * @return If the function succeeds, the return value is an open handle to the
+ *         specified file or directory. If the function fails, the return
+ *         value is INVALID_HANDLE_VALUE. To get extended error information,
+ *         call GetLastError.
+ * @remark For more information, see OpenFileById.
+*/
+EXTERN_C HANDLE WINAPI MileOpenFileById(
+    _In_ HANDLE VolumeHandle,
+    _In_ ULONGLONG FileId,
+    _In_ DWORD DesiredAccess,
+    _In_ DWORD ShareMode,
+    _In_ DWORD FlagsAndAttributes);
+
+/**
+ * @brief Retrieves the path of a file or directory by its 64-bit file ID.
+ * @param VolumeHandle The handle of any file or directory on the volume which
+ *                     contains the file.
+ * @param FileId The 64-bit file ID of the file, which can be the FileId member
+ *               of MILE_FILE_ENUMERATE_INFORMATION.
+ * @param FilePath The buffer that receives the path.
+ * @param FilePathLength The size of the buffer in characters, including the
+ *                       null terminator.
+ * @param Flags The type of the result, which is the same as the dwFlags
+ *              parameter of GetFinalPathNameByHandleW.
+ * @return If the function succeeds, the return value is the length of the
+ *         path in characters, not including the null terminator. If the
+ *         buffer is too small, the return value is the required size of the
+ *         buffer in characters, including the null terminator. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+ * @remark For more information, see GetFinalPathNameByHandleW.
+*/
+EXTERN_C DWORD WINAPI MileGetFilePathById(
+    _In_ HANDLE VolumeHandle,
+    _In_ ULONGLONG FileId,
+    _Out_writes_opt_(FilePathLength) LPWSTR FilePath,
+    _In_ DWORD FilePathLength,
+    _In_ DWORD Flags);
+
 /**
  * @brief Deletes an existing file, even the file have the readonly attribute.
  * @param FileName The name of the file to be deleted. You may use either
@@ -772,8 +2038,251 @@ EXTERN_C BOOL WINAPI MileIsDotsName(
 EXTERN_C BOOL WINAPI MileCreateDirectory(
     _In_ LPCWSTR PathName);
 
+/**
+ * @brief The opaque I/O engine object.
+*/
+typedef struct _MILE_IO_ENGINE MILE_IO_ENGINE, *PMILE_IO_ENGINE;
+
+/**
+ * @brief The I/O completion callback type.
+ * @param Error The Win32 error code of the operation, ERROR_SUCCESS if the
+ *              operation succeeded.
+ * @param NumberOfBytesTransferred The number of bytes transferred.
+ * @param Context The user context.
+*/
+typedef VOID(WINAPI* MILE_IO_COMPLETION_CALLBACK_TYPE)(
+    _In_ DWORD Error,
+    _In_ DWORD NumberOfBytesTransferred,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief Creates an I/O engine which drains the completions from an I/O
+ *        completion port in batches across the worker threads.
+ * @param NumberOfWorkerThreads The number of worker threads. If this parameter
+ *                              is zero, the number of logical processors in the
+ *                              current group will be used.
+ * @return If the function succeeds, the return value is the I/O engine object.
+ *         If the function fails, the return value is nullptr. To get extended
+ *         error information, call GetLastError.
+*/
+EXTERN_C PMILE_IO_ENGINE WINAPI MileCreateIoEngine(
+    _In_ DWORD NumberOfWorkerThreads);
+
+/**
+ * @brief Stops the worker threads and destroys the I/O engine. All submitted
+ *        operations should be completed or cancelled before calling this
+ *        function.
+ * @param Engine The I/O engine object.
+*/
+EXTERN_C VOID WINAPI MileCloseIoEngine(
+    _In_ PMILE_IO_ENGINE Engine);
+
+/**
+ * @brief Associates a file, device or socket handle with the I/O engine.
+ * @param Engine The I/O engine object.
+ * @param FileHandle The handle to be associated. It must be opened with
+ *                   FILE_FLAG_OVERLAPPED or WSA_FLAG_OVERLAPPED, and it can
+ *                   only be associated with one I/O engine. The synchronous
+ *                   I/O helpers of this library can still be used with the
+ *                   handle because their completions are not queued to the
+ *                   engine. Other overlapped I/O requests on the handle must
+ *                   set the low-order bit of the hEvent member of OVERLAPPED
+ *                   for the same purpose.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+*/
+EXTERN_C BOOL WINAPI MileIoEngineBindHandle(
+    _In_ PMILE_IO_ENGINE Engine,
+    _In_ HANDLE FileHandle);
+
+/**
+ * @brief Submits an asynchronous read operation to the I/O engine.
+ * @param Engine The I/O engine object.
+ * @param FileHandle The handle associated with the I/O engine.
+ * @param Buffer A pointer to the buffer that receives the data. It must remain
+ *               valid until the callback is invoked.
+ * @param NumberOfBytesToRead The maximum number of bytes to be read.
+ * @param Offset The byte offset where to start reading. It is ignored for the
+ *               devices which do not support the file pointer.
+ * @param Callback The callback invoked on a worker thread when the operation
+ *                 is completed.
+ * @param Context The user context.
+ * @return If the function succeeds, the return value is nonzero and the
+ *         callback will be invoked. If the function fails, the return value is
+ *         zero and the callback will not be invoked. To get extended error
+ *         information, call GetLastError.
+ * @remark For more information, see ReadFile.
+*/
+EXTERN_C BOOL WINAPI MileIoEngineSubmitRead(
+    _In_ PMILE_IO_ENGINE Engine,
+    _In_ HANDLE FileHandle,
+    _Out_opt_ LPVOID Buffer,
+    _In_ DWORD NumberOfBytesToRead,
+    _In_ ULONGLONG Offset,
+    _In_ MILE_IO_COMPLETION_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief Submits an asynchronous write operation to the I/O engine.
+ * @param Engine The I/O engine object.
+ * @param FileHandle The handle associated with the I/O engine.
+ * @param Buffer A pointer to the buffer containing the data to be written. It
+ *               must remain valid until the callback is invoked.
+ * @param NumberOfBytesToWrite The number of bytes to be written.
+ * @param Offset The byte offset where to start writing. It is ignored for the
+ *               devices which do not support the file pointer.
+ * @param Callback The callback invoked on a worker thread when the operation
+ *                 is completed.
+ * @param Context The user context.
+ * @return If the function succeeds, the return value is nonzero and the
+ *         callback will be invoked. If the function fails, the return value is
+ *         zero and the callback will not be invoked. To get extended error
+ *         information, call GetLastError.
+ * @remark For more information, see WriteFile.
+*/
+EXTERN_C BOOL WINAPI MileIoEngineSubmitWrite(
+    _In_ PMILE_IO_ENGINE Engine,
+    _In_ HANDLE FileHandle,
+    _In_opt_ LPCVOID Buffer,
+    _In_ DWORD NumberOfBytesToWrite,
+    _In_ ULONGLONG Offset,
+    _In_ MILE_IO_COMPLETION_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief Submits an asynchronous device control operation to the I/O engine.
+ * @param Engine The I/O engine object.
+ * @param DeviceHandle The handle associated with the I/O engine.
+ * @param IoControlCode The control code for the operation.
+ * @param InputBuffer A pointer to the input buffer, or nullptr.
+ * @param InputBufferSize The size of the input buffer, in bytes.
+ * @param OutputBuffer A pointer to the output buffer, or nullptr. It must
+ *                     remain valid until the callback is invoked.
+ * @param OutputBufferSize The size of the output buffer, in bytes.
+ * @param Callback The callback invoked on a worker thread when the operation
+ *                 is completed.
+ * @param Context The user context.
+ * @return If the function succeeds, the return value is nonzero and the
+ *         callback will be invoked. If the function fails, the return value is
+ *         zero and the callback will not be invoked. To get extended error
+ *         information, call GetLastError.
+ * @remark For more information, see DeviceIoControl.
+*/
+EXTERN_C BOOL WINAPI MileIoEngineSubmitDeviceIoControl(
+    _In_ PMILE_IO_ENGINE Engine,
+    _In_ HANDLE DeviceHandle,
+    _In_ DWORD IoControlCode,
+    _In_opt_ LPVOID InputBuffer,
+    _In_ DWORD InputBufferSize,
+    _Out_opt_ LPVOID OutputBuffer,
+    _In_ DWORD OutputBufferSize,
+    _In_ MILE_IO_COMPLETION_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context);
+
+#ifdef _WINSOCK2API_
+
+/**
+ * @brief Submits an asynchronous receive operation to the I/O engine.
+ * @param Engine The I/O engine object.
+ * @param SocketHandle The socket associated with the I/O engine.
+ * @param Buffer A pointer to the buffer that receives the data. It must remain
+ *               valid until the callback is invoked.
+ * @param NumberOfBytesToRecv The maximum number of bytes to be received.
+ * @param Flags The flags used to modify the behavior.
+ * @param Callback The callback invoked on a worker thread when the operation
+ *                 is completed.
+ * @param Context The user context.
+ * @return If the function succeeds, the return value is nonzero and the
+ *         callback will be invoked. If the function fails, the return value is
+ *         zero and the callback will not be invoked. To get extended error
+ *         information, call WSAGetLastError.
+ * @remark For more information, see WSARecv.
+*/
+EXTERN_C BOOL WINAPI MileIoEngineSubmitSocketRecv(
+    _In_ PMILE_IO_ENGINE Engine,
+    _In_ SOCKET SocketHandle,
+    _Out_opt_ LPVOID Buffer,
+    _In_ DWORD NumberOfBytesToRecv,
+    _In_ DWORD Flags,
+    _In_ MILE_IO_COMPLETION_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context);
+
+/**
+ * @brief Submits an asynchronous send operation to the I/O engine.
+ * @param Engine The I/O engine object.
+ * @param SocketHandle The socket associated with the I/O engine.
+ * @param Buffer A pointer to the buffer containing the data to be sent. It
+ *               must remain valid until the callback is invoked.
+ * @param NumberOfBytesToSend The number of bytes to be sent.
+ * @param Flags The flags used to modify the behavior.
+ * @param Callback The callback invoked on a worker thread when the operation
+ *                 is completed.
+ * @param Context The user context.
+ * @return If the function succeeds, the return value is nonzero and the
+ *         callback will be invoked. If the function fails, the return value is
+ *         zero and the callback will not be invoked. To get extended error
+ *         information, call WSAGetLastError.
+ * @remark For more information, see WSASend.
+*/
+EXTERN_C BOOL WINAPI MileIoEngineSubmitSocketSend(
+    _In_ PMILE_IO_ENGINE Engine,
+    _In_ SOCKET SocketHandle,
+    _In_opt_ LPCVOID Buffer,
+    _In_ DWORD NumberOfBytesToSend,
+    _In_ DWORD Flags,
+    _In_ MILE_IO_COMPLETION_CALLBACK_TYPE Callback,
+    _In_opt_ LPVOID Context);
+
+#endif // _WINSOCK2API_
+
 #ifdef _WINSOCK2API_
 
+/**
+ * @brief Receives data from a connected socket or a bound connectionless
+ *        socket into an array of buffers in a single call.
+ * @param SocketHandle A descriptor identifying a connected socket.
+ * @param Buffers A pointer to an array of WSABUF structures that receive the
+ *                data, which are filled in the order in which they appear.
+ * @param BufferCount The number of WSABUF structures in the Buffers array.
+ * @param NumberOfBytesRecvd A pointer to the number, in bytes, of data
+ *                           received by this call if the receive operation
+ *                           completes immediately.
+ * @param Flags A pointer to flags used to modify the behavior.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call WSAGetLastError.
+ * @remark For more information, see WSARecv.
+ */
+EXTERN_C BOOL WINAPI MileSocketRecvV(
+    _In_ SOCKET SocketHandle,
+    _In_ LPWSABUF Buffers,
+    _In_ DWORD BufferCount,
+    _Out_opt_ LPDWORD NumberOfBytesRecvd,
+    _Inout_ LPDWORD Flags);
+
+/**
+ * @brief Sends data from an array of buffers on a connected socket in a single
+ *        call.
+ * @param SocketHandle A descriptor that identifies a connected socket.
+ * @param Buffers A pointer to an array of WSABUF structures that contain the
+ *                data, which are sent in the order in which they appear.
+ * @param BufferCount The number of WSABUF structures in the Buffers array.
+ * @param NumberOfBytesSent A pointer to the number, in bytes, sent by this
+ *                          call if the I/O operation completes immediately.
+ * @param Flags A pointer to flags used to modify the behavior.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call WSAGetLastError.
+ * @remark For more information, see WSASend.
+ */
+EXTERN_C BOOL WINAPI MileSocketSendV(
+    _In_ SOCKET SocketHandle,
+    _In_ LPWSABUF Buffers,
+    _In_ DWORD BufferCount,
+    _Out_opt_ LPDWORD NumberOfBytesSent,
+    _In_ DWORD Flags);
+
 /**
  * @brief Receives data from a connected socket or a bound connectionless
  *        socket.
@@ -11,6 +11,7 @@
 #include "Mile.Helpers.CppBase.h"
 
 #include <cstdarg>
+#include <cstring>
 
 std::wstring Mile::VFormatWideString(
     _In_ wchar_t const* const Format,
@@ -182,6 +183,199 @@ std::string Mile::ToString(
     return OutputString;
 }
 
+Mile::FileEnumerateEntry::FileEnumerateEntry(
+    _In_ PMILE_FILE_ENUMERATE_VIEW View) :
+    m_View(View)
+{
+}
+
+std::wstring_view Mile::FileEnumerateEntry::GetFileName() const
+{
+    return std::wstring_view(
+        this->m_View->FileName,
+        this->m_View->FileNameLength);
+}
+
+namespace
+{
+    static PFILE_FULL_DIR_INFO GetFullDirectoryInformation(
+        _In_ PMILE_FILE_ENUMERATE_VIEW View)
+    {
+        // FILE_FULL_DIR_INFO is the common header of all information classes
+        // except the names-only one.
+        if (MILE_FILE_ENUMERATE_NAMES_INFORMATION == View->InformationClass)
+        {
+            return nullptr;
+        }
+        return reinterpret_cast<PFILE_FULL_DIR_INFO>(View->Information);
+    }
+
+    static FILETIME ToFileTime(
+        _In_ LARGE_INTEGER const& Value)
+    {
+        FILETIME Result;
+        Result.dwLowDateTime = Value.LowPart;
+        Result.dwHighDateTime = Value.HighPart;
+        return Result;
+    }
+}
+
+std::wstring_view Mile::FileEnumerateEntry::GetShortName() const
+{
+    if (MILE_FILE_ENUMERATE_ID_BOTH_DIRECTORY_INFORMATION !=
+        this->m_View->InformationClass)
+    {
+        return std::wstring_view();
+    }
+
+    PFILE_ID_BOTH_DIR_INFO Information =
+        reinterpret_cast<PFILE_ID_BOTH_DIR_INFO>(this->m_View->Information);
+    return std::wstring_view(
+        Information->ShortName,
+        Information->ShortNameLength / sizeof(wchar_t));
+}
+
+DWORD Mile::FileEnumerateEntry::GetAttributes() const
+{
+    PFILE_FULL_DIR_INFO Information =
+        ::GetFullDirectoryInformation(this->m_View);
+    return Information ? Information->FileAttributes : 0;
+}
+
+bool Mile::FileEnumerateEntry::IsDirectory() const
+{
+    return (this->GetAttributes() & FILE_ATTRIBUTE_DIRECTORY);
+}
+
+std::uint64_t Mile::FileEnumerateEntry::GetFileSize() const
+{
+    PFILE_FULL_DIR_INFO Information =
+        ::GetFullDirectoryInformation(this->m_View);
+    return Information
+        ? static_cast<std::uint64_t>(Information->EndOfFile.QuadPart)
+        : 0;
+}
+
+std::uint64_t Mile::FileEnumerateEntry::GetAllocationSize() const
+{
+    PFILE_FULL_DIR_INFO Information =
+        ::GetFullDirectoryInformation(this->m_View);
+    return Information
+        ? static_cast<std::uint64_t>(Information->AllocationSize.QuadPart)
+        : 0;
+}
+
+FILETIME Mile::FileEnumerateEntry::GetCreationTime() const
+{
+    PFILE_FULL_DIR_INFO Information =
+        ::GetFullDirectoryInformation(this->m_View);
+    return Information ? ::ToFileTime(Information->CreationTime) : FILETIME();
+}
+
+FILETIME Mile::FileEnumerateEntry::GetLastAccessTime() const
+{
+    PFILE_FULL_DIR_INFO Information =
+        ::GetFullDirectoryInformation(this->m_View);
+    return Information
+        ? ::ToFileTime(Information->LastAccessTime)
+        : FILETIME();
+}
+
+FILETIME Mile::FileEnumerateEntry::GetLastWriteTime() const
+{
+    PFILE_FULL_DIR_INFO Information =
+        ::GetFullDirectoryInformation(this->m_View);
+    return Information
+        ? ::ToFileTime(Information->LastWriteTime)
+        : FILETIME();
+}
+
+FILETIME Mile::FileEnumerateEntry::GetChangeTime() const
+{
+    PFILE_FULL_DIR_INFO Information =
+        ::GetFullDirectoryInformation(this->m_View);
+    return Information ? ::ToFileTime(Information->ChangeTime) : FILETIME();
+}
+
+std::uint64_t Mile::FileEnumerateEntry::GetFileId() const
+{
+    switch (this->m_View->InformationClass)
+    {
+    case MILE_FILE_ENUMERATE_ID_BOTH_DIRECTORY_INFORMATION:
+    {
+        PFILE_ID_BOTH_DIR_INFO Information =
+            reinterpret_cast<PFILE_ID_BOTH_DIR_INFO>(
+                this->m_View->Information);
+        return static_cast<std::uint64_t>(Information->FileId.QuadPart);
+    }
+    case MILE_FILE_ENUMERATE_ID_EXTD_DIRECTORY_INFORMATION:
+    {
+        // The low 64 bits of the 128-bit file ID are the 64-bit file ID on
+        // NTFS.
+        PFILE_ID_EXTD_DIR_INFO Information =
+            reinterpret_cast<PFILE_ID_EXTD_DIR_INFO>(
+                this->m_View->Information);
+        std::uint64_t FileId = 0;
+        std::memcpy(
+            &FileId,
+            Information->FileId.Identifier,
+            sizeof(FileId));
+        return FileId;
+    }
+    default:
+        return 0;
+    }
+}
+
+PMILE_FILE_ENUMERATE_VIEW Mile::FileEnumerateEntry::GetView() const
+{
+    return this->m_View;
+}
+
+std::wstring Mile::GetFilePathById(
+    _In_ HANDLE VolumeHandle,
+    _In_ std::uint64_t FileId,
+    _In_ DWORD Flags)
+{
+    std::wstring FilePath;
+
+    HANDLE FileHandle = ::MileOpenFileById(
+        VolumeHandle,
+        FileId,
+        FILE_READ_ATTRIBUTES,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        FILE_FLAG_BACKUP_SEMANTICS);
+    if (INVALID_HANDLE_VALUE == FileHandle)
+    {
+        return FilePath;
+    }
+
+    DWORD FilePathLength = ::GetFinalPathNameByHandleW(
+        FileHandle,
+        nullptr,
+        0,
+        Flags);
+    if (FilePathLength)
+    {
+        FilePath.resize(FilePathLength);
+        FilePathLength = ::GetFinalPathNameByHandleW(
+            FileHandle,
+            &FilePath[0],
+            FilePathLength,
+            Flags);
+        // The path may be renamed to a longer one between the calls.
+        FilePath.resize(
+            FilePathLength < FilePath.size() ? FilePathLength : 0);
+    }
+    DWORD LastError = ::GetLastError();
+
+    ::CloseHandle(FileHandle);
+
+    ::SetLastError(LastError);
+
+    return FilePath;
+}
+
 namespace
 {
     template <typename StringType>
@@ -361,3 +555,1628 @@ std::uint64_t Mile::ToUInt64(
 {
     return std::strtoull(Source.c_str(), nullptr, Radix);
 }
+
+namespace
+{
+    static VOID CALLBACK TimerWheelThreadPoolCallback(
+        _Inout_ PTP_CALLBACK_INSTANCE Instance,
+        _Inout_opt_ PVOID Context)
+    {
+        UNREFERENCED_PARAMETER(Instance);
+
+        auto Callback = reinterpret_cast<Mile::TimerWheel::CallbackType*>(
+            Context);
+        if (Callback)
+        {
+            (*Callback)();
+            delete Callback;
+        }
+    }
+
+    static void TimerWheelDefaultDispatcher(
+        Mile::TimerWheel::CallbackType&& Callback)
+    {
+        auto Context = new Mile::TimerWheel::CallbackType(
+            std::move(Callback));
+        if (!::TrySubmitThreadpoolCallback(
+            ::TimerWheelThreadPoolCallback,
+            Context,
+            nullptr))
+        {
+            // Invoke the callback inline if the thread pool is not available
+            // because the expired callback should never be lost.
+            (*Context)();
+            delete Context;
+        }
+    }
+}
+
+std::uint64_t Mile::TimerWheel::GetElapsedTicks()
+{
+    std::uint64_t CurrentTime = this->m_Clock();
+    if (CurrentTime < this->m_StartTime)
+    {
+        return 0;
+    }
+    return (CurrentTime - this->m_StartTime) / this->m_TickInterval;
+}
+
+void Mile::TimerWheel::InsertEntry(
+    _In_ Entry* Item)
+{
+    const std::uint64_t MaximumDelta =
+        (std::uint64_t(1) << (SlotBits * LevelCount)) - 1;
+
+    std::uint64_t Delta = Item->ExpiryTick - this->m_CurrentTick;
+    std::uint64_t Position = Item->ExpiryTick;
+    if (Delta > MaximumDelta)
+    {
+        // Park the entry at the farthest slot of the top level, it will be
+        // re-inserted with the actual expiry tick when that slot cascades.
+        Delta = MaximumDelta;
+        Position = this->m_CurrentTick + MaximumDelta;
+    }
+
+    std::size_t Level = 0;
+    while (Level < LevelCount - 1 &&
+        Delta >= (std::uint64_t(1) << (SlotBits * (Level + 1))))
+    {
+        ++Level;
+    }
+
+    std::size_t Slot = static_cast<std::size_t>(
+        (Position >> (SlotBits * Level)) & SlotMask);
+
+    Entry** Head = &this->m_Slots[Level][Slot];
+    Item->Next = *Head;
+    if (Item->Next)
+    {
+        Item->Next->PreviousNext = &Item->Next;
+    }
+    Item->PreviousNext = Head;
+    *Head = Item;
+}
+
+void Mile::TimerWheel::RemoveEntry(
+    _In_ Entry* Item)
+{
+    *Item->PreviousNext = Item->Next;
+    if (Item->Next)
+    {
+        Item->Next->PreviousNext = Item->PreviousNext;
+    }
+    Item->Next = nullptr;
+    Item->PreviousNext = nullptr;
+}
+
+void Mile::TimerWheel::CascadeSlot(
+    _In_ std::size_t Level,
+    _In_ std::size_t Slot)
+{
+    Entry* Current = this->m_Slots[Level][Slot];
+    this->m_Slots[Level][Slot] = nullptr;
+
+    while (Current)
+    {
+        Entry* Next = Current->Next;
+        this->InsertEntry(Current);
+        Current = Next;
+    }
+}
+
+void Mile::TimerWheel::CollectExpiredSlot(
+    _In_ std::size_t Slot,
+    _Inout_ std::vector<CallbackType>& ExpiredCallbacks)
+{
+    Entry* Current = this->m_Slots[0][Slot];
+    this->m_Slots[0][Slot] = nullptr;
+
+    while (Current)
+    {
+        Entry* Next = Current->Next;
+        if (Current->ExpiryTick > this->m_CurrentTick)
+        {
+            // Keep the entries which belong to a later round of the wheel.
+            this->InsertEntry(Current);
+        }
+        else
+        {
+            ExpiredCallbacks.push_back(std::move(Current->Callback));
+            this->m_Entries.erase(Current->Id);
+            delete Current;
+        }
+        Current = Next;
+    }
+}
+
+Mile::TimerWheel::TimerWheel(
+    _In_ std::uint64_t TickInterval,
+    _In_ ClockType const& Clock,
+    _In_ DispatcherType const& Dispatcher) :
+    m_TickInterval(TickInterval ? TickInterval : 1),
+    m_Clock(Clock ? Clock : ::MileGetTickCount),
+    m_Dispatcher(Dispatcher ? Dispatcher : ::TimerWheelDefaultDispatcher),
+    m_CurrentTick(0),
+    m_NextTimerId(InvalidTimerId + 1),
+    m_Slots(),
+    m_DriverThread(nullptr),
+    m_DriverStopEvent(nullptr)
+{
+    ::InitializeSRWLock(&this->m_Lock);
+    this->m_StartTime = this->m_Clock();
+}
+
+Mile::TimerWheel::~TimerWheel()
+{
+    this->Stop();
+
+    for (auto& Item : this->m_Entries)
+    {
+        delete Item.second;
+    }
+    this->m_Entries.clear();
+}
+
+Mile::TimerWheel::TimerId Mile::TimerWheel::Schedule(
+    _In_ std::uint64_t Timeout,
+    _In_ CallbackType&& Callback)
+{
+    if (!Callback)
+    {
+        return InvalidTimerId;
+    }
+
+    // Round up to the tick interval and never expire in the current tick.
+    // Avoid adding before dividing, which wraps for very large timeouts.
+    std::uint64_t Ticks = Timeout / this->m_TickInterval;
+    if (Timeout % this->m_TickInterval)
+    {
+        ++Ticks;
+    }
+    if (!Ticks)
+    {
+        Ticks = 1;
+    }
+
+    Entry* Item = new Entry();
+    Item->Callback = std::move(Callback);
+
+    ::AcquireSRWLockExclusive(&this->m_Lock);
+
+    std::uint64_t ElapsedTicks = this->GetElapsedTicks();
+    if (ElapsedTicks < this->m_CurrentTick)
+    {
+        ElapsedTicks = this->m_CurrentTick;
+    }
+
+    Item->Id = this->m_NextTimerId++;
+    // Saturate the expiry tick, the timer practically never expires then.
+    Item->ExpiryTick = Ticks < UINT64_MAX - ElapsedTicks
+        ? ElapsedTicks + Ticks
+        : UINT64_MAX;
+    this->InsertEntry(Item);
+    this->m_Entries.emplace(Item->Id, Item);
+
+    TimerId Result = Item->Id;
+
+    ::ReleaseSRWLockExclusive(&this->m_Lock);
+
+    return Result;
+}
+
+bool Mile::TimerWheel::Cancel(
+    _In_ TimerId Id)
+{
+    Entry* Item = nullptr;
+
+    ::AcquireSRWLockExclusive(&this->m_Lock);
+
+    auto Iterator = this->m_Entries.find(Id);
+    if (Iterator != this->m_Entries.end())
+    {
+        Item = Iterator->second;
+        this->m_Entries.erase(Iterator);
+        this->RemoveEntry(Item);
+    }
+
+    ::ReleaseSRWLockExclusive(&this->m_Lock);
+
+    // Destroy the callback outside the lock because the destruction of the
+    // captured states may be expensive.
+    delete Item;
+
+    return Item != nullptr;
+}
+
+std::size_t Mile::TimerWheel::Advance()
+{
+    std::vector<CallbackType> ExpiredCallbacks;
+
+    ::AcquireSRWLockExclusive(&this->m_Lock);
+
+    std::uint64_t TargetTick = this->GetElapsedTicks();
+    while (this->m_CurrentTick < TargetTick)
+    {
+        if (this->m_Entries.empty())
+        {
+            // Nothing to cascade or expire, skip all remaining ticks.
+            this->m_CurrentTick = TargetTick;
+            break;
+        }
+
+        ++this->m_CurrentTick;
+
+        for (std::size_t Level = LevelCount - 1; Level > 0; --Level)
+        {
+            std::uint64_t LevelMask =
+                (std::uint64_t(1) << (SlotBits * Level)) - 1;
+            if (!(this->m_CurrentTick & LevelMask))
+            {
+                this->CascadeSlot(
+                    Level,
+                    static_cast<std::size_t>(
+                        (this->m_CurrentTick >> (SlotBits * Level))
+                        & SlotMask));
+            }
+        }
+
+        this->CollectExpiredSlot(
+            static_cast<std::size_t>(this->m_CurrentTick & SlotMask),
+            ExpiredCallbacks);
+    }
+
+    ::ReleaseSRWLockExclusive(&this->m_Lock);
+
+    for (CallbackType& Callback : ExpiredCallbacks)
+    {
+        this->m_Dispatcher(std::move(Callback));
+    }
+
+    return ExpiredCallbacks.size();
+}
+
+std::uint64_t Mile::TimerWheel::GetTickInterval() const
+{
+    return this->m_TickInterval;
+}
+
+std::size_t Mile::TimerWheel::GetPendingCount()
+{
+    ::AcquireSRWLockShared(&this->m_Lock);
+    std::size_t Result = this->m_Entries.size();
+    ::ReleaseSRWLockShared(&this->m_Lock);
+    return Result;
+}
+
+bool Mile::TimerWheel::Start()
+{
+    if (this->m_DriverThread)
+    {
+        return true;
+    }
+
+    this->m_DriverStopEvent = ::CreateEventW(
+        nullptr,
+        TRUE,
+        FALSE,
+        nullptr);
+    if (!this->m_DriverStopEvent)
+    {
+        return false;
+    }
+
+    this->m_DriverThread = Mile::CreateThread([this]()
+    {
+        DWORD WaitInterval = this->m_TickInterval < INFINITE
+            ? static_cast<DWORD>(this->m_TickInterval)
+            : INFINITE - 1;
+        while (WAIT_TIMEOUT == ::WaitForSingleObject(
+            this->m_DriverStopEvent,
+            WaitInterval))
+        {
+            this->Advance();
+        }
+    });
+    if (!this->m_DriverThread)
+    {
+        DWORD LastError = ::GetLastError();
+        ::CloseHandle(this->m_DriverStopEvent);
+        this->m_DriverStopEvent = nullptr;
+        ::SetLastError(LastError);
+        return false;
+    }
+
+    return true;
+}
+
+void Mile::TimerWheel::Stop()
+{
+    if (this->m_DriverThread)
+    {
+        ::SetEvent(this->m_DriverStopEvent);
+        ::WaitForSingleObject(this->m_DriverThread, INFINITE);
+        ::CloseHandle(this->m_DriverThread);
+        this->m_DriverThread = nullptr;
+    }
+
+    if (this->m_DriverStopEvent)
+    {
+        ::CloseHandle(this->m_DriverStopEvent);
+        this->m_DriverStopEvent = nullptr;
+    }
+}
+
+namespace
+{
+    struct EpochParticipant
+    {
+        EpochParticipant* Next = nullptr;
+        std::atomic<bool> Owned = true;
+
+        // Zero if the owner thread is not within the epoch, otherwise the
+        // observed global epoch shifted left by one bit with the lowest bit
+        // set.
+        std::atomic<std::uint64_t> LocalEpoch = 0;
+
+        // Only accessed by the owner thread.
+        std::size_t Nesting = 0;
+    };
+
+    struct EpochRetiredObject
+    {
+        EpochRetiredObject* Next;
+        void* Object;
+        Mile::Epoch::DeleterType Deleter;
+        std::uint64_t RetiredEpoch;
+    };
+
+    struct EpochState
+    {
+        std::atomic<std::uint64_t> GlobalEpoch = 1;
+        std::atomic<EpochParticipant*> Participants = nullptr;
+
+        SRWLOCK RetiredLock = SRWLOCK_INIT;
+        EpochRetiredObject* RetiredObjects = nullptr;
+        std::size_t RetiredCount = 0;
+
+        SRWLOCK ReclamationLock = SRWLOCK_INIT;
+        PTP_TIMER ReclamationTimer = nullptr;
+    };
+
+    static EpochState& GetEpochState()
+    {
+        // The state is intentionally leaked because the participants may be
+        // still referenced by the thread local storage when the process is
+        // exiting.
+        static EpochState* CachedResult = new EpochState();
+        return *CachedResult;
+    }
+
+    static EpochParticipant* AcquireEpochParticipant()
+    {
+        EpochState& State = ::GetEpochState();
+
+        for (EpochParticipant* Current = State.Participants.load();
+            Current;
+            Current = Current->Next)
+        {
+            bool Expected = false;
+            if (Current->Owned.compare_exchange_strong(Expected, true))
+            {
+                return Current;
+            }
+        }
+
+        EpochParticipant* Participant = new EpochParticipant();
+        Participant->Next = State.Participants.load();
+        while (!State.Participants.compare_exchange_weak(
+            Participant->Next,
+            Participant))
+        {
+            // Participant->Next has been refreshed by the failed exchange.
+        }
+        return Participant;
+    }
+
+    struct EpochParticipantHolder
+    {
+        EpochParticipant* Participant = nullptr;
+
+        ~EpochParticipantHolder()
+        {
+            if (this->Participant)
+            {
+                this->Participant->Nesting = 0;
+                this->Participant->LocalEpoch.store(0);
+                this->Participant->Owned.store(false);
+            }
+        }
+    };
+
+    static thread_local EpochParticipantHolder CurrentEpochParticipant;
+
+    static EpochParticipant* GetCurrentEpochParticipant()
+    {
+        if (!CurrentEpochParticipant.Participant)
+        {
+            CurrentEpochParticipant.Participant =
+                ::AcquireEpochParticipant();
+        }
+        return CurrentEpochParticipant.Participant;
+    }
+
+    static bool TryAdvanceEpoch()
+    {
+        EpochState& State = ::GetEpochState();
+
+        std::uint64_t CurrentEpoch = State.GlobalEpoch.load();
+        std::uint64_t ActiveEpoch = (CurrentEpoch << 1) | 1;
+
+        for (EpochParticipant* Current = State.Participants.load();
+            Current;
+            Current = Current->Next)
+        {
+            std::uint64_t LocalEpoch = Current->LocalEpoch.load();
+            if ((LocalEpoch & 1) && LocalEpoch != ActiveEpoch)
+            {
+                // Someone is still reading in the previous epoch.
+                return false;
+            }
+        }
+
+        return State.GlobalEpoch.compare_exchange_strong(
+            CurrentEpoch,
+            CurrentEpoch + 1);
+    }
+
+    static VOID CALLBACK EpochReclamationTimerCallback(
+        _Inout_ PTP_CALLBACK_INSTANCE Instance,
+        _Inout_opt_ PVOID Context,
+        _Inout_ PTP_TIMER Timer)
+    {
+        UNREFERENCED_PARAMETER(Instance);
+        UNREFERENCED_PARAMETER(Context);
+        UNREFERENCED_PARAMETER(Timer);
+
+        Mile::Epoch::Reclaim();
+    }
+}
+
+void Mile::Epoch::Enter()
+{
+    EpochParticipant* Participant = ::GetCurrentEpochParticipant();
+    if (0 == Participant->Nesting++)
+    {
+        EpochState& State = ::GetEpochState();
+
+        std::uint64_t ObservedEpoch = 0;
+        do
+        {
+            ObservedEpoch = State.GlobalEpoch.load();
+            Participant->LocalEpoch.store((ObservedEpoch << 1) | 1);
+
+            // Make sure the announcement is visible to the reclaimers before
+            // reading any shared pointer, and announce again if the global
+            // epoch has been advanced without noticing this participant.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        } while (ObservedEpoch != State.GlobalEpoch.load());
+    }
+}
+
+void Mile::Epoch::Leave()
+{
+    EpochParticipant* Participant = ::GetCurrentEpochParticipant();
+    if (Participant->Nesting && 0 == --Participant->Nesting)
+    {
+        Participant->LocalEpoch.store(0, std::memory_order_release);
+    }
+}
+
+void Mile::Epoch::Retire(
+    _In_ void* Object,
+    _In_ DeleterType Deleter)
+{
+    if (!Object || !Deleter)
+    {
+        return;
+    }
+
+    // Trigger the reclamation inline when the retired objects pile up because
+    // the background reclamation is optional.
+    const std::size_t ReclamationThreshold = 128;
+
+    EpochState& State = ::GetEpochState();
+
+    EpochRetiredObject* Item = new EpochRetiredObject();
+    Item->Object = Object;
+    Item->Deleter = Deleter;
+    Item->RetiredEpoch = State.GlobalEpoch.load();
+
+    ::AcquireSRWLockExclusive(&State.RetiredLock);
+    Item->Next = State.RetiredObjects;
+    State.RetiredObjects = Item;
+    bool NeedReclamation = (++State.RetiredCount >= ReclamationThreshold);
+    ::ReleaseSRWLockExclusive(&State.RetiredLock);
+
+    if (NeedReclamation)
+    {
+        Mile::Epoch::Reclaim();
+    }
+}
+
+std::size_t Mile::Epoch::Reclaim()
+{
+    EpochState& State = ::GetEpochState();
+
+    ::TryAdvanceEpoch();
+
+    // The objects retired in epoch N may be observed by the readers entered
+    // in epoch N, so they are only safe to destroy from epoch N + 2.
+    std::uint64_t CurrentEpoch = State.GlobalEpoch.load();
+
+    EpochRetiredObject* Reclaimable = nullptr;
+    std::size_t Count = 0;
+
+    ::AcquireSRWLockExclusive(&State.RetiredLock);
+    EpochRetiredObject** Link = &State.RetiredObjects;
+    while (*Link)
+    {
+        EpochRetiredObject* Current = *Link;
+        if (Current->RetiredEpoch + 2 <= CurrentEpoch)
+        {
+            *Link = Current->Next;
+            Current->Next = Reclaimable;
+            Reclaimable = Current;
+            ++Count;
+        }
+        else
+        {
+            Link = &Current->Next;
+        }
+    }
+    State.RetiredCount -= Count;
+    ::ReleaseSRWLockExclusive(&State.RetiredLock);
+
+    while (Reclaimable)
+    {
+        EpochRetiredObject* Next = Reclaimable->Next;
+        Reclaimable->Deleter(Reclaimable->Object);
+        delete Reclaimable;
+        Reclaimable = Next;
+    }
+
+    return Count;
+}
+
+void Mile::Epoch::Synchronize()
+{
+    EpochState& State = ::GetEpochState();
+
+    std::uint64_t TargetEpoch = State.GlobalEpoch.load() + 2;
+    while (State.GlobalEpoch.load() < TargetEpoch)
+    {
+        if (!::TryAdvanceEpoch())
+        {
+            ::SwitchToThread();
+        }
+    }
+
+    Mile::Epoch::Reclaim();
+}
+
+bool Mile::Epoch::StartBackgroundReclamation(
+    _In_ std::uint32_t Interval)
+{
+    EpochState& State = ::GetEpochState();
+
+    bool Result = true;
+
+    ::AcquireSRWLockExclusive(&State.ReclamationLock);
+    if (!State.ReclamationTimer)
+    {
+        State.ReclamationTimer = ::CreateThreadpoolTimer(
+            ::EpochReclamationTimerCallback,
+            nullptr,
+            nullptr);
+        if (State.ReclamationTimer)
+        {
+            // Negative value means the relative time in 100-nanosecond
+            // intervals.
+            LARGE_INTEGER DueTime;
+            DueTime.QuadPart = -static_cast<LONGLONG>(Interval) * 10000;
+            FILETIME FileDueTime;
+            FileDueTime.dwLowDateTime = DueTime.LowPart;
+            FileDueTime.dwHighDateTime = static_cast<DWORD>(DueTime.HighPart);
+
+            ::SetThreadpoolTimer(
+                State.ReclamationTimer,
+                &FileDueTime,
+                Interval,
+                0);
+        }
+        else
+        {
+            Result = false;
+        }
+    }
+    ::ReleaseSRWLockExclusive(&State.ReclamationLock);
+
+    return Result;
+}
+
+void Mile::Epoch::StopBackgroundReclamation()
+{
+    EpochState& State = ::GetEpochState();
+
+    ::AcquireSRWLockExclusive(&State.ReclamationLock);
+    if (State.ReclamationTimer)
+    {
+        ::SetThreadpoolTimer(State.ReclamationTimer, nullptr, 0, 0);
+        ::WaitForThreadpoolTimerCallbacks(State.ReclamationTimer, TRUE);
+        ::CloseThreadpoolTimer(State.ReclamationTimer);
+        State.ReclamationTimer = nullptr;
+    }
+    ::ReleaseSRWLockExclusive(&State.ReclamationLock);
+}
+
+namespace
+{
+    const ULONG_PTR CompletionPortExecutorStopKey = static_cast<ULONG_PTR>(-1);
+}
+
+std::size_t Mile::CompletionPortExecutor::ProcessCompletions(
+    _In_ DWORD Timeout,
+    _Out_ ULONG& NumberOfStopRequests,
+    _Out_ bool& WaitFailed)
+{
+    NumberOfStopRequests = 0;
+    WaitFailed = false;
+
+    const ULONG MaximumEntries = 64;
+    OVERLAPPED_ENTRY Entries[MaximumEntries];
+    ULONG NumberOfEntries = 0;
+    if (!::GetQueuedCompletionStatusEx(
+        this->m_CompletionPort,
+        Entries,
+        MaximumEntries,
+        &NumberOfEntries,
+        Timeout,
+        FALSE))
+    {
+        // The completion port has been closed or is no longer usable if the
+        // wait failed without timing out.
+        WaitFailed = (WAIT_TIMEOUT != ::GetLastError());
+        return 0;
+    }
+
+    std::size_t Count = 0;
+
+    for (ULONG i = 0; i < NumberOfEntries; ++i)
+    {
+        if (!Entries[i].lpOverlapped)
+        {
+            if (CompletionPortExecutorStopKey == Entries[i].lpCompletionKey)
+            {
+                ++NumberOfStopRequests;
+            }
+            continue;
+        }
+
+        Mile::CompletionPortOperation* Operation =
+            reinterpret_cast<Mile::CompletionPortOperation*>(
+                Entries[i].lpOverlapped);
+
+        DWORD BytesTransferred = 0;
+        DWORD Error = ERROR_SUCCESS;
+        if (!::GetOverlappedResult(
+            Operation->Handle,
+            &Operation->Overlapped,
+            &BytesTransferred,
+            FALSE))
+        {
+            Error = ::GetLastError();
+        }
+
+        Operation->CompletionRoutine(Operation, Error, BytesTransferred);
+        ++Count;
+    }
+
+    return Count;
+}
+
+Mile::CompletionPortExecutor::CompletionPortExecutor(
+    _In_ DWORD NumberOfConcurrentThreads) :
+    m_PendingStopRequests(0)
+{
+    this->m_CompletionPort = ::CreateIoCompletionPort(
+        INVALID_HANDLE_VALUE,
+        nullptr,
+        0,
+        NumberOfConcurrentThreads);
+}
+
+Mile::CompletionPortExecutor::~CompletionPortExecutor()
+{
+    if (this->m_CompletionPort)
+    {
+        ::CloseHandle(this->m_CompletionPort);
+    }
+}
+
+bool Mile::CompletionPortExecutor::IsValid() const
+{
+    return nullptr != this->m_CompletionPort;
+}
+
+bool Mile::CompletionPortExecutor::Bind(
+    _In_ HANDLE FileHandle)
+{
+    if (!this->m_CompletionPort)
+    {
+        ::SetLastError(ERROR_INVALID_HANDLE);
+        return false;
+    }
+
+    return this->m_CompletionPort == ::CreateIoCompletionPort(
+        FileHandle,
+        this->m_CompletionPort,
+        0,
+        0);
+}
+
+std::size_t Mile::CompletionPortExecutor::RunOnce(
+    _In_ DWORD Timeout,
+    _Out_opt_ bool* WaitFailed)
+{
+    ULONG NumberOfStopRequests = 0;
+    bool CurrentWaitFailed = false;
+    std::size_t Count = this->ProcessCompletions(
+        Timeout,
+        NumberOfStopRequests,
+        CurrentWaitFailed);
+    if (NumberOfStopRequests)
+    {
+        // Keep the stop requests for the Run calls. Posting them again would
+        // make a RunOnce loop dequeue them on every call without waiting.
+        ::InterlockedExchangeAdd(
+            &this->m_PendingStopRequests,
+            static_cast<LONG>(NumberOfStopRequests));
+    }
+    if (WaitFailed)
+    {
+        *WaitFailed = CurrentWaitFailed;
+    }
+    return Count;
+}
+
+void Mile::CompletionPortExecutor::Run()
+{
+    if (!this->m_CompletionPort)
+    {
+        return;
+    }
+
+    for (;;)
+    {
+        // Consume one of the stop requests dequeued by RunOnce first.
+        LONG PendingStopRequests = this->m_PendingStopRequests;
+        while (PendingStopRequests > 0)
+        {
+            LONG Previous = ::InterlockedCompareExchange(
+                &this->m_PendingStopRequests,
+                PendingStopRequests - 1,
+                PendingStopRequests);
+            if (Previous == PendingStopRequests)
+            {
+                return;
+            }
+            PendingStopRequests = Previous;
+        }
+
+        ULONG NumberOfStopRequests = 0;
+        bool WaitFailed = false;
+        this->ProcessCompletions(INFINITE, NumberOfStopRequests, WaitFailed);
+        if (WaitFailed)
+        {
+            return;
+        }
+        if (NumberOfStopRequests)
+        {
+            // Each call only consumes one stop request, so give the other
+            // stop requests dequeued in the same batch back to the other Run
+            // calls.
+            while (--NumberOfStopRequests)
+            {
+                this->Stop();
+            }
+            return;
+        }
+    }
+}
+
+void Mile::CompletionPortExecutor::Stop()
+{
+    if (this->m_CompletionPort)
+    {
+        ::PostQueuedCompletionStatus(
+            this->m_CompletionPort,
+            0,
+            CompletionPortExecutorStopKey,
+            nullptr);
+    }
+}
+
+Mile::IoCancellation::IoCancellation() :
+    m_Cancelled(false),
+    m_PendingOperations(nullptr)
+{
+    ::InitializeSRWLock(&this->m_Lock);
+}
+
+void Mile::IoCancellation::Cancel()
+{
+    ::AcquireSRWLockExclusive(&this->m_Lock);
+    this->m_Cancelled = true;
+    for (CompletionPortOperation* Current = this->m_PendingOperations;
+        Current;
+        Current = Current->CancellationNext)
+    {
+        ::CancelIoEx(Current->Handle, &Current->Overlapped);
+    }
+    ::ReleaseSRWLockExclusive(&this->m_Lock);
+}
+
+bool Mile::IoCancellation::IsCancelled()
+{
+    ::AcquireSRWLockShared(&this->m_Lock);
+    bool Result = this->m_Cancelled;
+    ::ReleaseSRWLockShared(&this->m_Lock);
+    return Result;
+}
+
+namespace
+{
+    const std::size_t DefaultFileStreamBufferSize = 64 * 1024;
+
+    static std::size_t GetFileStreamBufferSize(
+        _In_ std::size_t BufferSize)
+    {
+        if (!BufferSize)
+        {
+            return DefaultFileStreamBufferSize;
+        }
+
+        // A single request is limited to the DWORD range.
+        const std::size_t MaximumBufferSize = 0x40000000;
+        return BufferSize < MaximumBufferSize ? BufferSize : MaximumBufferSize;
+    }
+
+    static DWORD GetFileAccessPatternFlags(
+        _In_ Mile::FileAccessPattern AccessPattern)
+    {
+        switch (AccessPattern)
+        {
+        case Mile::FileAccessPattern::Sequential:
+            return FILE_FLAG_SEQUENTIAL_SCAN;
+        case Mile::FileAccessPattern::Random:
+            return FILE_FLAG_RANDOM_ACCESS;
+        default:
+            return 0;
+        }
+    }
+}
+
+bool Mile::FileReader::Initialize()
+{
+    if (!this->m_Event)
+    {
+        this->m_Event = ::CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!this->m_Event)
+        {
+            return false;
+        }
+    }
+
+    for (std::vector<std::uint8_t>& Buffer : this->m_Buffers)
+    {
+        Buffer.resize(this->m_BufferSize);
+    }
+
+    this->m_CurrentIndex = 0;
+    this->m_CurrentOffset = 0;
+    this->m_CurrentSize = 0;
+    this->m_FileOffset = 0;
+    this->m_ReadAheadPending = false;
+    this->m_EndOfFile = false;
+
+    return true;
+}
+
+bool Mile::FileReader::IssueReadAhead()
+{
+    this->m_Overlapped.Internal = 0;
+    this->m_Overlapped.InternalHigh = 0;
+    this->m_Overlapped.Offset = static_cast<DWORD>(this->m_FileOffset);
+    this->m_Overlapped.OffsetHigh = static_cast<DWORD>(
+        this->m_FileOffset >> 32);
+    // Keep the completion from being queued to the I/O completion port which
+    // may be associated with the file handle.
+    this->m_Overlapped.hEvent = reinterpret_cast<HANDLE>(
+        reinterpret_cast<ULONG_PTR>(this->m_Event) | 1);
+
+    if (!::ReadFile(
+        this->m_FileHandle,
+        this->m_Buffers[this->m_CurrentIndex ^ 1].data(),
+        static_cast<DWORD>(this->m_BufferSize),
+        nullptr,
+        &this->m_Overlapped))
+    {
+        DWORD LastError = ::GetLastError();
+        if (ERROR_HANDLE_EOF == LastError)
+        {
+            this->m_EndOfFile = true;
+            return true;
+        }
+        if (ERROR_IO_PENDING != LastError)
+        {
+            return false;
+        }
+    }
+
+    this->m_ReadAheadPending = true;
+    return true;
+}
+
+bool Mile::FileReader::FillBuffer()
+{
+    this->m_CurrentOffset = 0;
+    this->m_CurrentSize = 0;
+
+    if (!this->m_ReadAheadPending)
+    {
+        if (this->m_EndOfFile)
+        {
+            return true;
+        }
+        if (!this->IssueReadAhead() || !this->m_ReadAheadPending)
+        {
+            return this->m_EndOfFile;
+        }
+    }
+
+    DWORD NumberOfBytesTransferred = 0;
+    BOOL Result = ::GetOverlappedResult(
+        this->m_FileHandle,
+        &this->m_Overlapped,
+        &NumberOfBytesTransferred,
+        TRUE);
+    this->m_ReadAheadPending = false;
+    if (!Result)
+    {
+        if (ERROR_HANDLE_EOF != ::GetLastError())
+        {
+            return false;
+        }
+        NumberOfBytesTransferred = 0;
+    }
+
+    // The buffer filled by the read-ahead becomes the current one, and the
+    // consumed one is used for the next read-ahead.
+    this->m_CurrentIndex ^= 1;
+    this->m_CurrentSize = NumberOfBytesTransferred;
+    this->m_FileOffset += NumberOfBytesTransferred;
+
+    if (!NumberOfBytesTransferred)
+    {
+        this->m_EndOfFile = true;
+        return true;
+    }
+
+    return this->IssueReadAhead();
+}
+
+Mile::FileReader::FileReader(
+    _In_ std::size_t BufferSize) :
+    m_FileHandle(INVALID_HANDLE_VALUE),
+    m_OwnsFileHandle(false),
+    m_Event(nullptr),
+    m_Overlapped(),
+    m_BufferSize(::GetFileStreamBufferSize(BufferSize)),
+    m_CurrentIndex(0),
+    m_CurrentOffset(0),
+    m_CurrentSize(0),
+    m_FileOffset(0),
+    m_ReadAheadPending(false),
+    m_EndOfFile(false)
+{
+}
+
+Mile::FileReader::~FileReader()
+{
+    this->Close();
+
+    if (this->m_Event)
+    {
+        ::CloseHandle(this->m_Event);
+    }
+}
+
+bool Mile::FileReader::Open(
+    _In_ LPCWSTR FileName,
+    _In_ FileAccessPattern AccessPattern)
+{
+    HANDLE FileHandle = ::MileCreateFile(
+        FileName,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL
+        | FILE_FLAG_OVERLAPPED
+        | ::GetFileAccessPatternFlags(AccessPattern),
+        nullptr);
+    if (INVALID_HANDLE_VALUE == FileHandle)
+    {
+        return false;
+    }
+
+    return this->Attach(FileHandle, true, 0);
+}
+
+bool Mile::FileReader::Attach(
+    _In_ HANDLE FileHandle,
+    _In_ bool TakeOwnership,
+    _In_ std::uint64_t Offset)
+{
+    this->Close();
+
+    if (!FileHandle || INVALID_HANDLE_VALUE == FileHandle)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return false;
+    }
+
+    if (!this->Initialize())
+    {
+        if (TakeOwnership)
+        {
+            ::CloseHandle(FileHandle);
+        }
+        return false;
+    }
+
+    this->m_FileHandle = FileHandle;
+    this->m_OwnsFileHandle = TakeOwnership;
+    this->m_FileOffset = Offset;
+
+    return this->IssueReadAhead();
+}
+
+void Mile::FileReader::Close()
+{
+    if (INVALID_HANDLE_VALUE == this->m_FileHandle)
+    {
+        return;
+    }
+
+    if (this->m_ReadAheadPending)
+    {
+        ::CancelIoEx(this->m_FileHandle, &this->m_Overlapped);
+        DWORD NumberOfBytesTransferred = 0;
+        ::GetOverlappedResult(
+            this->m_FileHandle,
+            &this->m_Overlapped,
+            &NumberOfBytesTransferred,
+            TRUE);
+        this->m_ReadAheadPending = false;
+    }
+
+    if (this->m_OwnsFileHandle)
+    {
+        ::CloseHandle(this->m_FileHandle);
+    }
+    this->m_FileHandle = INVALID_HANDLE_VALUE;
+    this->m_OwnsFileHandle = false;
+}
+
+bool Mile::FileReader::Read(
+    _Out_ void* Buffer,
+    _In_ std::size_t Size,
+    _Out_ std::size_t& NumberOfBytesRead)
+{
+    NumberOfBytesRead = 0;
+
+    if (INVALID_HANDLE_VALUE == this->m_FileHandle)
+    {
+        ::SetLastError(ERROR_INVALID_HANDLE);
+        return false;
+    }
+
+    std::uint8_t* Output = reinterpret_cast<std::uint8_t*>(Buffer);
+    while (NumberOfBytesRead < Size)
+    {
+        if (this->m_CurrentOffset == this->m_CurrentSize)
+        {
+            if (!this->FillBuffer())
+            {
+                return false;
+            }
+            if (!this->m_CurrentSize)
+            {
+                break;
+            }
+        }
+
+        std::size_t Available = this->m_CurrentSize - this->m_CurrentOffset;
+        std::size_t Required = Size - NumberOfBytesRead;
+        std::size_t Count = Available < Required ? Available : Required;
+        std::memcpy(
+            Output + NumberOfBytesRead,
+            this->m_Buffers[this->m_CurrentIndex].data()
+            + this->m_CurrentOffset,
+            Count);
+        this->m_CurrentOffset += Count;
+        NumberOfBytesRead += Count;
+    }
+
+    return true;
+}
+
+bool Mile::FileReader::ReadLine(
+    _Out_ std::string& Line)
+{
+    Line.clear();
+
+    if (INVALID_HANDLE_VALUE == this->m_FileHandle)
+    {
+        ::SetLastError(ERROR_INVALID_HANDLE);
+        return false;
+    }
+
+    bool Consumed = false;
+    for (;;)
+    {
+        if (this->m_CurrentOffset == this->m_CurrentSize)
+        {
+            if (!this->FillBuffer())
+            {
+                return false;
+            }
+            if (!this->m_CurrentSize)
+            {
+                break;
+            }
+        }
+
+        const char* Begin = reinterpret_cast<const char*>(
+            this->m_Buffers[this->m_CurrentIndex].data()
+            + this->m_CurrentOffset);
+        std::size_t Available = this->m_CurrentSize - this->m_CurrentOffset;
+        const char* LineFeed = reinterpret_cast<const char*>(
+            std::memchr(Begin, '\n', Available));
+        Consumed = true;
+        if (LineFeed)
+        {
+            Line.append(Begin, LineFeed);
+            this->m_CurrentOffset += LineFeed - Begin + 1;
+            break;
+        }
+        Line.append(Begin, Available);
+        this->m_CurrentOffset = this->m_CurrentSize;
+    }
+
+    if (!Consumed)
+    {
+        ::SetLastError(ERROR_HANDLE_EOF);
+        return false;
+    }
+
+    if (!Line.empty() && '\r' == Line.back())
+    {
+        Line.pop_back();
+    }
+
+    return true;
+}
+
+std::uint64_t Mile::FileReader::GetPosition() const
+{
+    return this->m_FileOffset - (this->m_CurrentSize - this->m_CurrentOffset);
+}
+
+bool Mile::FileWriter::Initialize()
+{
+    if (!this->m_Event)
+    {
+        this->m_Event = ::CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!this->m_Event)
+        {
+            return false;
+        }
+    }
+
+    for (std::vector<std::uint8_t>& Buffer : this->m_Buffers)
+    {
+        Buffer.resize(this->m_BufferSize);
+    }
+
+    this->m_CurrentIndex = 0;
+    this->m_CurrentSize = 0;
+    this->m_FileOffset = 0;
+    this->m_PendingOffset = 0;
+    this->m_PendingSize = 0;
+    this->m_WriteBehindPending = false;
+    this->m_SparseBlockSize = 0;
+    this->m_SkippedBytes = 0;
+
+    return true;
+}
+
+bool Mile::FileWriter::WaitWriteBehind()
+{
+    if (!this->m_WriteBehindPending)
+    {
+        return true;
+    }
+    this->m_WriteBehindPending = false;
+
+    DWORD NumberOfBytesTransferred = 0;
+    if (!::GetOverlappedResult(
+        this->m_FileHandle,
+        &this->m_Overlapped,
+        &NumberOfBytesTransferred,
+        TRUE))
+    {
+        return false;
+    }
+
+    if (NumberOfBytesTransferred < this->m_PendingSize)
+    {
+        // Complete the remainder of a partial write synchronously.
+        return ::MileWriteFileFull(
+            this->m_FileHandle,
+            this->m_Buffers[this->m_CurrentIndex ^ 1].data()
+            + NumberOfBytesTransferred,
+            this->m_PendingSize - NumberOfBytesTransferred,
+            this->m_PendingOffset + NumberOfBytesTransferred,
+            0,
+            1,
+            nullptr,
+            nullptr,
+            nullptr);
+    }
+
+    return true;
+}
+
+bool Mile::FileWriter::SubmitCurrentBuffer()
+{
+    if (!this->m_CurrentSize)
+    {
+        return true;
+    }
+
+    // The other buffer can only be reused after its write is completed.
+    if (!this->WaitWriteBehind())
+    {
+        return false;
+    }
+
+    if (this->m_SparseBlockSize)
+    {
+        if (!this->WriteSparse(
+            this->m_Buffers[this->m_CurrentIndex].data(),
+            this->m_CurrentSize))
+        {
+            return false;
+        }
+        this->m_CurrentSize = 0;
+        return true;
+    }
+
+    this->m_PendingOffset = this->m_FileOffset;
+    this->m_PendingSize = static_cast<DWORD>(this->m_CurrentSize);
+
+    this->m_Overlapped.Internal = 0;
+    this->m_Overlapped.InternalHigh = 0;
+    this->m_Overlapped.Offset = static_cast<DWORD>(this->m_PendingOffset);
+    this->m_Overlapped.OffsetHigh = static_cast<DWORD>(
+        this->m_PendingOffset >> 32);
+    // Keep the completion from being queued to the I/O completion port which
+    // may be associated with the file handle.
+    this->m_Overlapped.hEvent = reinterpret_cast<HANDLE>(
+        reinterpret_cast<ULONG_PTR>(this->m_Event) | 1);
+
+    if (!::WriteFile(
+        this->m_FileHandle,
+        this->m_Buffers[this->m_CurrentIndex].data(),
+        this->m_PendingSize,
+        nullptr,
+        &this->m_Overlapped))
+    {
+        if (ERROR_IO_PENDING != ::GetLastError())
+        {
+            return false;
+        }
+    }
+
+    this->m_WriteBehindPending = true;
+    this->m_FileOffset += this->m_CurrentSize;
+    this->m_CurrentIndex ^= 1;
+    this->m_CurrentSize = 0;
+
+    return true;
+}
+
+bool Mile::FileWriter::WriteSparse(
+    _In_ const std::uint8_t* Buffer,
+    _In_ std::size_t Size)
+{
+    // Split the write to fit the DWORD size, and keep the chunks aligned to
+    // the block size.
+    const std::size_t MaximumChunkSize =
+        (0x40000000 / this->m_SparseBlockSize) * this->m_SparseBlockSize;
+
+    while (Size)
+    {
+        DWORD ChunkSize = static_cast<DWORD>(
+            Size < MaximumChunkSize ? Size : MaximumChunkSize);
+        DWORD NumberOfBytesWritten = 0;
+        DWORD NumberOfBytesSkipped = 0;
+        BOOL Result = ::MileWriteFileSparseAt(
+            this->m_FileHandle,
+            Buffer,
+            ChunkSize,
+            this->m_FileOffset,
+            this->m_SparseBlockSize,
+            &NumberOfBytesWritten,
+            &NumberOfBytesSkipped);
+        this->m_FileOffset += NumberOfBytesWritten;
+        this->m_SkippedBytes += NumberOfBytesSkipped;
+        if (!Result)
+        {
+            return false;
+        }
+        Buffer += ChunkSize;
+        Size -= ChunkSize;
+    }
+
+    return true;
+}
+
+Mile::FileWriter::FileWriter(
+    _In_ std::size_t BufferSize) :
+    m_FileHandle(INVALID_HANDLE_VALUE),
+    m_OwnsFileHandle(false),
+    m_Event(nullptr),
+    m_Overlapped(),
+    m_BufferSize(::GetFileStreamBufferSize(BufferSize)),
+    m_CurrentIndex(0),
+    m_CurrentSize(0),
+    m_FileOffset(0),
+    m_PendingOffset(0),
+    m_PendingSize(0),
+    m_WriteBehindPending(false),
+    m_SparseBlockSize(0),
+    m_SkippedBytes(0)
+{
+}
+
+Mile::FileWriter::~FileWriter()
+{
+    this->Close();
+
+    if (this->m_Event)
+    {
+        ::CloseHandle(this->m_Event);
+    }
+}
+
+bool Mile::FileWriter::Open(
+    _In_ LPCWSTR FileName,
+    _In_ DWORD CreationDisposition,
+    _In_ FileAccessPattern AccessPattern)
+{
+    HANDLE FileHandle = ::MileCreateFile(
+        FileName,
+        GENERIC_WRITE,
+        FILE_SHARE_READ,
+        nullptr,
+        CreationDisposition,
+        FILE_ATTRIBUTE_NORMAL
+        | FILE_FLAG_OVERLAPPED
+        | ::GetFileAccessPatternFlags(AccessPattern),
+        nullptr);
+    if (INVALID_HANDLE_VALUE == FileHandle)
+    {
+        return false;
+    }
+
+    return this->Attach(FileHandle, true, 0);
+}
+
+bool Mile::FileWriter::Attach(
+    _In_ HANDLE FileHandle,
+    _In_ bool TakeOwnership,
+    _In_ std::uint64_t Offset)
+{
+    this->Close();
+
+    if (!FileHandle || INVALID_HANDLE_VALUE == FileHandle)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return false;
+    }
+
+    if (!this->Initialize())
+    {
+        if (TakeOwnership)
+        {
+            ::CloseHandle(FileHandle);
+        }
+        return false;
+    }
+
+    this->m_FileHandle = FileHandle;
+    this->m_OwnsFileHandle = TakeOwnership;
+    this->m_FileOffset = Offset;
+
+    return true;
+}
+
+bool Mile::FileWriter::Close()
+{
+    if (INVALID_HANDLE_VALUE == this->m_FileHandle)
+    {
+        return true;
+    }
+
+    bool Result = this->Flush(false);
+    DWORD LastError = Result ? ERROR_SUCCESS : ::GetLastError();
+
+    if (this->m_OwnsFileHandle)
+    {
+        ::CloseHandle(this->m_FileHandle);
+    }
+    this->m_FileHandle = INVALID_HANDLE_VALUE;
+    this->m_OwnsFileHandle = false;
+
+    if (!Result)
+    {
+        ::SetLastError(LastError);
+    }
+
+    return Result;
+}
+
+bool Mile::FileWriter::Write(
+    _In_ const void* Buffer,
+    _In_ std::size_t Size)
+{
+    if (INVALID_HANDLE_VALUE == this->m_FileHandle)
+    {
+        ::SetLastError(ERROR_INVALID_HANDLE);
+        return false;
+    }
+
+    const std::uint8_t* Input = reinterpret_cast<const std::uint8_t*>(Buffer);
+    while (Size)
+    {
+        if (!this->m_CurrentSize && Size >= this->m_BufferSize)
+        {
+            // Large writes bypass the buffer to avoid the extra copy.
+            if (!this->WaitWriteBehind())
+            {
+                return false;
+            }
+
+            if (this->m_SparseBlockSize)
+            {
+                return this->WriteSparse(Input, Size);
+            }
+
+            ULONGLONG NumberOfBytesWritten = 0;
+            BOOL Result = ::MileWriteFileFull(
+                this->m_FileHandle,
+                Input,
+                Size,
+                this->m_FileOffset,
+                0,
+                0,
+                &NumberOfBytesWritten,
+                nullptr,
+                nullptr);
+            this->m_FileOffset += NumberOfBytesWritten;
+            return Result ? true : false;
+        }
+
+        std::size_t Available = this->m_BufferSize - this->m_CurrentSize;
+        std::size_t Count = Available < Size ? Available : Size;
+        std::memcpy(
+            this->m_Buffers[this->m_CurrentIndex].data() + this->m_CurrentSize,
+            Input,
+            Count);
+        this->m_CurrentSize += Count;
+        Input += Count;
+        Size -= Count;
+
+        if (this->m_CurrentSize == this->m_BufferSize)
+        {
+            if (!this->SubmitCurrentBuffer())
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool Mile::FileWriter::Flush(
+    _In_ bool Durable)
+{
+    if (INVALID_HANDLE_VALUE == this->m_FileHandle)
+    {
+        ::SetLastError(ERROR_INVALID_HANDLE);
+        return false;
+    }
+
+    if (!this->SubmitCurrentBuffer() || !this->WaitWriteBehind())
+    {
+        return false;
+    }
+
+    if (Durable && !::FlushFileBuffers(this->m_FileHandle))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+std::uint64_t Mile::FileWriter::GetPosition() const
+{
+    return this->m_FileOffset + this->m_CurrentSize;
+}
+
+bool Mile::FileWriter::EnableSparseWrite(
+    _In_ std::size_t BlockSize)
+{
+    if (INVALID_HANDLE_VALUE == this->m_FileHandle)
+    {
+        ::SetLastError(ERROR_INVALID_HANDLE);
+        return false;
+    }
+
+    if (BlockSize > 0x40000000)
+    {
+        ::SetLastError(ERROR_INVALID_PARAMETER);
+        return false;
+    }
+
+    FILE_SET_SPARSE_BUFFER SparseBuffer;
+    SparseBuffer.SetSparse = TRUE;
+    if (!::MileDeviceIoControl(
+        this->m_FileHandle,
+        FSCTL_SET_SPARSE,
+        &SparseBuffer,
+        sizeof(SparseBuffer),
+        nullptr,
+        0,
+        nullptr))
+    {
+        return false;
+    }
+
+    this->m_SparseBlockSize = BlockSize
+        ? static_cast<DWORD>(BlockSize)
+        : 64 * 1024;
+
+    return true;
+}
+
+std::uint64_t Mile::FileWriter::GetSkippedBytes() const
+{
+    return this->m_SkippedBytes;
+}
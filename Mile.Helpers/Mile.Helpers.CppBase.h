@@ -18,9 +18,22 @@
 /* Include IUnknown interface definition when WIN32_LEAN_AND_MEAN is defined */
 #include <unknwn.h>
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define MILE_WINDOWS_HELPERS_CPPBASE_COROUTINE
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <system_error>
+#endif // __cpp_impl_coroutine
+
 namespace Mile
 {
     /**
@@ -252,6 +265,102 @@ namespace Mile
             lpThreadId);
     }
 
+    /**
+     * @brief The lightweight view of a found file or directory, which points
+     *        into the enumeration buffer and is only valid in the callback.
+     *        The accessors return zero or empty values for the fields which
+     *        are not contained in the queried information class.
+    */
+    class FileEnumerateEntry
+    {
+    private:
+
+        PMILE_FILE_ENUMERATE_VIEW m_View;
+
+    public:
+
+        /**
+         * @brief Creates the file enumerate entry from the view.
+         * @param View The file enumerate view.
+        */
+        explicit FileEnumerateEntry(
+            _In_ PMILE_FILE_ENUMERATE_VIEW View);
+
+        /**
+         * @brief Retrieves the file name, which is not truncated.
+         * @return The file name.
+        */
+        std::wstring_view GetFileName() const;
+
+        /**
+         * @brief Retrieves the short 8.3 file name.
+         * @return The short file name, which is empty if not available or not
+         *         queried.
+        */
+        std::wstring_view GetShortName() const;
+
+        /**
+         * @brief Retrieves the file attributes.
+         * @return The file attributes.
+        */
+        DWORD GetAttributes() const;
+
+        /**
+         * @brief Determines whether the entry is a directory.
+         * @return true if the entry is a directory, false otherwise.
+        */
+        bool IsDirectory() const;
+
+        /**
+         * @brief Retrieves the file size.
+         * @return The file size in bytes.
+        */
+        std::uint64_t GetFileSize() const;
+
+        /**
+         * @brief Retrieves the allocation size.
+         * @return The allocation size in bytes.
+        */
+        std::uint64_t GetAllocationSize() const;
+
+        /**
+         * @brief Retrieves the creation time.
+         * @return The creation time.
+        */
+        FILETIME GetCreationTime() const;
+
+        /**
+         * @brief Retrieves the last access time.
+         * @return The last access time.
+        */
+        FILETIME GetLastAccessTime() const;
+
+        /**
+         * @brief Retrieves the last write time.
+         * @return The last write time.
+        */
+        FILETIME GetLastWriteTime() const;
+
+        /**
+         * @brief Retrieves the change time.
+         * @return The change time.
+        */
+        FILETIME GetChangeTime() const;
+
+        /**
+         * @brief Retrieves the 64-bit file ID.
+         * @return The file ID. For the 128-bit file ID, the low 64 bits are
+         *         returned.
+        */
+        std::uint64_t GetFileId() const;
+
+        /**
+         * @brief Retrieves the underlying file enumerate view.
+         * @return The file enumerate view.
+        */
+        PMILE_FILE_ENUMERATE_VIEW GetView() const;
+    };
+
     /**
      * @brief Enumerates files in a directory.
      * @tparam CallbackType The callback type.
@@ -268,37 +377,217 @@ namespace Mile
         _In_ HANDLE FileHandle,
         _In_ CallbackType&& CallbackFunction)
     {
-        BOOL Result = FALSE;
+        using CallbackObjectType = std::remove_reference_t<CallbackType>;
 
-        CallbackType* CallbackObject = new CallbackType(
-            std::move(CallbackFunction));
-        if (CallbackObject)
+        auto FileEnumerateCallback = [](
+            _In_ PMILE_FILE_ENUMERATE_INFORMATION Information,
+            _In_opt_ LPVOID Context) -> BOOL
         {
-            auto FileEnumerateCallback = [](
-                _In_ PMILE_FILE_ENUMERATE_INFORMATION Information,
-                _In_opt_ LPVOID Context) -> BOOL
-            {
-                auto Callback = reinterpret_cast<CallbackType*>(Context);
-                BOOL Result = (*Callback)(Information);
+            auto Callback = static_cast<CallbackObjectType*>(Context);
+            BOOL Result = (*Callback)(Information);
 
-                return Result;
-            };
+            return Result;
+        };
 
-            Result = ::MileEnumerateFileByHandle(
-                FileHandle,
-                FileEnumerateCallback,
-                reinterpret_cast<LPVOID>(CallbackObject));
+        return ::MileEnumerateFileByHandle(
+            FileHandle,
+            FileEnumerateCallback,
+            const_cast<LPVOID>(static_cast<LPCVOID>(&CallbackFunction)));
+    }
 
-            delete CallbackObject;
-        }
-        else
+    /**
+     * @brief Enumerates files in a directory without copying the information
+     *        of each file, with the lightest information class which contains
+     *        the required fields and the specified buffer size.
+     * @tparam CallbackType The callback type, which is called with a
+     *                      Mile::FileEnumerateEntry and returns whether to
+     *                      continue the enumeration.
+     * @param FileHandle The handle of the file to be searched a directory for
+     *                   a file or subdirectory with a name. This handle must
+     *                   be opened with the appropriate permissions for the
+     *                   requested change. This handle should not be a pipe
+     *                   handle.
+     * @param Fields The required fields, which can be zero or a combination
+     *               of the MILE_FILE_ENUMERATE_FIELD_* values, optionally
+     *               combined with MILE_FILE_ENUMERATE_FLAG_DOUBLE_BUFFERED.
+     * @param BufferSize The size in bytes of the enumeration buffer. If this
+     *                   parameter is zero, 32 KiB will be used.
+     * @param CallbackFunction The file enumerate callback function.
+     * @return If the function succeeds, the return value is TRUE. If the
+     *         function fails, the return value is FALSE. To get extended
+     *         error information, call GetLastError.
+    */
+    template<class CallbackType>
+    BOOL EnumerateFileByHandleEx(
+        _In_ HANDLE FileHandle,
+        _In_ DWORD Fields,
+        _In_ std::size_t BufferSize,
+        _In_ CallbackType&& CallbackFunction)
+    {
+        using CallbackObjectType = std::remove_reference_t<CallbackType>;
+
+        auto FileEnumerateCallback = [](
+            _In_ PMILE_FILE_ENUMERATE_VIEW View,
+            _In_opt_ LPVOID Context) -> BOOL
         {
-            ::SetLastError(ERROR_OUTOFMEMORY);
-        }
+            auto Callback = static_cast<CallbackObjectType*>(Context);
+            return (*Callback)(Mile::FileEnumerateEntry(View)) ? TRUE : FALSE;
+        };
+
+        return ::MileEnumerateFileByHandleEx(
+            FileHandle,
+            Fields,
+            BufferSize,
+            FileEnumerateCallback,
+            const_cast<LPVOID>(static_cast<LPCVOID>(&CallbackFunction)));
+    }
+
+    /**
+     * @brief Enumerates files in a directory without copying the information
+     *        of each file.
+     * @tparam CallbackType The callback type, which is called with a
+     *                      Mile::FileEnumerateEntry and returns whether to
+     *                      continue the enumeration.
+     * @param FileHandle The handle of the file to be searched a directory for
+     *                   a file or subdirectory with a name. This handle must
+     *                   be opened with the appropriate permissions for the
+     *                   requested change. This handle should not be a pipe
+     *                   handle.
+     * @param CallbackFunction The file enumerate callback function.
+     * @return If the function succeeds, the return value is TRUE. If the
+     *         function fails, the return value is FALSE. To get extended
+     *         error information, call GetLastError.
+    */
+    template<class CallbackType>
+    BOOL EnumerateFileViewByHandle(
+        _In_ HANDLE FileHandle,
+        _In_ CallbackType&& CallbackFunction)
+    {
+        return Mile::EnumerateFileByHandleEx(
+            FileHandle,
+            MILE_FILE_ENUMERATE_FIELD_ALL,
+            0,
+            std::forward<CallbackType>(CallbackFunction));
+    }
+
+    /**
+     * @brief Enumerates files in a directory like
+     *        Mile::EnumerateFileByHandleEx, but the callback is called once per
+     *        fill of the enumeration buffer with all decoded entries.
+     * @tparam CallbackType The callback type, which is called with a
+     *                      PMILE_FILE_ENUMERATE_VIEW array and the number of
+     *                      elements, and returns whether to continue the
+     *                      enumeration.
+     * @param FileHandle The handle of the file to be searched a directory for
+     *                   a file or subdirectory with a name. This handle must
+     *                   be opened with the appropriate permissions for the
+     *                   requested change. This handle should not be a pipe
+     *                   handle.
+     * @param Fields The required fields, which can be zero or a combination
+     *               of the MILE_FILE_ENUMERATE_FIELD_* values, optionally
+     *               combined with MILE_FILE_ENUMERATE_FLAG_DOUBLE_BUFFERED.
+     * @param BufferSize The size in bytes of the enumeration buffer. If this
+     *                   parameter is zero, 32 KiB will be used.
+     * @param CallbackFunction The file enumerate batch callback function.
+     * @return If the function succeeds, the return value is TRUE. If the
+     *         function fails, the return value is FALSE. To get extended
+     *         error information, call GetLastError.
+    */
+    template<class CallbackType>
+    BOOL EnumerateFileBatchByHandle(
+        _In_ HANDLE FileHandle,
+        _In_ DWORD Fields,
+        _In_ std::size_t BufferSize,
+        _In_ CallbackType&& CallbackFunction)
+    {
+        using CallbackObjectType = std::remove_reference_t<CallbackType>;
+
+        auto FileEnumerateCallback = [](
+            _In_ PMILE_FILE_ENUMERATE_VIEW Views,
+            _In_ SIZE_T Count,
+            _In_opt_ LPVOID Context) -> BOOL
+        {
+            auto Callback = static_cast<CallbackObjectType*>(Context);
+            return (*Callback)(Views, Count) ? TRUE : FALSE;
+        };
+
+        return ::MileEnumerateFileBatchByHandle(
+            FileHandle,
+            Fields,
+            BufferSize,
+            FileEnumerateCallback,
+            const_cast<LPVOID>(static_cast<LPCVOID>(&CallbackFunction)));
+    }
+
+    /**
+     * @brief Walks a directory tree recursively.
+     * @tparam CallbackType The callback type, which is called with a
+     *                      PMILE_WALK_DIRECTORY_TREE_ENTRY and returns a
+     *                      MILE_WALK_DIRECTORY_TREE_ACTION value.
+     * @param RootDirectoryHandle The handle of the root directory. This handle
+     *                            must be opened with the FILE_LIST_DIRECTORY
+     *                            access right.
+     * @param Flags The flags, which can be zero or a combination of the
+     *              MILE_WALK_DIRECTORY_TREE_FLAG_* values.
+     * @param Fields The required fields, which can be zero or a combination
+     *               of the MILE_FILE_ENUMERATE_FIELD_* values.
+     * @param MaximumDepth The maximum depth of the entries to be reported.
+     * @param MaximumConcurrency The maximum number of the concurrent workers.
+     *                           If this parameter is zero, the number of
+     *                           hardware threads will be used.
+     * @param CallbackFunction The directory tree walk callback function,
+     *                         which may be called concurrently from multiple
+     *                         threads unless the deterministic flag is
+     *                         specified.
+     * @return If the function succeeds, the return value is TRUE. If the
+     *         function fails, the return value is FALSE. To get extended
+     *         error information, call GetLastError.
+    */
+    template<class CallbackType>
+    BOOL WalkDirectoryTree(
+        _In_ HANDLE RootDirectoryHandle,
+        _In_ DWORD Flags,
+        _In_ DWORD Fields,
+        _In_ DWORD MaximumDepth,
+        _In_ DWORD MaximumConcurrency,
+        _In_ CallbackType&& CallbackFunction)
+    {
+        using CallbackObjectType = std::remove_reference_t<CallbackType>;
+
+        auto WalkCallback = [](
+            _In_ PMILE_WALK_DIRECTORY_TREE_ENTRY Entry,
+            _In_opt_ LPVOID Context) -> MILE_WALK_DIRECTORY_TREE_ACTION
+        {
+            auto Callback = static_cast<CallbackObjectType*>(Context);
+            return (*Callback)(Entry);
+        };
 
-        return Result;
+        return ::MileWalkDirectoryTree(
+            RootDirectoryHandle,
+            Flags,
+            Fields,
+            MaximumDepth,
+            MaximumConcurrency,
+            WalkCallback,
+            const_cast<LPVOID>(static_cast<LPCVOID>(&CallbackFunction)));
     }
 
+    /**
+     * @brief Retrieves the path of a file or directory by its 64-bit file ID.
+     * @param VolumeHandle The handle of any file or directory on the volume
+     *                     which contains the file.
+     * @param FileId The 64-bit file ID of the file, which can be the result of
+     *               Mile::FileEnumerateEntry::GetFileId.
+     * @param Flags The type of the result, which is the same as the dwFlags
+     *              parameter of GetFinalPathNameByHandleW.
+     * @return The path of the file, or an empty string if failed. To get
+     *         extended error information, call GetLastError.
+    */
+    std::wstring GetFilePathById(
+        _In_ HANDLE VolumeHandle,
+        _In_ std::uint64_t FileId,
+        _In_ DWORD Flags = FILE_NAME_NORMALIZED | VOLUME_NAME_DOS);
+
     /**
      * @brief Converts from the onebyte or multibyte string to the Int32 integer.
      * @param Source The onebyte or multibyte string.
@@ -512,6 +801,1477 @@ namespace Mile
             return CurrentReferenceCount;
         }
     };
+
+    /**
+     * @brief The hierarchical timer wheel for scheduling a large number of
+     *        timeouts with O(1) insertion and cancellation.
+     * @remark The wheel is driven by a monotonic millisecond clock, which is
+     *         MileGetTickCount by default. Expired callbacks are dispatched to
+     *         the system thread pool by default.
+    */
+    class TimerWheel :
+        DisableCopyConstruction,
+        DisableMoveConstruction
+    {
+    public:
+
+        /**
+         * @brief The identifier type of the scheduled timer.
+        */
+        using TimerId = std::uint64_t;
+
+        /**
+         * @brief The callback type invoked when the timer is expired.
+        */
+        using CallbackType = std::function<void()>;
+
+        /**
+         * @brief The monotonic clock type, which returns the current time in
+         *        milliseconds.
+        */
+        using ClockType = std::function<std::uint64_t()>;
+
+        /**
+         * @brief The dispatcher type, which is used for invoking the expired
+         *        callbacks.
+        */
+        using DispatcherType = std::function<void(CallbackType&&)>;
+
+        /**
+         * @brief The identifier which never refers to a scheduled timer.
+        */
+        static constexpr TimerId InvalidTimerId = 0;
+
+    private:
+
+        static constexpr std::size_t LevelCount = 4;
+        static constexpr std::size_t SlotBits = 8;
+        static constexpr std::size_t SlotCount = 1 << SlotBits;
+        static constexpr std::uint64_t SlotMask = SlotCount - 1;
+
+        struct Entry
+        {
+            Entry* Next;
+            Entry** PreviousNext;
+            TimerId Id;
+            std::uint64_t ExpiryTick;
+            CallbackType Callback;
+        };
+
+        SRWLOCK m_Lock;
+        std::uint64_t m_TickInterval;
+        ClockType m_Clock;
+        DispatcherType m_Dispatcher;
+        std::uint64_t m_StartTime;
+        std::uint64_t m_CurrentTick;
+        TimerId m_NextTimerId;
+        Entry* m_Slots[LevelCount][SlotCount];
+        std::unordered_map<TimerId, Entry*> m_Entries;
+        HANDLE m_DriverThread;
+        HANDLE m_DriverStopEvent;
+
+        std::uint64_t GetElapsedTicks();
+
+        void InsertEntry(
+            _In_ Entry* Item);
+
+        void RemoveEntry(
+            _In_ Entry* Item);
+
+        void CascadeSlot(
+            _In_ std::size_t Level,
+            _In_ std::size_t Slot);
+
+        void CollectExpiredSlot(
+            _In_ std::size_t Slot,
+            _Inout_ std::vector<CallbackType>& ExpiredCallbacks);
+
+    public:
+
+        /**
+         * @brief Creates the timer wheel instance.
+         * @param TickInterval The granularity of the timer wheel, in
+         *                     milliseconds. If this parameter is zero, one
+         *                     millisecond will be used.
+         * @param Clock The monotonic clock in milliseconds. If this parameter
+         *              is empty, MileGetTickCount will be used. Specify a fake
+         *              clock and call Advance manually for deterministic
+         *              testing.
+         * @param Dispatcher The dispatcher for the expired callbacks. If this
+         *                   parameter is empty, the callbacks will be
+         *                   submitted to the system thread pool.
+        */
+        explicit TimerWheel(
+            _In_ std::uint64_t TickInterval = 10,
+            _In_ ClockType const& Clock = nullptr,
+            _In_ DispatcherType const& Dispatcher = nullptr);
+
+        /**
+         * @brief Stops the driver thread and discards all pending timers
+         *        without invoking them.
+        */
+        ~TimerWheel();
+
+        /**
+         * @brief Schedules a callback which will be invoked after the
+         *        specified timeout.
+         * @param Timeout The timeout in milliseconds. The timeout will be
+         *                rounded up to the tick interval.
+         * @param Callback The callback to be invoked when expired.
+         * @return The identifier of the scheduled timer, or InvalidTimerId if
+         *         the callback is empty.
+        */
+        TimerId Schedule(
+            _In_ std::uint64_t Timeout,
+            _In_ CallbackType&& Callback);
+
+        /**
+         * @brief Cancels a scheduled timer.
+         * @param Id The identifier of the scheduled timer.
+         * @return true if the timer is cancelled, false if the timer is not
+         *         found, already expired or already cancelled.
+        */
+        bool Cancel(
+            _In_ TimerId Id);
+
+        /**
+         * @brief Processes all ticks elapsed according to the clock and
+         *        dispatches the expired callbacks.
+         * @return The number of dispatched callbacks.
+        */
+        std::size_t Advance();
+
+        /**
+         * @brief Retrieves the granularity of the timer wheel.
+         * @return The tick interval in milliseconds.
+        */
+        std::uint64_t GetTickInterval() const;
+
+        /**
+         * @brief Retrieves the number of pending timers.
+         * @return The number of pending timers.
+        */
+        std::size_t GetPendingCount();
+
+        /**
+         * @brief Starts a driver thread which calls Advance every tick.
+         * @return true if the driver thread is running, false otherwise. To
+         *         get extended error information, call GetLastError.
+        */
+        bool Start();
+
+        /**
+         * @brief Stops the driver thread if started.
+        */
+        void Stop();
+    };
+
+    /**
+     * @brief The process-wide epoch-based memory reclamation facility. Readers
+     *        enter an epoch without taking any lock, and writers retire the
+     *        unlinked objects which will be destroyed after all readers which
+     *        may observe them have left.
+    */
+    class Epoch
+    {
+    public:
+
+        /**
+         * @brief The deleter type for the retired objects.
+        */
+        using DeleterType = void(*)(void*);
+
+        /**
+         * @brief Enters the epoch when constructed and leaves the epoch when
+         *        destructed.
+        */
+        class Guard :
+            DisableCopyConstruction,
+            DisableMoveConstruction
+        {
+        public:
+
+            Guard()
+            {
+                Epoch::Enter();
+            }
+
+            ~Guard()
+            {
+                Epoch::Leave();
+            }
+        };
+
+        /**
+         * @brief Enters the epoch for the current thread. The objects read
+         *        after entering will not be destroyed until leaving. Nested
+         *        calls are allowed.
+        */
+        static void Enter();
+
+        /**
+         * @brief Leaves the epoch for the current thread.
+        */
+        static void Leave();
+
+        /**
+         * @brief Retires an object which has been unlinked from the shared
+         *        data structure. The object will be destroyed when no reader
+         *        can observe it.
+         * @param Object The object to be retired.
+         * @param Deleter The deleter to destroy the object.
+        */
+        static void Retire(
+            _In_ void* Object,
+            _In_ DeleterType Deleter);
+
+        /**
+         * @brief Retires an object allocated by the new operator.
+         * @tparam Type The type of the object.
+         * @param Object The object to be retired.
+        */
+        template<typename Type>
+        static void Retire(
+            _In_ Type* Object)
+        {
+            Epoch::Retire(
+                const_cast<void*>(static_cast<void const*>(Object)),
+                [](void* Pointer)
+            {
+                delete static_cast<Type*>(Pointer);
+            });
+        }
+
+        /**
+         * @brief Tries to advance the global epoch and destroys the retired
+         *        objects which are no longer observable.
+         * @return The number of destroyed objects.
+        */
+        static std::size_t Reclaim();
+
+        /**
+         * @brief Waits until all readers which entered before the call have
+         *        left, then destroys the retired objects which are no longer
+         *        observable. This function must not be called within the
+         *        epoch.
+        */
+        static void Synchronize();
+
+        /**
+         * @brief Starts the periodic background reclamation on the system
+         *        thread pool.
+         * @param Interval The reclamation interval, in milliseconds.
+         * @return true if the background reclamation is running, false
+         *         otherwise. To get extended error information, call
+         *         GetLastError.
+        */
+        static bool StartBackgroundReclamation(
+            _In_ std::uint32_t Interval = 100);
+
+        /**
+         * @brief Stops the periodic background reclamation if started.
+        */
+        static void StopBackgroundReclamation();
+    };
+
+    /**
+     * @brief The pointer wrapper for read-copy-update style shared objects.
+     *        Readers get lock-free snapshots within the epoch, and writers
+     *        swap in new versions and retire the old ones via Mile::Epoch.
+     * @tparam Type The type of the shared object.
+    */
+    template<typename Type>
+    class RcuPtr :
+        DisableCopyConstruction,
+        DisableMoveConstruction
+    {
+    private:
+
+        std::atomic<Type*> m_Pointer;
+
+    public:
+
+        /**
+         * @brief Creates the instance with the initial version.
+         * @param Initial The initial version allocated by the new operator,
+         *                or nullptr.
+        */
+        explicit RcuPtr(
+            _In_opt_ Type* Initial = nullptr) :
+            m_Pointer(Initial)
+        {
+
+        }
+
+        /**
+         * @brief Retires the current version.
+        */
+        ~RcuPtr()
+        {
+            Type* Current = this->m_Pointer.exchange(nullptr);
+            if (Current)
+            {
+                Epoch::Retire(Current);
+            }
+        }
+
+        /**
+         * @brief Gets the current version. The caller must be within the
+         *        epoch for as long as the returned pointer is used.
+         * @return The current version, or nullptr.
+        */
+        Type const* Get() const
+        {
+            return this->m_Pointer.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Invokes a function with the current version within the
+         *        epoch.
+         * @tparam FuncType The function type.
+         * @param Function The function which receives the current version,
+         *                 which may be nullptr.
+         * @return The return value of the function.
+        */
+        template<class FuncType>
+        auto Read(
+            _In_ FuncType&& Function) const
+        {
+            Epoch::Guard CurrentGuard;
+            return Function(this->Get());
+        }
+
+        /**
+         * @brief Swaps in a new version and retires the old one.
+         * @param NewValue The new version allocated by the new operator, or
+         *                 nullptr.
+        */
+        void Update(
+            _In_opt_ Type* NewValue)
+        {
+            Type* Previous = this->m_Pointer.exchange(
+                NewValue,
+                std::memory_order_acq_rel);
+            if (Previous)
+            {
+                Epoch::Retire(Previous);
+            }
+        }
+    };
+
+    /**
+     * @brief The result of the asynchronous I/O operation.
+    */
+    struct IoResult
+    {
+        /**
+         * @brief The Win32 error code, ERROR_SUCCESS if succeeded.
+        */
+        DWORD Error;
+
+        /**
+         * @brief The number of bytes transferred.
+        */
+        DWORD BytesTransferred;
+    };
+
+    /**
+     * @brief The overlapped operation which is completed through the
+     *        completion port executor.
+    */
+    struct CompletionPortOperation
+    {
+        /**
+         * @brief The overlapped structure passed to the I/O function. It must
+         *        be the first member.
+        */
+        OVERLAPPED Overlapped;
+
+        /**
+         * @brief The handle which the operation is issued on.
+        */
+        HANDLE Handle;
+
+        /**
+         * @brief The routine invoked on the executor thread when the operation
+         *        is completed.
+        */
+        void (*CompletionRoutine)(
+            _In_ CompletionPortOperation* Operation,
+            _In_ DWORD Error,
+            _In_ DWORD BytesTransferred);
+
+        /**
+         * @brief The next pending operation registered in the same
+         *        cancellation source.
+        */
+        CompletionPortOperation* CancellationNext;
+    };
+
+    /**
+     * @brief The executor which dispatches the completed overlapped operations
+     *        from an I/O completion port in batches.
+    */
+    class CompletionPortExecutor :
+        DisableCopyConstruction,
+        DisableMoveConstruction
+    {
+    private:
+
+        HANDLE m_CompletionPort;
+        volatile LONG m_PendingStopRequests;
+
+        std::size_t ProcessCompletions(
+            _In_ DWORD Timeout,
+            _Out_ ULONG& NumberOfStopRequests,
+            _Out_ bool& WaitFailed);
+
+    public:
+
+        /**
+         * @brief Creates the executor instance.
+         * @param NumberOfConcurrentThreads The maximum number of threads that
+         *                                  the operating system can allow to
+         *                                  concurrently process completions.
+        */
+        explicit CompletionPortExecutor(
+            _In_ DWORD NumberOfConcurrentThreads = 1);
+
+        /**
+         * @brief Closes the completion port.
+        */
+        ~CompletionPortExecutor();
+
+        /**
+         * @brief Indicates if the completion port is created successfully.
+         * @return true if the executor is usable, false otherwise.
+        */
+        bool IsValid() const;
+
+        /**
+         * @brief Associates a handle with the executor. The handle must be
+         *        opened with FILE_FLAG_OVERLAPPED or WSA_FLAG_OVERLAPPED.
+         * @param FileHandle The file, device or socket handle.
+         * @return true if succeeded, false otherwise. To get extended error
+         *         information, call GetLastError.
+        */
+        bool Bind(
+            _In_ HANDLE FileHandle);
+
+        /**
+         * @brief Waits for and dispatches a batch of completed operations.
+         *        The stop requests dequeued by this call are kept for the
+         *        following Run calls instead of being posted again.
+         * @param Timeout The number of milliseconds to wait.
+         * @param WaitFailed Optional, set to true if the wait on the
+         *                   completion port failed without timing out. To get
+         *                   extended error information, call GetLastError.
+         * @return The number of dispatched operations.
+        */
+        std::size_t RunOnce(
+            _In_ DWORD Timeout = INFINITE,
+            _Out_opt_ bool* WaitFailed = nullptr);
+
+        /**
+         * @brief Dispatches the completed operations until Stop is called, or
+         *        until the wait on the completion port fails. It returns
+         *        immediately if a stop request has been dequeued by RunOnce.
+        */
+        void Run();
+
+        /**
+         * @brief Requests one running Run call to return.
+        */
+        void Stop();
+    };
+
+    /**
+     * @brief The cancellation source for the asynchronous I/O operations.
+    */
+    class IoCancellation :
+        DisableCopyConstruction,
+        DisableMoveConstruction
+    {
+    private:
+
+        SRWLOCK m_Lock;
+        bool m_Cancelled;
+        CompletionPortOperation* m_PendingOperations;
+
+        template<typename IssuerType>
+        friend class IoAwaiter;
+
+    public:
+
+        IoCancellation();
+
+        /**
+         * @brief Cancels all pending operations and makes the following
+         *        operations fail with ERROR_OPERATION_ABORTED.
+        */
+        void Cancel();
+
+        /**
+         * @brief Indicates if the cancellation has been requested.
+         * @return true if the cancellation has been requested, false
+         *         otherwise.
+        */
+        bool IsCancelled();
+    };
+
+    /**
+     * @brief The access pattern hint used when opening a buffered file
+     *        stream.
+    */
+    enum class FileAccessPattern
+    {
+        /**
+         * @brief No hint is specified.
+        */
+        Normal,
+
+        /**
+         * @brief The file is accessed sequentially from beginning to end,
+         *        which maps to FILE_FLAG_SEQUENTIAL_SCAN.
+        */
+        Sequential,
+
+        /**
+         * @brief The file is accessed randomly, which maps to
+         *        FILE_FLAG_RANDOM_ACCESS.
+        */
+        Random,
+    };
+
+    /**
+     * @brief The buffered file reader with double-buffered asynchronous
+     *        read-ahead. While the caller consumes one buffer, the next one is
+     *        filled by an overlapped read in the background.
+    */
+    class FileReader :
+        DisableCopyConstruction,
+        DisableMoveConstruction
+    {
+    private:
+
+        HANDLE m_FileHandle;
+        bool m_OwnsFileHandle;
+        HANDLE m_Event;
+        OVERLAPPED m_Overlapped;
+        std::size_t m_BufferSize;
+        std::vector<std::uint8_t> m_Buffers[2];
+        std::size_t m_CurrentIndex;
+        std::size_t m_CurrentOffset;
+        std::size_t m_CurrentSize;
+        std::uint64_t m_FileOffset;
+        bool m_ReadAheadPending;
+        bool m_EndOfFile;
+
+        bool Initialize();
+
+        bool IssueReadAhead();
+
+        bool FillBuffer();
+
+    public:
+
+        /**
+         * @brief Creates the file reader instance.
+         * @param BufferSize The size in bytes of each of the two buffers. If
+         *                   this parameter is zero, 64 KiB will be used.
+        */
+        explicit FileReader(
+            _In_ std::size_t BufferSize = 64 * 1024);
+
+        /**
+         * @brief Closes the file reader.
+        */
+        ~FileReader();
+
+        /**
+         * @brief Opens the file and starts reading ahead from the beginning.
+         * @param FileName The name of the file to be opened.
+         * @param AccessPattern The access pattern hint.
+         * @return true if succeeded, false otherwise. To get extended error
+         *         information, call GetLastError.
+        */
+        bool Open(
+            _In_ LPCWSTR FileName,
+            _In_ FileAccessPattern AccessPattern = FileAccessPattern::Sequential);
+
+        /**
+         * @brief Attaches an opened file handle and starts reading ahead from
+         *        the specified offset. The read-ahead is only asynchronous if
+         *        the handle is opened with FILE_FLAG_OVERLAPPED.
+         * @param FileHandle The file handle with the read access.
+         * @param TakeOwnership Closes the handle when the reader is closed.
+         * @param Offset The byte offset in the file where the reading begins.
+         * @return true if succeeded, false otherwise. To get extended error
+         *         information, call GetLastError.
+        */
+        bool Attach(
+            _In_ HANDLE FileHandle,
+            _In_ bool TakeOwnership = false,
+            _In_ std::uint64_t Offset = 0);
+
+        /**
+         * @brief Cancels the pending read-ahead and closes the file if owned.
+        */
+        void Close();
+
+        /**
+         * @brief Reads data from the file.
+         * @param Buffer The buffer that receives the data.
+         * @param Size The maximum number of bytes to be read.
+         * @param NumberOfBytesRead The number of bytes read, which is less
+         *                          than Size only if the end of the file is
+         *                          reached.
+         * @return true if succeeded, false otherwise. To get extended error
+         *         information, call GetLastError.
+        */
+        bool Read(
+            _Out_ void* Buffer,
+            _In_ std::size_t Size,
+            _Out_ std::size_t& NumberOfBytesRead);
+
+        /**
+         * @brief Reads a line from the file. The line terminator, either LF or
+         *        CRLF, is not included.
+         * @param Line The string that receives the line.
+         * @return true if a line is read, false if the end of the file is
+         *         reached or an error occurred. To get extended error
+         *         information, call GetLastError, which is ERROR_HANDLE_EOF if
+         *         the end of the file is reached.
+        */
+        bool ReadLine(
+            _Out_ std::string& Line);
+
+        /**
+         * @brief Retrieves the byte offset in the file of the next byte to be
+         *        read.
+         * @return The byte offset in the file.
+        */
+        std::uint64_t GetPosition() const;
+    };
+
+    /**
+     * @brief The buffered file writer which coalesces small writes into a
+     *        buffer and writes the full buffer behind the caller with an
+     *        overlapped write while the other buffer is being filled.
+    */
+    class FileWriter :
+        DisableCopyConstruction,
+        DisableMoveConstruction
+    {
+    private:
+
+        HANDLE m_FileHandle;
+        bool m_OwnsFileHandle;
+        HANDLE m_Event;
+        OVERLAPPED m_Overlapped;
+        std::size_t m_BufferSize;
+        std::vector<std::uint8_t> m_Buffers[2];
+        std::size_t m_CurrentIndex;
+        std::size_t m_CurrentSize;
+        std::uint64_t m_FileOffset;
+        std::uint64_t m_PendingOffset;
+        DWORD m_PendingSize;
+        bool m_WriteBehindPending;
+        DWORD m_SparseBlockSize;
+        std::uint64_t m_SkippedBytes;
+
+        bool Initialize();
+
+        bool WaitWriteBehind();
+
+        bool SubmitCurrentBuffer();
+
+        bool WriteSparse(
+            _In_ const std::uint8_t* Buffer,
+            _In_ std::size_t Size);
+
+    public:
+
+        /**
+         * @brief Creates the file writer instance.
+         * @param BufferSize The size in bytes of each of the two buffers. If
+         *                   this parameter is zero, 64 KiB will be used.
+        */
+        explicit FileWriter(
+            _In_ std::size_t BufferSize = 64 * 1024);
+
+        /**
+         * @brief Flushes the buffered data and closes the file writer.
+        */
+        ~FileWriter();
+
+        /**
+         * @brief Opens the file for writing from the beginning.
+         * @param FileName The name of the file to be opened.
+         * @param CreationDisposition An action to take on a file that exists or
+         *                            does not exist.
+         * @param AccessPattern The access pattern hint.
+         * @return true if succeeded, false otherwise. To get extended error
+         *         information, call GetLastError.
+        */
+        bool Open(
+            _In_ LPCWSTR FileName,
+            _In_ DWORD CreationDisposition = CREATE_ALWAYS,
+            _In_ FileAccessPattern AccessPattern = FileAccessPattern::Sequential);
+
+        /**
+         * @brief Attaches an opened file handle for writing from the specified
+         *        offset. The write-behind is only asynchronous if the handle is
+         *        opened with FILE_FLAG_OVERLAPPED.
+         * @param FileHandle The file handle with the write access.
+         * @param TakeOwnership Closes the handle when the writer is closed.
+         * @param Offset The byte offset in the file where the writing begins.
+         * @return true if succeeded, false otherwise. To get extended error
+         *         information, call GetLastError.
+        */
+        bool Attach(
+            _In_ HANDLE FileHandle,
+            _In_ bool TakeOwnership = false,
+            _In_ std::uint64_t Offset = 0);
+
+        /**
+         * @brief Flushes the buffered data and closes the file if owned.
+         * @return true if succeeded, false otherwise. To get extended error
+         *         information, call GetLastError.
+        */
+        bool Close();
+
+        /**
+         * @brief Writes data to the file. Small writes are coalesced in the
+         *        buffer, and writes larger than the buffer bypass it.
+         * @param Buffer The buffer containing the data to be written.
+         * @param Size The number of bytes to be written.
+         * @return true if succeeded, false otherwise. To get extended error
+         *         information, call GetLastError.
+        */
+        bool Write(
+            _In_ const void* Buffer,
+            _In_ std::size_t Size);
+
+        /**
+         * @brief Writes all buffered data to the file and waits for the
+         *        completion.
+         * @param Durable Also flushes the file system cache to the storage by
+         *                FlushFileBuffers as a durability barrier.
+         * @return true if succeeded, false otherwise. To get extended error
+         *         information, call GetLastError.
+        */
+        bool Flush(
+            _In_ bool Durable = false);
+
+        /**
+         * @brief Retrieves the byte offset in the file of the next byte to be
+         *        written.
+         * @return The byte offset in the file.
+        */
+        std::uint64_t GetPosition() const;
+
+        /**
+         * @brief Enables the sparse write mode for the opened file. The file
+         *        is marked as sparse, and the all-zero blocks are converted to
+         *        unallocated ranges instead of being written. The writes are
+         *        performed synchronously in this mode.
+         * @param BlockSize The size in bytes of the blocks aligned to the file
+         *                  offset which are checked for zeros. If this
+         *                  parameter is zero, 64 KiB will be used.
+         * @return true if succeeded, false otherwise. To get extended error
+         *         information, call GetLastError.
+        */
+        bool EnableSparseWrite(
+            _In_ std::size_t BlockSize = 64 * 1024);
+
+        /**
+         * @brief Retrieves the number of bytes which are converted to the
+         *        unallocated ranges instead of being written in the sparse
+         *        write mode.
+         * @return The number of the skipped bytes.
+        */
+        std::uint64_t GetSkippedBytes() const;
+    };
+
+#ifdef MILE_WINDOWS_HELPERS_CPPBASE_COROUTINE
+
+    /**
+     * @brief The common part of the coroutine promise for Mile::Task.
+    */
+    class TaskPromiseBase
+    {
+    private:
+
+        std::coroutine_handle<> m_Continuation;
+        std::exception_ptr m_Exception;
+
+    protected:
+
+        void RethrowIfFailed()
+        {
+            if (this->m_Exception)
+            {
+                std::rethrow_exception(this->m_Exception);
+            }
+        }
+
+    public:
+
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            template<typename PromiseType>
+            std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<PromiseType> Handle) noexcept
+            {
+                std::coroutine_handle<> Continuation =
+                    Handle.promise().m_Continuation;
+                if (Continuation)
+                {
+                    return Continuation;
+                }
+                return std::noop_coroutine();
+            }
+
+            void await_resume() noexcept
+            {
+
+            }
+        };
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        FinalAwaiter final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void unhandled_exception() noexcept
+        {
+            // Keep the exception for the awaiter or the RunTask caller.
+            this->m_Exception = std::current_exception();
+        }
+
+        void SetContinuation(
+            _In_ std::coroutine_handle<> Continuation) noexcept
+        {
+            this->m_Continuation = Continuation;
+        }
+    };
+
+    template<typename Type>
+    class Task;
+
+    /**
+     * @brief The coroutine promise for Mile::Task.
+     * @tparam Type The type of the result.
+    */
+    template<typename Type>
+    class TaskPromise : public TaskPromiseBase
+    {
+    private:
+
+        std::optional<Type> m_Value;
+
+    public:
+
+        Task<Type> get_return_object() noexcept;
+
+        template<typename ValueType>
+        void return_value(
+            _In_ ValueType&& Value)
+        {
+            this->m_Value.emplace(std::forward<ValueType>(Value));
+        }
+
+        Type GetResult()
+        {
+            this->RethrowIfFailed();
+            return std::move(*this->m_Value);
+        }
+    };
+
+    /**
+     * @brief The coroutine promise for Mile::Task without the result.
+    */
+    template<>
+    class TaskPromise<void> : public TaskPromiseBase
+    {
+    public:
+
+        Task<void> get_return_object() noexcept;
+
+        void return_void() noexcept
+        {
+
+        }
+
+        void GetResult()
+        {
+            this->RethrowIfFailed();
+        }
+    };
+
+    /**
+     * @brief The lazily started coroutine task. The task starts when it is
+     *        awaited or when Start is called.
+     * @tparam Type The type of the result.
+    */
+    template<typename Type = void>
+    class Task : DisableCopyConstruction
+    {
+    public:
+
+        using promise_type = TaskPromise<Type>;
+
+    private:
+
+        std::coroutine_handle<promise_type> m_Handle;
+
+    public:
+
+        explicit Task(
+            _In_ std::coroutine_handle<promise_type> Handle) noexcept :
+            m_Handle(Handle)
+        {
+
+        }
+
+        Task(Task&& Other) noexcept :
+            m_Handle(Other.m_Handle)
+        {
+            Other.m_Handle = nullptr;
+        }
+
+        Task& operator=(Task&& Other) noexcept
+        {
+            if (this != &Other)
+            {
+                if (this->m_Handle)
+                {
+                    this->m_Handle.destroy();
+                }
+                this->m_Handle = Other.m_Handle;
+                Other.m_Handle = nullptr;
+            }
+            return *this;
+        }
+
+        ~Task()
+        {
+            if (this->m_Handle)
+            {
+                this->m_Handle.destroy();
+            }
+        }
+
+        /**
+         * @brief Starts the task without awaiting it. It must not be called
+         *        more than once, and the started task must not be awaited.
+        */
+        void Start()
+        {
+            this->m_Handle.resume();
+        }
+
+        /**
+         * @brief Indicates if the task is completed.
+         * @return true if the task is completed, false otherwise.
+        */
+        bool IsReady() const noexcept
+        {
+            return !this->m_Handle || this->m_Handle.done();
+        }
+
+        /**
+         * @brief Gets the result of the completed task. The exception thrown
+         *        from the task is rethrown.
+         * @return The result of the task.
+        */
+        Type GetResult()
+        {
+            return this->m_Handle.promise().GetResult();
+        }
+
+        auto operator co_await() noexcept
+        {
+            struct Awaiter
+            {
+                std::coroutine_handle<promise_type> Handle;
+
+                bool await_ready() noexcept
+                {
+                    return !this->Handle || this->Handle.done();
+                }
+
+                std::coroutine_handle<> await_suspend(
+                    std::coroutine_handle<> Continuation) noexcept
+                {
+                    this->Handle.promise().SetContinuation(Continuation);
+                    return this->Handle;
+                }
+
+                Type await_resume()
+                {
+                    return this->Handle.promise().GetResult();
+                }
+            };
+
+            return Awaiter{ this->m_Handle };
+        }
+    };
+
+    template<typename Type>
+    inline Task<Type> TaskPromise<Type>::get_return_object() noexcept
+    {
+        return Task<Type>(
+            std::coroutine_handle<TaskPromise<Type>>::from_promise(*this));
+    }
+
+    inline Task<void> TaskPromise<void>::get_return_object() noexcept
+    {
+        return Task<void>(
+            std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+    }
+
+    /**
+     * @brief Starts a task and dispatches the completed operations from the
+     *        executor on the calling thread until the task is completed.
+     * @tparam Type The type of the result.
+     * @param Executor The executor which the handles used by the task are
+     *                 bound to.
+     * @param CurrentTask The task to be run.
+     * @return The result of the task.
+     * @remarks The stop requests of the executor do not interrupt the task.
+     *          If the wait on the completion port fails, std::system_error is
+     *          thrown and the task is left incomplete.
+    */
+    template<typename Type>
+    Type RunTask(
+        _In_ CompletionPortExecutor& Executor,
+        _In_ Task<Type>& CurrentTask)
+    {
+        CurrentTask.Start();
+        while (!CurrentTask.IsReady())
+        {
+            bool WaitFailed = false;
+            Executor.RunOnce(INFINITE, &WaitFailed);
+            if (WaitFailed)
+            {
+                throw std::system_error(
+                    static_cast<int>(::GetLastError()),
+                    std::system_category());
+            }
+        }
+        return CurrentTask.GetResult();
+    }
+
+    /**
+     * @brief The awaitable overlapped operation which resumes the awaiting
+     *        coroutine on the completion port executor thread.
+     * @tparam IssuerType The type which issues the overlapped operation. It
+     *                    returns the Win32 error code, and ERROR_IO_PENDING
+     *                    or ERROR_SUCCESS means the completion will be
+     *                    queued to the completion port.
+    */
+    template<typename IssuerType>
+    class IoAwaiter : public CompletionPortOperation
+    {
+    private:
+
+        IssuerType m_Issuer;
+        IoCancellation* m_Cancellation;
+        std::coroutine_handle<> m_Continuation;
+        IoResult m_Result;
+
+        static void OnCompleted(
+            _In_ CompletionPortOperation* Operation,
+            _In_ DWORD Error,
+            _In_ DWORD BytesTransferred)
+        {
+            IoAwaiter* Self = static_cast<IoAwaiter*>(Operation);
+            Self->m_Result.Error = Error;
+            Self->m_Result.BytesTransferred = BytesTransferred;
+            Self->m_Continuation.resume();
+        }
+
+        void Unregister()
+        {
+            ::AcquireSRWLockExclusive(&this->m_Cancellation->m_Lock);
+            CompletionPortOperation** Link =
+                &this->m_Cancellation->m_PendingOperations;
+            while (*Link)
+            {
+                if (*Link == this)
+                {
+                    *Link = this->CancellationNext;
+                    break;
+                }
+                Link = &(*Link)->CancellationNext;
+            }
+            ::ReleaseSRWLockExclusive(&this->m_Cancellation->m_Lock);
+        }
+
+    public:
+
+        IoAwaiter(
+            _In_ HANDLE Handle,
+            _In_ ULONGLONG Offset,
+            _In_ IssuerType const& Issuer,
+            _In_opt_ IoCancellation* Cancellation) :
+            CompletionPortOperation(),
+            m_Issuer(Issuer),
+            m_Cancellation(Cancellation),
+            m_Result()
+        {
+            this->Overlapped.Offset = static_cast<DWORD>(Offset);
+            this->Overlapped.OffsetHigh = static_cast<DWORD>(Offset >> 32);
+            this->Handle = Handle;
+            this->CompletionRoutine = IoAwaiter::OnCompleted;
+        }
+
+        bool await_ready() noexcept
+        {
+            return false;
+        }
+
+        bool await_suspend(
+            _In_ std::coroutine_handle<> Continuation) noexcept
+        {
+            this->m_Continuation = Continuation;
+
+            IoCancellation* Cancellation = this->m_Cancellation;
+            if (Cancellation)
+            {
+                // Hold the lock when issuing the operation, so the operation
+                // will never be missed by the concurrent cancellation.
+                ::AcquireSRWLockExclusive(&Cancellation->m_Lock);
+                if (Cancellation->m_Cancelled)
+                {
+                    ::ReleaseSRWLockExclusive(&Cancellation->m_Lock);
+                    this->m_Cancellation = nullptr;
+                    this->m_Result.Error = ERROR_OPERATION_ABORTED;
+                    return false;
+                }
+                this->CancellationNext = Cancellation->m_PendingOperations;
+                Cancellation->m_PendingOperations = this;
+            }
+
+            DWORD Error = this->m_Issuer(this->Handle, &this->Overlapped);
+            if (ERROR_SUCCESS == Error || ERROR_IO_PENDING == Error)
+            {
+                if (Cancellation)
+                {
+                    ::ReleaseSRWLockExclusive(&Cancellation->m_Lock);
+                }
+
+                // The awaiter may have been resumed and destroyed on another
+                // executor thread, so no member can be accessed from here.
+                return true;
+            }
+
+            if (Cancellation)
+            {
+                Cancellation->m_PendingOperations = this->CancellationNext;
+                ::ReleaseSRWLockExclusive(&Cancellation->m_Lock);
+                this->m_Cancellation = nullptr;
+            }
+
+            this->m_Result.Error = Error;
+            return false;
+        }
+
+        IoResult await_resume() noexcept
+        {
+            if (this->m_Cancellation)
+            {
+                this->Unregister();
+            }
+            return this->m_Result;
+        }
+    };
+
+    /**
+     * @brief The issuer for the asynchronous ReadFile operation.
+    */
+    struct ReadFileIssuer
+    {
+        LPVOID Buffer;
+        DWORD NumberOfBytesToRead;
+
+        DWORD operator()(
+            _In_ HANDLE FileHandle,
+            _In_ LPOVERLAPPED Overlapped) const noexcept
+        {
+            return ::ReadFile(
+                FileHandle,
+                this->Buffer,
+                this->NumberOfBytesToRead,
+                nullptr,
+                Overlapped) ? ERROR_SUCCESS : ::GetLastError();
+        }
+    };
+
+    /**
+     * @brief The issuer for the asynchronous WriteFile operation.
+    */
+    struct WriteFileIssuer
+    {
+        LPCVOID Buffer;
+        DWORD NumberOfBytesToWrite;
+
+        DWORD operator()(
+            _In_ HANDLE FileHandle,
+            _In_ LPOVERLAPPED Overlapped) const noexcept
+        {
+            return ::WriteFile(
+                FileHandle,
+                this->Buffer,
+                this->NumberOfBytesToWrite,
+                nullptr,
+                Overlapped) ? ERROR_SUCCESS : ::GetLastError();
+        }
+    };
+
+    /**
+     * @brief The issuer for the asynchronous DeviceIoControl operation.
+    */
+    struct DeviceIoControlIssuer
+    {
+        DWORD IoControlCode;
+        LPVOID InputBuffer;
+        DWORD InputBufferSize;
+        LPVOID OutputBuffer;
+        DWORD OutputBufferSize;
+
+        DWORD operator()(
+            _In_ HANDLE DeviceHandle,
+            _In_ LPOVERLAPPED Overlapped) const noexcept
+        {
+            return ::DeviceIoControl(
+                DeviceHandle,
+                this->IoControlCode,
+                this->InputBuffer,
+                this->InputBufferSize,
+                this->OutputBuffer,
+                this->OutputBufferSize,
+                nullptr,
+                Overlapped) ? ERROR_SUCCESS : ::GetLastError();
+        }
+    };
+
+    /**
+     * @brief Reads data from the specified file or device asynchronously.
+     * @param FileHandle A handle opened with FILE_FLAG_OVERLAPPED and bound to
+     *                   the completion port executor.
+     * @param Buffer A pointer to the buffer that receives the data. It must
+     *               remain valid until the operation is completed.
+     * @param NumberOfBytesToRead The maximum number of bytes to be read.
+     * @param Offset The byte offset where to start reading. It is ignored for
+     *               the devices which do not support the file pointer.
+     * @param Cancellation The optional cancellation source.
+     * @return The awaitable object, the awaiting result is a Mile::IoResult.
+     * @remark For more information, see ReadFile.
+    */
+    inline IoAwaiter<ReadFileIssuer> AsyncRead(
+        _In_ HANDLE FileHandle,
+        _Out_ LPVOID Buffer,
+        _In_ DWORD NumberOfBytesToRead,
+        _In_ ULONGLONG Offset = 0,
+        _In_opt_ IoCancellation* Cancellation = nullptr)
+    {
+        return IoAwaiter<ReadFileIssuer>(
+            FileHandle,
+            Offset,
+            ReadFileIssuer{ Buffer, NumberOfBytesToRead },
+            Cancellation);
+    }
+
+    /**
+     * @brief Writes data to the specified file or device asynchronously.
+     * @param FileHandle A handle opened with FILE_FLAG_OVERLAPPED and bound to
+     *                   the completion port executor.
+     * @param Buffer A pointer to the buffer containing the data to be written.
+     *               It must remain valid until the operation is completed.
+     * @param NumberOfBytesToWrite The number of bytes to be written.
+     * @param Offset The byte offset where to start writing. It is ignored for
+     *               the devices which do not support the file pointer.
+     * @param Cancellation The optional cancellation source.
+     * @return The awaitable object, the awaiting result is a Mile::IoResult.
+     * @remark For more information, see WriteFile.
+    */
+    inline IoAwaiter<WriteFileIssuer> AsyncWrite(
+        _In_ HANDLE FileHandle,
+        _In_ LPCVOID Buffer,
+        _In_ DWORD NumberOfBytesToWrite,
+        _In_ ULONGLONG Offset = 0,
+        _In_opt_ IoCancellation* Cancellation = nullptr)
+    {
+        return IoAwaiter<WriteFileIssuer>(
+            FileHandle,
+            Offset,
+            WriteFileIssuer{ Buffer, NumberOfBytesToWrite },
+            Cancellation);
+    }
+
+    /**
+     * @brief Sends a control code directly to a specified device driver
+     *        asynchronously.
+     * @param DeviceHandle A handle opened with FILE_FLAG_OVERLAPPED and bound
+     *                     to the completion port executor.
+     * @param IoControlCode The control code for the operation.
+     * @param InputBuffer A pointer to the input buffer, or nullptr.
+     * @param InputBufferSize The size of the input buffer, in bytes.
+     * @param OutputBuffer A pointer to the output buffer, or nullptr. It must
+     *                     remain valid until the operation is completed.
+     * @param OutputBufferSize The size of the output buffer, in bytes.
+     * @param Cancellation The optional cancellation source.
+     * @return The awaitable object, the awaiting result is a Mile::IoResult.
+     * @remark For more information, see DeviceIoControl.
+    */
+    inline IoAwaiter<DeviceIoControlIssuer> AsyncIoctl(
+        _In_ HANDLE DeviceHandle,
+        _In_ DWORD IoControlCode,
+        _In_opt_ LPVOID InputBuffer,
+        _In_ DWORD InputBufferSize,
+        _Out_opt_ LPVOID OutputBuffer,
+        _In_ DWORD OutputBufferSize,
+        _In_opt_ IoCancellation* Cancellation = nullptr)
+    {
+        return IoAwaiter<DeviceIoControlIssuer>(
+            DeviceHandle,
+            0,
+            DeviceIoControlIssuer{
+                IoControlCode,
+                InputBuffer,
+                InputBufferSize,
+                OutputBuffer,
+                OutputBufferSize },
+            Cancellation);
+    }
+
+#ifdef _WINSOCK2API_
+
+    /**
+     * @brief The issuer for the asynchronous WSARecv operation.
+    */
+    struct SocketRecvIssuer
+    {
+        LPVOID Buffer;
+        DWORD NumberOfBytesToRecv;
+        DWORD Flags;
+
+        DWORD operator()(
+            _In_ HANDLE SocketHandle,
+            _In_ LPOVERLAPPED Overlapped) noexcept
+        {
+            WSABUF WSABuffer;
+            WSABuffer.len = static_cast<ULONG>(this->NumberOfBytesToRecv);
+            WSABuffer.buf = reinterpret_cast<char*>(this->Buffer);
+
+            return (SOCKET_ERROR != ::WSARecv(
+                reinterpret_cast<SOCKET>(SocketHandle),
+                &WSABuffer,
+                1,
+                nullptr,
+                &this->Flags,
+                Overlapped,
+                nullptr)) ? ERROR_SUCCESS : ::WSAGetLastError();
+        }
+    };
+
+    /**
+     * @brief The issuer for the asynchronous WSASend operation.
+    */
+    struct SocketSendIssuer
+    {
+        LPCVOID Buffer;
+        DWORD NumberOfBytesToSend;
+        DWORD Flags;
+
+        DWORD operator()(
+            _In_ HANDLE SocketHandle,
+            _In_ LPOVERLAPPED Overlapped) const noexcept
+        {
+            WSABUF WSABuffer;
+            WSABuffer.len = static_cast<ULONG>(this->NumberOfBytesToSend);
+            WSABuffer.buf = const_cast<char*>(
+                reinterpret_cast<const char*>(this->Buffer));
+
+            return (SOCKET_ERROR != ::WSASend(
+                reinterpret_cast<SOCKET>(SocketHandle),
+                &WSABuffer,
+                1,
+                nullptr,
+                this->Flags,
+                Overlapped,
+                nullptr)) ? ERROR_SUCCESS : ::WSAGetLastError();
+        }
+    };
+
+    /**
+     * @brief Receives data from a connected socket asynchronously.
+     * @param SocketHandle A socket created with WSA_FLAG_OVERLAPPED and bound
+     *                     to the completion port executor.
+     * @param Buffer A pointer to the buffer that receives the data. It must
+     *               remain valid until the operation is completed.
+     * @param NumberOfBytesToRecv The maximum number of bytes to be received.
+     * @param Flags The flags used to modify the behavior.
+     * @param Cancellation The optional cancellation source.
+     * @return The awaitable object, the awaiting result is a Mile::IoResult.
+     * @remark For more information, see WSARecv.
+    */
+    inline IoAwaiter<SocketRecvIssuer> AsyncRecv(
+        _In_ SOCKET SocketHandle,
+        _Out_ LPVOID Buffer,
+        _In_ DWORD NumberOfBytesToRecv,
+        _In_ DWORD Flags = 0,
+        _In_opt_ IoCancellation* Cancellation = nullptr)
+    {
+        return IoAwaiter<SocketRecvIssuer>(
+            reinterpret_cast<HANDLE>(SocketHandle),
+            0,
+            SocketRecvIssuer{ Buffer, NumberOfBytesToRecv, Flags },
+            Cancellation);
+    }
+
+    /**
+     * @brief Sends data on a connected socket asynchronously.
+     * @param SocketHandle A socket created with WSA_FLAG_OVERLAPPED and bound
+     *                     to the completion port executor.
+     * @param Buffer A pointer to the buffer containing the data to be sent. It
+     *               must remain valid until the operation is completed.
+     * @param NumberOfBytesToSend The number of bytes to be sent.
+     * @param Flags The flags used to modify the behavior.
+     * @param Cancellation The optional cancellation source.
+     * @return The awaitable object, the awaiting result is a Mile::IoResult.
+     * @remark For more information, see WSASend.
+    */
+    inline IoAwaiter<SocketSendIssuer> AsyncSend(
+        _In_ SOCKET SocketHandle,
+        _In_ LPCVOID Buffer,
+        _In_ DWORD NumberOfBytesToSend,
+        _In_ DWORD Flags = 0,
+        _In_opt_ IoCancellation* Cancellation = nullptr)
+    {
+        return IoAwaiter<SocketSendIssuer>(
+            reinterpret_cast<HANDLE>(SocketHandle),
+            0,
+            SocketSendIssuer{ Buffer, NumberOfBytesToSend, Flags },
+            Cancellation);
+    }
+
+#endif // _WINSOCK2API_
+
+#endif // MILE_WINDOWS_HELPERS_CPPBASE_COROUTINE
 }
 
 #endif // !MILE_WINDOWS_HELPERS_CPPBASE
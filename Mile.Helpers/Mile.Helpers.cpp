@@ -511,3 +511,140 @@ EXTERN_C HRESULT WINAPI MileCreateCoreWindow(
 
     return E_NOTIMPL;
 }
+
+namespace
+{
+    static BOOL SetFileEndOfFile(
+        _In_ HANDLE FileHandle,
+        _In_ ULONGLONG EndOfFile)
+    {
+        FILE_END_OF_FILE_INFO EndOfFileInfo;
+        EndOfFileInfo.EndOfFile.QuadPart = static_cast<LONGLONG>(EndOfFile);
+        return ::SetFileInformationByHandle(
+            FileHandle,
+            FileEndOfFileInfo,
+            &EndOfFileInfo,
+            sizeof(FILE_END_OF_FILE_INFO));
+    }
+}
+
+EXTERN_C BOOL WINAPI MileSetValidDataFast(
+    _In_ HANDLE FileHandle,
+    _In_ ULONGLONG ValidDataLength)
+{
+    ULONGLONG FileSize = 0;
+    if (!::MileGetFileSizeByHandle(FileHandle, &FileSize))
+    {
+        return FALSE;
+    }
+
+    // Enable the privilege on a private impersonation token of the current
+    // thread instead of the process token, which is shared by all threads and
+    // cannot be toggled safely while other threads may use it.
+    HANDLE PreviousTokenHandle = nullptr;
+    if (!::OpenThreadToken(
+        ::GetCurrentThread(),
+        TOKEN_IMPERSONATE,
+        TRUE,
+        &PreviousTokenHandle))
+    {
+        if (ERROR_NO_TOKEN != ::GetLastError())
+        {
+            return FALSE;
+        }
+        PreviousTokenHandle = nullptr;
+    }
+
+    BOOL Result = FALSE;
+    DWORD LastError = ERROR_SUCCESS;
+
+    if (::ImpersonateSelf(SecurityImpersonation))
+    {
+        HANDLE TokenHandle = nullptr;
+        if (::OpenThreadToken(
+            ::GetCurrentThread(),
+            TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY,
+            FALSE,
+            &TokenHandle))
+        {
+            TOKEN_PRIVILEGES NewState;
+            NewState.PrivilegeCount = 1;
+            NewState.Privileges[0].Luid.LowPart =
+                MILE_TOKEN_MANAGE_VOLUME_PRIVILEGE;
+            NewState.Privileges[0].Luid.HighPart = 0;
+            NewState.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+            if (::AdjustTokenPrivileges(
+                TokenHandle,
+                FALSE,
+                &NewState,
+                0,
+                nullptr,
+                nullptr))
+            {
+                // AdjustTokenPrivileges succeeds with ERROR_NOT_ALL_ASSIGNED
+                // if the token does not have the privilege.
+                if (ERROR_NOT_ALL_ASSIGNED == ::GetLastError())
+                {
+                    LastError = ERROR_PRIVILEGE_NOT_HELD;
+                }
+                else if (FileSize < ValidDataLength &&
+                    !::SetFileEndOfFile(FileHandle, ValidDataLength))
+                {
+                    LastError = ::GetLastError();
+                }
+                else
+                {
+                    // The file is only extended after the privilege is
+                    // enabled, and the original size is restored if the
+                    // valid data length cannot be set, so the caller is never
+                    // left with an extended file which will be zero-filled.
+                    Result = ::SetFileValidData(
+                        FileHandle,
+                        static_cast<LONGLONG>(ValidDataLength));
+                    if (!Result)
+                    {
+                        LastError = ::GetLastError();
+                        if (FileSize < ValidDataLength)
+                        {
+                            ::SetFileEndOfFile(FileHandle, FileSize);
+                        }
+                    }
+                }
+            }
+            else
+            {
+                LastError = ::GetLastError();
+            }
+
+            ::CloseHandle(TokenHandle);
+        }
+        else
+        {
+            LastError = ::GetLastError();
+        }
+
+        // Restore the previous impersonation state of the current thread,
+        // which also discards the private impersonation token.
+        if (!::SetThreadToken(nullptr, PreviousTokenHandle))
+        {
+            ::RevertToSelf();
+        }
+    }
+    else
+    {
+        LastError = ::GetLastError();
+    }
+
+    if (PreviousTokenHandle)
+    {
+        ::CloseHandle(PreviousTokenHandle);
+    }
+
+    if (!Result)
+    {
+        ::SetLastError(LastError);
+    }
+
+    return Result;
+}
@@ -508,4 +508,29 @@ EXTERN_C HRESULT WINAPI MileCreateCoreWindow(
     _In_ REFIID riid,
     _Out_ void** ppv);
 
+/**
+ * @brief Sets the valid data length of the specified file without filling
+ *        the zeros, which avoids the zero-fill penalty when the file is
+ *        written later in random order or by multiple writers. The file is
+ *        extended to the valid data length if needed, and restored to the
+ *        original size if the function fails.
+ * @param FileHandle A handle to the file. The file handle must be created with
+ *                   the GENERIC_WRITE access right.
+ * @param ValidDataLength The new valid data length.
+ * @return If the function succeeds, the return value is nonzero. If the
+ *         function fails, the return value is zero. To get extended error
+ *         information, call GetLastError.
+ * @remarks The MILE_TOKEN_MANAGE_VOLUME_PRIVILEGE privilege is enabled on a
+ *          temporary impersonation token of the calling thread during the
+ *          call, and the process token is not modified, so the function fails
+ *          with ERROR_PRIVILEGE_NOT_HELD if the process does not have the
+ *          privilege. The previous content of the disk may be readable in
+ *          the range which is not written after the call, so only use it for
+ *          the files which are not readable by other users.
+ *          For more information, see SetFileValidData.
+*/
+EXTERN_C BOOL WINAPI MileSetValidDataFast(
+    _In_ HANDLE FileHandle,
+    _In_ ULONGLONG ValidDataLength);
+
 #endif // !MILE_WINDOWS_HELPERS